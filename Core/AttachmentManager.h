@@ -6,6 +6,8 @@
 #include <map>
 #include <memory>
 
+#include "NameTable.h"
+
 #ifndef BUILDING_TESTS
 #if HAS_BRX_SDK
 #include "acdb.h"
@@ -24,7 +26,7 @@ class AttachmentManager {
 public:
     // Version structure for AGS system (A=stucco, G=hardi, S=brick)
     struct PlanVersion {
-        std::string versionCode;        // "AGS", "AHS", etc.
+        InternedName versionCode;       // "AGS", "AHS", etc.
         std::string description;        // "Stucco/Hardi/Brick"
         std::map<char, std::string> components;  // 'A'->Stucco, 'G'->Hardi, 'S'->Brick
         std::vector<int> activeColors;  // Colors active in this version
@@ -35,10 +37,10 @@ public:
     
     // Attachment structure for plans
     struct Attachment {
-        std::string planName;           // "Plan A", "Plan B", etc.
+        InternedName planName;          // "Plan A", "Plan B", etc.
         std::string filePath;           // DWG file path
         std::vector<PlanVersion> versions;  // Available versions
-        std::string activeVersion;      // Currently active version code
+        InternedName activeVersion;     // Currently active version code
         bool isLoaded;
         bool isVisible;
         std::string areaPreset;        // "Southeast", "Northeast", etc.
@@ -1,10 +1,21 @@
 // BoundaryVersionManager.h - Manages boundary boxes with version toggling
 #pragma once
 
+#include <atomic>
 #include <string>
 #include <vector>
 #include <map>
 #include <set>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+#include "ColorMask.h"
+#include "NameTable.h"
+#include "BoundaryPolygon.h"
+#include "QuantityEngine.h"
 
 #ifndef BUILDING_TESTS
 #if HAS_BRX_SDK
@@ -15,6 +26,11 @@
 
 namespace EnhancedTakeoff {
 
+class EntitySpatialIndex;
+class EntitySnapshotStore;
+class BoundaryFaceFinder;
+class BoundaryPartition;
+
 /**
  * Manages boundary boxes for version control (AGS system)
  * Allows toggling different siding/material versions within boundaries
@@ -22,31 +38,49 @@ namespace EnhancedTakeoff {
  */
 class BoundaryVersionManager {
 public:
+    // Elevation codes are frame (A/H) x garage (G/N) x siding (S/H/B) - "AGS" ... "HNB"
+    static const int kElevationCodeCount = 12;
+    
+    // Independent: every boundary counts what lies inside it, so overlaps count twice
+    // Priority: overlaps go to the active boundary with the highest priority
+    enum class OverlapMode {
+        Independent,
+        Priority
+    };
+    
     struct BoundaryBox {
-        std::string name;                    // "Main House", "Garage", "Porch"
-        std::string attachmentPlan;          // "Plan B"
-        std::vector<int> baseColors;         // Base colors in boundary
-        std::map<char, std::vector<int>> versionColors;  // 'A'->stucco colors, 'G'->hardi colors
+        InternedName name;                   // "Main House", "Garage", "Porch"
+        InternedName attachmentPlan;         // "Plan B"
+        ColorMask baseColors;                // Base colors in boundary
+        std::map<char, ColorMask> versionColors;  // 'A'->stucco colors, 'G'->hardi colors
         bool isActive;
+        int priority;                        // Wins overlaps in OverlapMode::Priority (higher first)
+        
+        // Plan extents - kept as doubles in every build so spatial queries work headless
+        double minX, minY, minZ;
+        double maxX, maxY, maxZ;
+        bool hasExtents;
+        BoundaryPolygon outline;             // True shape; empty = the extents rectangle
+        
+        // Version currently shown and its resolved color set (see SwitchVersion)
+        std::string activeVersion;
+        ColorMask activeColors;
+        
+        // Resolved colors per elevation code; a clear bit in resolvedValid marks a stale entry
+        mutable ColorMask resolvedColors[kElevationCodeCount];
+        mutable std::uint16_t resolvedValid;
         
 #ifndef BUILDING_TESTS
 #if HAS_BRX_SDK
         AcGePoint3d minPoint;
         AcGePoint3d maxPoint;
         AcDbObjectId boundaryEntity;
-#else
-        double minX, minY, minZ;
-        double maxX, maxY, maxZ;
 #endif
 #endif
         
-        BoundaryBox() : isActive(true) {
-#ifndef BUILDING_TESTS
-#if !HAS_BRX_SDK
+        BoundaryBox() : isActive(true), priority(0), hasExtents(false), resolvedValid(0) {
             minX = minY = minZ = 0.0;
             maxX = maxY = maxZ = 0.0;
-#endif
-#endif
         }
     };
     
@@ -64,13 +98,29 @@ public:
                             const std::vector<int>& colorIndices);
     std::vector<int> GetActiveVersionColors(const std::string& boundaryName,
                                            const std::string& activeVersion) const;
+    ColorMask GetActiveVersionColorMask(const std::string& boundaryName,
+                                        const std::string& activeVersion) const;
     
-    // Boundary operations
+    // Boundary operations (mutable access marks the boundary's version table and the partition stale)
     BoundaryBox* GetBoundary(const std::string& name);
+    const BoundaryBox* GetBoundary(const std::string& name) const;
     std::vector<std::string> GetAllBoundaryNames() const;
     std::vector<BoundaryBox> GetBoundariesForPlan(const std::string& planName) const;
     
-    // Entity detection
+    // Entity detection - an entity belongs to a boundary when its bounding-box center lies inside it
+    // COPILOT-HINT: Candidates come from the R-tree set with SetEntityIndex; without one nothing matches
+    void SetEntityIndex(const EntitySpatialIndex* index) { m_entityIndex = index; }
+    bool SetBoundaryExtents(const std::string& name,
+                           double minX, double minY,
+                           double maxX, double maxY);
+    bool SetBoundaryOutline(const std::string& name,
+                           const std::vector<double>& xs,
+                           const std::vector<double>& ys);
+    bool IsPlanPointInBoundary(double x, double y, const std::string& name) const;
+    std::vector<std::uint64_t> GetEntityHandlesInBoundary(const std::string& name) const;
+    bool IsEntityHandleInBoundary(std::uint64_t handle, const std::string& name) const;
+    std::map<std::string, std::vector<std::uint64_t>> GetEntityHandlesInActiveBoundaries() const;
+    
 #ifndef BUILDING_TESTS
 #if HAS_BRX_SDK
     bool SetBoundaryExtents(const std::string& name, 
@@ -78,20 +128,62 @@ public:
                            const AcGePoint3d& maxPt);
     std::vector<AcDbObjectId> GetEntitiesInBoundary(const std::string& name) const;
     bool IsEntityInBoundary(const AcDbObjectId& entityId, const std::string& name) const;
+    bool SetBoundaryFromPolyline(const std::string& name, const AcDbObjectId& polylineId);
 #endif
 #endif
     
-    // Auto-detection
+    // Auto-detection - closed faces of BOUNDARY_* linework become boundaries named "<prefix> <n>"
+    // Faces (and tagged polylines) that already back a boundary of the plan are skipped, so detection can be rerun
     bool AutoDetectBoundaries(const std::string& attachmentPlan);
     bool DetectBoundaryFromSelection(const std::string& name);
+    int DetectBoundariesFromLinework(const std::string& attachmentPlan, const std::string& namePrefix,
+                                     const BoundaryFaceFinder& linework, double minArea = 1.0);
+    
+    // Overlap resolution - Priority mode splits active boundaries into a non-overlapping partition
+    // COPILOT-HINT: Membership, lookups and totals all go through the partition in Priority mode;
+    // inactive boundaries still answer from their own outline. Setters rebuild the partition straight
+    // away, so membership and totals queries only read it and may run concurrently with each other
+    void SetOverlapMode(OverlapMode mode);
+    OverlapMode GetOverlapMode() const { return m_overlapMode; }
+    bool SetBoundaryPriority(const std::string& name, int priority);
+    std::string FindBoundaryAt(double x, double y) const;  // Empty when no active boundary covers the point
+    
+    // Batched edits - toggles and version switches applied together with one notification
+    struct ChangeSet {
+        std::map<std::string, bool> toggles;            // Boundary -> isActive
+        std::map<std::string, std::string> versions;    // Boundary -> elevation code
+        
+        void Toggle(const std::string& name, bool active) { toggles[name] = active; }
+        void SwitchVersion(const std::string& name, const std::string& version) { versions[name] = version; }
+        bool IsEmpty() const { return toggles.empty() && versions.empty(); }
+    };
+    using ChangeCallback = std::function<void(const ColorMask& affectedColors)>;
+    
+    // All or nothing - an unknown boundary or a version shorter than three letters rejects the set
+    // COPILOT-HINT: Callbacks run once per applied set with the colors whose quantities can change
+    // (every color when a toggle changed the active set), so "select all boundaries" costs one refresh;
+    // single-boundary setters do not notify
+    bool ApplyChanges(const ChangeSet& changes, ColorMask* affectedColors = nullptr);
+    void RegisterChangeCallback(ChangeCallback callback);
     
     // Version switching
     void SwitchVersion(const std::string& boundaryName, const std::string& newVersion);
+    void SwitchAllVersions(const std::string& newVersion);
+    void PrecomputeVersionTables();
+    static int GetElevationCodeIndex(const std::string& version);   // -1 for codes outside the table
+    static const char* GetElevationCode(int index);
     std::set<int> GetColorDifference(const std::string& boundaryName,
                                      const std::string& version1,
                                      const std::string& version2) const;
     
-    // Quantity calculation support
+    // Quantity calculation support - entities crossing the outline contribute only their inside part
+    // COPILOT-HINT: Needs SetEntitySnapshot (geometry) and SetEntityIndex (candidates); call
+    // SetEntitySnapshot again after the snapshot is refilled so handle lookups stay valid
+    using BoundaryTotals = std::map<int, QuantityEngine::ColorTotals>;
+    void SetEntitySnapshot(const EntitySnapshotStore* snapshot);
+    BoundaryTotals CalculateBoundaryTotals(const std::string& name) const;
+    std::map<std::string, BoundaryTotals> CalculateActiveBoundaryTotals(unsigned int threadCount = 0) const;
+    // Primary quantity per color: SF if the color has area, else LF, else EA
     std::map<int, double> CalculateQuantitiesInBoundary(const std::string& name) const;
     
     // Serialization
@@ -101,9 +193,39 @@ public:
 private:
     std::map<std::string, BoundaryBox> m_boundaries;
     std::string m_activeAttachment;
+    const EntitySpatialIndex* m_entityIndex;
+    const EntitySnapshotStore* m_snapshot;
+    std::unordered_map<std::uint64_t, std::uint32_t> m_snapshotRowOf;   // Handle -> snapshot row
+    OverlapMode m_overlapMode;
+    
+    // Rebuilt by every setter; edits through GetBoundary are picked up by the next query, under the lock
+    // Regions index the active boundaries
+    std::unique_ptr<BoundaryPartition> m_partition;
+    mutable std::vector<const BoundaryBox*> m_partitionRegions;
+    mutable std::atomic<bool> m_partitionValid;
+    mutable std::mutex m_partitionMutex;
+    std::vector<ChangeCallback> m_callbacks;
     
     bool ValidateBoundaryName(const std::string& name) const;
     void UpdateActiveColors(BoundaryBox& boundary, const std::string& activeVersion);
+    const ColorMask& ResolveVersionColors(const BoundaryBox& boundary, int codeIndex) const;
+    static ColorMask ComposeVersionColors(const BoundaryBox& boundary, const std::string& version);
+    static std::uint16_t GetCodesUsingComponent(char versionComponent);
+    void NotifyChange(const ColorMask& affectedColors);
+    bool IsCenterInExtents(const BoundaryBox& boundary, double x, double y) const;
+    bool IsCenterOwned(const BoundaryBox& boundary, double x, double y) const;
+    void InvalidatePartition() { m_partitionValid = false; }
+    void RebuildPartition() { InvalidatePartition(); EnsurePartition(); }
+    void EnsurePartition() const;
+    bool ApplyOutline(BoundaryBox& boundary, const std::vector<double>& xs, const std::vector<double>& ys) const;
+    bool HasBoundaryOutline(const std::string& attachmentPlan,
+                            const std::vector<double>& xs, const std::vector<double>& ys) const;
+    int GetPartitionRegion(const BoundaryBox& boundary) const;
+    void GetSnapshotRows(double minX, double minY, double maxX, double maxY, std::vector<std::uint32_t>& rows) const;
+    void ClipPartitionCells(int region, BoundaryTotals& totals) const;
+    void ClipBoundary(const BoundaryBox& boundary, BoundaryTotals& totals) const;
+    void FilterByCenter(const BoundaryBox& boundary, const std::vector<std::uint64_t>& candidates,
+                        std::vector<std::uint64_t>& handles) const;
     
 #ifndef BUILDING_TESTS
 #if HAS_BRX_SDK
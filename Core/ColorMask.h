@@ -0,0 +1,113 @@
+// ColorMask.h - Fixed 256-bit set of ACI color indices
+#pragma once
+
+#include <bitset>
+#include <cstdint>
+#include <vector>
+
+namespace EnhancedTakeoff {
+
+/**
+ * Set of ACI color indices (0-255) stored as four 64-bit words
+ * Union, intersection and differences are four word operations; out-of-range indices are ignored
+ * COPILOT-HINT: Use for per-boundary color sets - public APIs still hand out sorted vectors
+ */
+class ColorMask {
+public:
+    static const int kColorCount = 256;
+    static const int kWordCount = 4;
+
+    ColorMask() : m_words{ 0, 0, 0, 0 } {}
+    explicit ColorMask(const std::vector<int>& colorIndices) : ColorMask() {
+        for (int colorIndex : colorIndices) Set(colorIndex);
+    }
+
+    void Set(int colorIndex) {
+        if (IsValid(colorIndex)) m_words[colorIndex >> 6] |= Bit(colorIndex);
+    }
+    void Reset(int colorIndex) {
+        if (IsValid(colorIndex)) m_words[colorIndex >> 6] &= ~Bit(colorIndex);
+    }
+    bool Test(int colorIndex) const {
+        return IsValid(colorIndex) && (m_words[colorIndex >> 6] & Bit(colorIndex)) != 0;
+    }
+    void Clear() {
+        for (int w = 0; w < kWordCount; ++w) m_words[w] = 0;
+    }
+    static ColorMask All() {
+        ColorMask mask;
+        for (int w = 0; w < kWordCount; ++w) mask.m_words[w] = ~0ull;
+        return mask;
+    }
+
+    bool IsEmpty() const {
+        return (m_words[0] | m_words[1] | m_words[2] | m_words[3]) == 0;
+    }
+    int Count() const {
+        int count = 0;
+        for (int w = 0; w < kWordCount; ++w) count += static_cast<int>(std::bitset<64>(m_words[w]).count());
+        return count;
+    }
+
+    ColorMask& operator|=(const ColorMask& other) {
+        for (int w = 0; w < kWordCount; ++w) m_words[w] |= other.m_words[w];
+        return *this;
+    }
+    ColorMask& operator&=(const ColorMask& other) {
+        for (int w = 0; w < kWordCount; ++w) m_words[w] &= other.m_words[w];
+        return *this;
+    }
+    ColorMask& operator^=(const ColorMask& other) {
+        for (int w = 0; w < kWordCount; ++w) m_words[w] ^= other.m_words[w];
+        return *this;
+    }
+
+    // Colors in this set but not in 'other'
+    ColorMask Minus(const ColorMask& other) const {
+        ColorMask result;
+        for (int w = 0; w < kWordCount; ++w) result.m_words[w] = m_words[w] & ~other.m_words[w];
+        return result;
+    }
+
+    bool operator==(const ColorMask& other) const {
+        for (int w = 0; w < kWordCount; ++w) {
+            if (m_words[w] != other.m_words[w]) return false;
+        }
+        return true;
+    }
+    bool operator!=(const ColorMask& other) const { return !(*this == other); }
+
+    // Calls function(colorIndex) for every color in the set, ascending
+    template <typename Function>
+    void ForEach(Function function) const {
+        for (int w = 0; w < kWordCount; ++w) {
+            for (std::uint64_t word = m_words[w]; word != 0; word &= word - 1) {
+                const std::uint64_t lowest = word & (~word + 1);
+                function(w * 64 + static_cast<int>(std::bitset<64>(lowest - 1).count()));
+            }
+        }
+    }
+
+    // Ascending color indices
+    std::vector<int> ToVector() const {
+        std::vector<int> colorIndices;
+        colorIndices.reserve(Count());
+        ForEach([&colorIndices](int colorIndex) { colorIndices.push_back(colorIndex); });
+        return colorIndices;
+    }
+
+    std::uint64_t GetWord(int index) const { return m_words[index]; }
+    void SetWord(int index, std::uint64_t word) { m_words[index] = word; }
+
+private:
+    std::uint64_t m_words[kWordCount];
+
+    static bool IsValid(int colorIndex) { return colorIndex >= 0 && colorIndex < kColorCount; }
+    static std::uint64_t Bit(int colorIndex) { return 1ull << (colorIndex & 63); }
+};
+
+inline ColorMask operator|(ColorMask a, const ColorMask& b) { return a |= b; }
+inline ColorMask operator&(ColorMask a, const ColorMask& b) { return a &= b; }
+inline ColorMask operator^(ColorMask a, const ColorMask& b) { return a ^= b; }
+
+} // namespace EnhancedTakeoff
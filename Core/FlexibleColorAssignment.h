@@ -3,8 +3,17 @@
 
 #include <string>
 #include <vector>
+#include <deque>
 #include <map>
+#include <unordered_map>
 #include <functional>
+#include <memory>
+#include <cstdint>
+
+#include "ColorMask.h"
+#include "MaterialLibrary.h"
+#include "NameTable.h"
+#include "TrueColorTable.h"
 
 #ifndef BUILDING_TESTS
 #if HAS_BRX_SDK
@@ -21,6 +30,8 @@ namespace EnhancedTakeoff {
  * COPILOT-HINT: This replaces the old ColorMaterialMapper fixed system
  */
 class FlexibleColorAssignment {
+    struct State;   // One version of the table - see Snapshot
+    
 public:
     enum class MeasurementType {
         LF,           // Linear feet
@@ -31,10 +42,11 @@ public:
         LF_HIP,       // Linear feet for hip between pitches
         CUSTOM        // User-defined measurement
     };
+    static const int kMeasurementTypeCount = static_cast<int>(MeasurementType::CUSTOM) + 1;
     
     struct ColorAssignment {
         int colorIndex;                          // BricsCAD color index (1-255)
-        std::string materialName;                // User-defined material name
+        InternedName materialName;               // User-defined material name
         std::vector<MeasurementType> measurementTypes;  // Multiple types allowed
         double unitCost;                         // Cost per unit
         std::string excelCell;                   // Direct Excel cell mapping
@@ -57,6 +69,7 @@ public:
     bool AssignColor(int colorIndex, const ColorAssignment& assignment);
     bool AssignTrueColor(int r, int g, int b, const ColorAssignment& assignment);
     bool RemoveColorAssignment(int colorIndex);
+    bool RemoveTrueColorAssignment(int r, int g, int b);
     void ClearAllAssignments();
     
     // Material management
@@ -71,12 +84,26 @@ public:
     std::vector<MeasurementType> GetMeasurementTypes(int colorIndex) const;
     
     // Query methods
+    // The returned record may be edited in place until the next assignment update; do not keep the pointer
+    // past it. In-place edits are not undo steps. Read-only callers should use FindAssignment
     ColorAssignment* GetAssignment(int colorIndex);
+    const ColorAssignment* FindAssignment(int colorIndex) const;
     std::vector<ColorAssignment> GetAllAssignments() const;
     std::vector<int> GetAssignedColors() const;
     bool IsColorAssigned(int colorIndex) const;
     
-    // Material library integration
+    // True-color assignments are keyed by exact 24-bit RGB, apart from the ACI slots above
+    const ColorAssignment* GetTrueColorAssignment(int r, int g, int b) const;
+    std::vector<ColorAssignment> GetAllTrueColorAssignments() const;   // Ascending RGB
+    bool IsTrueColorAssigned(int r, int g, int b) const;
+    
+    // Entity classification - exact RGB hit first (rgb from TrueColorTable::Pack, kNoColor for
+    // ACI entities), then the ACI slot; nullptr when neither is assigned. Never allocates
+    const ColorAssignment* ClassifyColor(int colorIndex, std::uint32_t rgb = TrueColorTable::kNoColor) const;
+    
+    // Material library integration - search and page through GetMaterialLibrary(); GetAvailableMaterials
+    // copies every name (alphabetical) and is only meant for small libraries
+    const MaterialLibrary& GetMaterialLibrary() const { return m_materialLibrary; }
     std::vector<std::string> GetAvailableMaterials() const;
     bool ImportMaterialLibrary(const std::string& libraryPath);
     
@@ -97,9 +124,31 @@ public:
                             double pitchFactor = 1.0) const;
     double CalculateCost(int colorIndex, double quantity) const;
     
+    // Batch calculation - column views over many values (e.g. one per entity)
+    // Assignments are resolved once per call and work is grouped by measurement type
+    struct QuantityBatch {
+        const int* colorIndices;
+        const double* rawValues;
+        const MeasurementType* types;     // nullptr = 'uniformType' for every value
+        const double* pitchFactors;       // nullptr = 1.0 for every value
+        MeasurementType uniformType;
+        size_t count;
+        
+        QuantityBatch() : colorIndices(nullptr), rawValues(nullptr), types(nullptr),
+                          pitchFactors(nullptr), uniformType(MeasurementType::LF), count(0) {}
+    };
+    void CalculateQuantities(const QuantityBatch& batch, double* quantities) const;
+    void CalculateCosts(const int* colorIndices, const double* quantities, size_t count,
+                        double* costs) const;
+    
     // Presets and templates
+    struct PresetError {
+        size_t line;                             // 1-based, 0 when not tied to a line
+        std::string message;
+    };
     bool SavePreset(const std::string& presetName, const std::string& filePath) const;
-    bool LoadPreset(const std::string& filePath);
+    // The whole file is validated first - on any error the current assignments are left untouched
+    bool LoadPreset(const std::string& filePath, std::vector<PresetError>* errors = nullptr);
     std::vector<std::string> GetAvailablePresets() const;
     
     // Boundary box color filtering
@@ -108,16 +157,146 @@ public:
                           const std::vector<int>& colorIndices);
     
     // Event callbacks for UI updates
+    // colorIndex is -1 when several colors changed at once (a batch, a clear or a preset load)
     using ColorChangeCallback = std::function<void(int colorIndex)>;
     void RegisterColorChangeCallback(ColorChangeCallback callback);
     
+    // Coalesced form - one call per dispatch with every changed color (all 256 after a clear/load)
+    // Async listeners run on a background thread in order; they must not call back into this object
+    enum class DispatchMode {
+        Synchronous,
+        Async
+    };
+    using ColorMaskCallback = std::function<void(const ColorMask& changedColors)>;
+    void RegisterColorMaskCallback(ColorMaskCallback callback, DispatchMode mode = DispatchMode::Synchronous);
+    void FlushAsyncNotifications();     // Returns once async listeners have seen every dispatch
+    
+    // Update batches defer notifications and dispatch once when the outermost batch ends
+    void BeginUpdate();
+    void EndUpdate();
+    
+    class UpdateBatch {
+    public:
+        explicit UpdateBatch(FlexibleColorAssignment& owner) : m_owner(owner) { m_owner.BeginUpdate(); }
+        ~UpdateBatch() { m_owner.EndUpdate(); }
+        UpdateBatch(const UpdateBatch&) = delete;
+        UpdateBatch& operator=(const UpdateBatch&) = delete;
+        
+    private:
+        FlexibleColorAssignment& m_owner;
+    };
+    
+    // Copy-on-write versions of the whole table (ACI slots and true colors) for what-if pricing
+    // Taking one is O(1) - pages of 16 colors stay shared until the live table writes to them
+    class Snapshot {
+    public:
+        Snapshot() {}
+        bool IsValid() const { return m_state != nullptr; }
+        
+        // Answers as the live table gave them when the snapshot was taken
+        // Returned pointers stay valid for the lifetime of the snapshot
+        const ColorAssignment* GetAssignment(int colorIndex) const;
+        std::vector<int> GetAssignedColors() const;
+        const ColorAssignment* ClassifyColor(int colorIndex, std::uint32_t rgb = TrueColorTable::kNoColor) const;
+        double CalculateCost(int colorIndex, double quantity) const;
+        void CalculateCosts(const int* colorIndices, const double* quantities, size_t count,
+                            double* costs) const;
+        
+    private:
+        friend class FlexibleColorAssignment;
+        std::shared_ptr<const State> m_state;
+    };
+    Snapshot TakeSnapshot() const;
+    void RestoreSnapshot(const Snapshot& snapshot);     // Recorded as one undo step
+    static ColorMask GetChangedColors(const Snapshot& from, const Snapshot& to);
+    
+    // Undo/redo - every dispatched change is one step (a whole UpdateBatch, a preset load)
+    // Not available inside an update batch
+    static const size_t kMaxUndoSteps = 100;
+    bool CanUndo() const { return !m_undo.empty(); }
+    bool CanRedo() const { return !m_redo.empty(); }
+    bool Undo();
+    bool Redo();
+    void ClearHistory();
+    
 private:
-    std::map<int, ColorAssignment> m_assignments;
-    std::map<std::string, std::vector<int>> m_boundaryFilters;
+    // Hot per-color data read by the cost paths - 8 bytes per ACI index
+    struct HotSlot {
+        double unitCost;
+        
+        HotSlot() : unitCost(0.0) {}
+    };
+    static const int kSlotCount = ColorMask::kColorCount;
+    static const int kPageBits = 4;
+    static const int kPageSize = 1 << kPageBits;
+    static const int kPageCount = kSlotCount / kPageSize;
+    
+    // 16 colors of hot slots and full records (strings, type order) - the unit of copy-on-write
+    struct Page {
+        HotSlot hot[kPageSize];
+        ColorAssignment cold[kPageSize];
+    };
+    
+    struct TrueColors {
+        TrueColorTable slots;                   // Packed RGB -> index into records
+        std::vector<ColorAssignment> records;
+    };
+    
+    // Never written while a snapshot, an undo step or a second root shares it
+    struct State {
+        std::shared_ptr<Page> pages[kPageCount];    // Direct-indexed by color >> kPageBits
+        ColorMask occupied;                         // Ascending iteration over assigned slots
+        std::shared_ptr<TrueColors> trueColors;
+    };
+    
+    std::shared_ptr<State> m_state;
+    std::shared_ptr<const State> m_editBase;    // Table before the change being built up, if any
+    std::deque<std::shared_ptr<const State>> m_undo;
+    std::deque<std::shared_ptr<const State>> m_redo;
+    ColorMask m_handedOut;                  // Slots exposed by GetAssignment - hot may lag cold
+    std::uint16_t m_pinnedPages;            // Pages holding such slots - only the live table owns them
+                                            // until the next committed change releases them
+    std::unordered_map<InternedName, std::vector<int>> m_boundaryFilters;
     std::vector<ColorChangeCallback> m_callbacks;
-    std::vector<std::string> m_materialLibrary;
+    std::vector<ColorMaskCallback> m_maskCallbacks;
+    class AsyncNotifier;
+    std::unique_ptr<AsyncNotifier> m_asyncNotifier;     // Started by the first async listener
+    int m_updateDepth;
+    ColorMask m_pendingColors;                          // Changed since the last dispatch
+    MaterialLibrary m_materialLibrary;
     
     void NotifyColorChange(int colorIndex);
+    void NotifyColorChanges(const ColorMask& changedColors);
+    void CommitChanges();
+    void ReleaseHandedOut();
+    void DispatchColorChanges(const ColorMask& changedColors);
+    static bool IsSlot(int colorIndex) { return colorIndex >= 0 && colorIndex < kSlotCount; }
+    bool IsOccupied(int colorIndex) const { return m_state->occupied.Test(colorIndex); }
+    const Page& PageOf(int colorIndex) const { return *m_state->pages[colorIndex >> kPageBits]; }
+    const ColorAssignment& Cold(int colorIndex) const { return PageOf(colorIndex).cold[colorIndex & (kPageSize - 1)]; }
+    
+    // Copy-on-write - BeginEdit records the undo base, Detach* copy whatever is still shared
+    void BeginEdit();
+    State& DetachState();
+    Page& DetachPage(int page);
+    ColorAssignment& EditSlot(int colorIndex);
+    TrueColors& EditTrueColors();
+    std::shared_ptr<const State> CaptureState() const;
+    void InstallState(const std::shared_ptr<const State>& state);
+    static ColorMask DiffStates(const State& from, const State& to);
+    static const ColorAssignment* FindSlot(const State& state, int colorIndex);
+    static const ColorAssignment* Classify(const State& state, int colorIndex, std::uint32_t rgb);
+    
+    void StoreSlot(int colorIndex, const ColorAssignment& assignment);
+    void ClearSlot(int colorIndex);
+    void ClearAllSlots();
+    void SyncHotSlot(int colorIndex);
+    static void SyncHot(Page& page, int slot);
+    double GetUnitCost(int colorIndex) const {
+        const Page& page = PageOf(colorIndex);
+        const int slot = colorIndex & (kPageSize - 1);
+        return m_handedOut.Test(colorIndex) ? page.cold[slot].unitCost : page.hot[slot].unitCost;
+    }
     int GetColorFromRGB(int r, int g, int b) const;
     std::string GetMeasurementTypeString(MeasurementType type) const;
 };
@@ -0,0 +1,99 @@
+// MaterialLibrary.h - Searchable material/SKU name library
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "NameTable.h"
+
+namespace EnhancedTakeoff {
+
+/**
+ * Material names kept once, sorted case-insensitively, with a word index for typo-tolerant lookup
+ * Prefix lookups return a View straight into the sorted array; fuzzy lookups rank at most one page of
+ * matches into a caller-owned vector
+ * COPILOT-HINT: Case folding is ASCII-only (UTF-8 bytes pass through unchanged); words are runs of letters,
+ * digits and non-ASCII bytes. Views stay valid until the next Assign/LoadFile
+ */
+class MaterialLibrary {
+public:
+    // Read-only window onto library storage - nothing is copied
+    class View {
+    public:
+        View() : m_names(nullptr), m_count(0) {}
+
+        size_t size() const { return m_count; }
+        bool empty() const { return m_count == 0; }
+        const InternedName& operator[](size_t index) const { return m_names[index]; }
+        const InternedName* begin() const { return m_names; }
+        const InternedName* end() const { return m_names + m_count; }
+
+        // Rows [offset, offset + count), clamped - one screen of a list at a time
+        View Page(size_t offset, size_t count) const {
+            const size_t first = (offset < m_count) ? offset : m_count;
+            return View(m_names + first, (count < m_count - first) ? count : m_count - first);
+        }
+
+    private:
+        friend class MaterialLibrary;
+        View(const InternedName* names, size_t count) : m_names(names), m_count(count) {}
+
+        const InternedName* m_names;
+        size_t m_count;
+    };
+
+    struct Match {
+        InternedName name;
+        int distance;           // Edits summed over the query words
+    };
+
+    static const size_t kMaxQueryLength = 64;   // Longer fuzzy queries are cut to this
+
+    MaterialLibrary() {}
+
+    // Replaces the contents; blank entries and exact duplicates are dropped, surrounding spaces trimmed
+    void Assign(const std::vector<std::string_view>& names);
+    // One name per line (optional UTF-8 BOM, \n or \r\n); contents are untouched when the file cannot be read
+    bool LoadFile(const std::string& filePath);
+
+    size_t GetCount() const { return m_names.size(); }
+    View GetAll() const { return View(m_names.data(), m_names.size()); }   // Alphabetical, ignoring case
+
+    // Every name starting with prefix, ignoring case, alphabetical - O(log n)
+    View FindPrefix(std::string_view prefix) const;
+
+    // Names containing every word of query, in any order, each within maxEditsPerWord edits (insert, delete,
+    // substitute or swap two neighbours); the last word also matches the start of a longer word while the
+    // user is still typing it. Best first: fewest edits, then names starting with the query, then shorter,
+    // then alphabetical. maxEditsPerWord < 0 scales with each word: 0 up to 2 characters, 1 up to 5, 2 beyond
+    // Fills matches with at most maxResults entries and returns how many
+    size_t FindFuzzy(std::string_view query, size_t maxResults, std::vector<Match>& matches,
+                     int maxEditsPerWord = -1) const;
+
+private:
+    static std::string_view Slice(const std::string& text, const std::vector<std::uint32_t>& offsets, size_t index) {
+        return std::string_view(text.data() + offsets[index], offsets[index + 1] - offsets[index]);
+    }
+    std::string_view Folded(size_t entry) const { return Slice(m_folded, m_foldedOffsets, entry); }
+    std::string_view Word(size_t word) const { return Slice(m_words, m_wordOffsets, word); }
+    void BuildWordIndex();
+    // Lowers best[entry] to the fewest edits between word and any word of that name; names first
+    // given a value are appended to touched
+    void MatchWord(std::string_view word, bool asPrefix, int maxEdits, std::vector<std::uint8_t>& best,
+                   std::vector<std::uint32_t>& touched) const;
+
+    std::vector<InternedName> m_names;              // Sorted by folded text - entry i is row i of GetAll
+    std::string m_folded;                           // Lower-cased names back to back
+    std::vector<std::uint32_t> m_foldedOffsets;     // Entry i is [offsets[i], offsets[i + 1])
+    std::string m_words;                            // Distinct words of all names, sorted, back to back
+    std::vector<std::uint32_t> m_wordOffsets;
+    std::vector<std::uint32_t> m_wordEntryOffsets;  // Names using word w: [offsets[w], offsets[w + 1]) of m_wordEntries
+    std::vector<std::uint32_t> m_wordEntries;       // Ascending per word
+    std::vector<std::uint32_t> m_bigramOffsets;     // 65537 - words containing byte pair (a << 8 | b)
+    std::vector<std::uint32_t> m_bigramWords;       // Ascending per pair
+};
+
+} // namespace EnhancedTakeoff
@@ -0,0 +1,88 @@
+// NameTable.h - Process-wide interned string pool for material, plan, layer and boundary names
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iosfwd>
+#include <string>
+#include <string_view>
+
+namespace EnhancedTakeoff {
+
+using NameId = std::uint32_t;
+
+/**
+ * Every distinct name is stored once and identified by a dense 32-bit id for the life of the process
+ * Ids are handed out in first-seen order, so they say nothing about alphabetical order
+ * COPILOT-HINT: Intern/Find take a lock; GetText does not - call sites that compare or hash names
+ * should hold an InternedName and stay on ids
+ */
+class NameTable {
+public:
+    static const NameId kEmptyName = 0;             // "" is always interned as id 0
+    static const NameId kNotInterned = 0xFFFFFFFFu; // From Find - matches no stored name
+
+    // Id for text, adding it on first sight
+    static NameId Intern(std::string_view text);
+    // Lookup only - never grows the table, so unknown user input does not leak into it
+    static NameId Find(std::string_view text);
+    // Stable reference (never moves or dies); "" for kNotInterned
+    static const std::string& GetText(NameId id);
+    static size_t GetCount();
+};
+
+/**
+ * Value type over a NameId - converts from and to std::string at API boundaries,
+ * compares and hashes by id (O(1)), 4 bytes per copy
+ */
+class InternedName {
+public:
+    InternedName() : m_id(NameTable::kEmptyName) {}
+    InternedName(const std::string& text) : m_id(NameTable::Intern(text)) {}
+    InternedName(const char* text) : m_id(NameTable::Intern(text ? text : "")) {}
+    explicit InternedName(std::string_view text) : m_id(NameTable::Intern(text)) {}
+
+    // Lookup without interning - equal to no stored name when text was never seen
+    static InternedName Find(std::string_view text) { return InternedName(NameTable::Find(text), 0); }
+
+    NameId GetId() const { return m_id; }
+    const std::string& str() const { return NameTable::GetText(m_id); }
+    operator const std::string&() const { return str(); }
+    const char* c_str() const { return str().c_str(); }
+    size_t size() const { return str().size(); }
+    bool empty() const { return m_id == NameTable::kEmptyName || m_id == NameTable::kNotInterned; }
+
+    bool operator==(const InternedName& other) const { return m_id == other.m_id; }
+    bool operator!=(const InternedName& other) const { return m_id != other.m_id; }
+
+    // Alphabetical, for sorting output - containers key on the id through std::hash
+    static bool TextLess(const InternedName& a, const InternedName& b) { return a.str() < b.str(); }
+
+private:
+    InternedName(NameId id, int) : m_id(id) {}
+
+    NameId m_id;
+};
+
+// Text comparisons against plain strings never intern the other side
+inline bool operator==(const InternedName& name, const std::string& text) { return name.str() == text; }
+inline bool operator==(const std::string& text, const InternedName& name) { return name.str() == text; }
+inline bool operator!=(const InternedName& name, const std::string& text) { return name.str() != text; }
+inline bool operator!=(const std::string& text, const InternedName& name) { return name.str() != text; }
+inline bool operator==(const InternedName& name, const char* text) { return name.str() == text; }
+inline bool operator!=(const InternedName& name, const char* text) { return name.str() != text; }
+
+std::ostream& operator<<(std::ostream& stream, const InternedName& name);
+
+} // namespace EnhancedTakeoff
+
+namespace std {
+template <>
+struct hash<EnhancedTakeoff::InternedName> {
+    size_t operator()(const EnhancedTakeoff::InternedName& name) const {
+        // Ids are dense - spread them before they reach a power-of-two bucket count
+        return static_cast<size_t>(name.GetId() * 2654435769u);
+    }
+};
+}
@@ -0,0 +1,306 @@
+// AciPalette.cpp - AutoCAD Color Index palette and perceptual nearest-ACI lookup
+// Enhanced Construction Takeoff - BricsCAD V25 Plugin
+// COPILOT-HINT: Every distance goes through the same ToLab/DistanceSquared pair so the LUT
+// and the brute-force reference agree bit for bit, ties included
+
+#include "pch.h"
+#include "AciPalette.h"
+
+#include <atomic>
+#include <cmath>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace EnhancedTakeoff {
+
+namespace {
+    // Standard ACI palette (DXF default colors); 10-249 are 24 hues x 5 shades x full/pastel
+    const AciPalette::Rgb kPalette[256] = {
+    {  0,   0,   0}, {255,   0,   0}, {255, 255,   0}, {  0, 255,   0}, {  0, 255, 255},
+    {  0,   0, 255}, {255,   0, 255}, {255, 255, 255}, {128, 128, 128}, {192, 192, 192},   // 0-9
+    {255,   0,   0}, {255, 170, 170}, {189,   0,   0}, {189, 126, 126}, {129,   0,   0},
+    {129,  86,  86}, {104,   0,   0}, {104,  69,  69}, { 79,   0,   0}, { 79,  53,  53},   // 10-19
+    {255,  63,   0}, {255, 191, 170}, {189,  47,   0}, {189, 141, 126}, {129,  32,   0},
+    {129,  96,  86}, {104,  26,   0}, {104,  77,  69}, { 79,  19,   0}, { 79,  59,  53},   // 20-29
+    {255, 127,   0}, {255, 212, 170}, {189,  94,   0}, {189, 157, 126}, {129,  64,   0},
+    {129, 107,  86}, {104,  52,   0}, {104,  86,  69}, { 79,  39,   0}, { 79,  66,  53},   // 30-39
+    {255, 191,   0}, {255, 233, 170}, {189, 141,   0}, {189, 173, 126}, {129,  96,   0},
+    {129, 118,  86}, {104,  78,   0}, {104,  95,  69}, { 79,  59,   0}, { 79,  72,  53},   // 40-49
+    {255, 255,   0}, {255, 255, 170}, {189, 189,   0}, {189, 189, 126}, {129, 129,   0},
+    {129, 129,  86}, {104, 104,   0}, {104, 104,  69}, { 79,  79,   0}, { 79,  79,  53},   // 50-59
+    {191, 255,   0}, {233, 255, 170}, {141, 189,   0}, {173, 189, 126}, { 96, 129,   0},
+    {118, 129,  86}, { 78, 104,   0}, { 95, 104,  69}, { 59,  79,   0}, { 72,  79,  53},   // 60-69
+    {127, 255,   0}, {212, 255, 170}, { 94, 189,   0}, {157, 189, 126}, { 64, 129,   0},
+    {107, 129,  86}, { 52, 104,   0}, { 86, 104,  69}, { 39,  79,   0}, { 66,  79,  53},   // 70-79
+    { 63, 255,   0}, {191, 255, 170}, { 47, 189,   0}, {141, 189, 126}, { 32, 129,   0},
+    { 96, 129,  86}, { 26, 104,   0}, { 77, 104,  69}, { 19,  79,   0}, { 59,  79,  53},   // 80-89
+    {  0, 255,   0}, {170, 255, 170}, {  0, 189,   0}, {126, 189, 126}, {  0, 129,   0},
+    { 86, 129,  86}, {  0, 104,   0}, { 69, 104,  69}, {  0,  79,   0}, { 53,  79,  53},   // 90-99
+    {  0, 255,  63}, {170, 255, 191}, {  0, 189,  47}, {126, 189, 141}, {  0, 129,  32},
+    { 86, 129,  96}, {  0, 104,  26}, { 69, 104,  77}, {  0,  79,  19}, { 53,  79,  59},   // 100-109
+    {  0, 255, 127}, {170, 255, 212}, {  0, 189,  94}, {126, 189, 157}, {  0, 129,  64},
+    { 86, 129, 107}, {  0, 104,  52}, { 69, 104,  86}, {  0,  79,  39}, { 53,  79,  66},   // 110-119
+    {  0, 255, 191}, {170, 255, 233}, {  0, 189, 141}, {126, 189, 173}, {  0, 129,  96},
+    { 86, 129, 118}, {  0, 104,  78}, { 69, 104,  95}, {  0,  79,  59}, { 53,  79,  72},   // 120-129
+    {  0, 255, 255}, {170, 255, 255}, {  0, 189, 189}, {126, 189, 189}, {  0, 129, 129},
+    { 86, 129, 129}, {  0, 104, 104}, { 69, 104, 104}, {  0,  79,  79}, { 53,  79,  79},   // 130-139
+    {  0, 191, 255}, {170, 233, 255}, {  0, 141, 189}, {126, 173, 189}, {  0,  96, 129},
+    { 86, 118, 129}, {  0,  78, 104}, { 69,  95, 104}, {  0,  59,  79}, { 53,  72,  79},   // 140-149
+    {  0, 127, 255}, {170, 212, 255}, {  0,  94, 189}, {126, 157, 189}, {  0,  64, 129},
+    { 86, 107, 129}, {  0,  52, 104}, { 69,  86, 104}, {  0,  39,  79}, { 53,  66,  79},   // 150-159
+    {  0,  63, 255}, {170, 191, 255}, {  0,  47, 189}, {126, 141, 189}, {  0,  32, 129},
+    { 86,  96, 129}, {  0,  26, 104}, { 69,  77, 104}, {  0,  19,  79}, { 53,  59,  79},   // 160-169
+    {  0,   0, 255}, {170, 170, 255}, {  0,   0, 189}, {126, 126, 189}, {  0,   0, 129},
+    { 86,  86, 129}, {  0,   0, 104}, { 69,  69, 104}, {  0,   0,  79}, { 53,  53,  79},   // 170-179
+    { 63,   0, 255}, {191, 170, 255}, { 47,   0, 189}, {141, 126, 189}, { 32,   0, 129},
+    { 96,  86, 129}, { 26,   0, 104}, { 77,  69, 104}, { 19,   0,  79}, { 59,  53,  79},   // 180-189
+    {127,   0, 255}, {212, 170, 255}, { 94,   0, 189}, {157, 126, 189}, { 64,   0, 129},
+    {107,  86, 129}, { 52,   0, 104}, { 86,  69, 104}, { 39,   0,  79}, { 66,  53,  79},   // 190-199
+    {191,   0, 255}, {233, 170, 255}, {141,   0, 189}, {173, 126, 189}, { 96,   0, 129},
+    {118,  86, 129}, { 78,   0, 104}, { 95,  69, 104}, { 59,   0,  79}, { 72,  53,  79},   // 200-209
+    {255,   0, 255}, {255, 170, 255}, {189,   0, 189}, {189, 126, 189}, {129,   0, 129},
+    {129,  86, 129}, {104,   0, 104}, {104,  69, 104}, { 79,   0,  79}, { 79,  53,  79},   // 210-219
+    {255,   0, 191}, {255, 170, 233}, {189,   0, 141}, {189, 126, 173}, {129,   0,  96},
+    {129,  86, 118}, {104,   0,  78}, {104,  69,  95}, { 79,   0,  59}, { 79,  53,  72},   // 220-229
+    {255,   0, 127}, {255, 170, 212}, {189,   0,  94}, {189, 126, 157}, {129,   0,  64},
+    {129,  86, 107}, {104,   0,  52}, {104,  69,  86}, { 79,   0,  39}, { 79,  53,  66},   // 230-239
+    {255,   0,  63}, {255, 170, 191}, {189,   0,  47}, {189, 126, 141}, {129,   0,  32},
+    {129,  86,  96}, {104,   0,  26}, {104,  69,  77}, { 79,   0,  19}, { 79,  53,  59},   // 240-249
+    { 51,  51,  51}, { 80,  80,  80}, {105, 105, 105}, {130, 130, 130}, {190, 190, 190},
+    {255, 255, 255}                                                                        // 250-255
+    };
+
+    const int kCellBits = 3;                            // 8x8x8 RGB values per cell
+    const int kCellsPerAxis = 256 >> kCellBits;         // 32
+    const int kCellMask = (1 << kCellBits) - 1;
+    const int kBlockSize = 1 << (3 * kCellBits);        // Exact answers for one refined cell
+    const std::uint16_t kRefinedCell = 0x8000;          // Low bits index the refined cells
+
+    struct Lab {
+        double l, a, b;
+    };
+
+    // sRGB transfer curve, 0-255 in (fractional values allowed for cell centers)
+    double Linearize(double value) {
+        const double c = value / 255.0;
+        return (c <= 0.04045) ? c / 12.92 : std::pow((c + 0.055) / 1.055, 2.4);
+    }
+
+    struct LinearTable {
+        double values[256];
+        LinearTable() {
+            for (int i = 0; i < 256; ++i) values[i] = Linearize(i);
+        }
+    };
+
+    double LabCurve(double t) {
+        const double delta = 6.0 / 29.0;
+        return (t > delta * delta * delta) ? std::cbrt(t) : t / (3.0 * delta * delta) + 4.0 / 29.0;
+    }
+
+    // Linear sRGB (D65) -> XYZ -> CIELAB
+    Lab LinearToLab(double lr, double lg, double lb) {
+        const double x = (0.4124564 * lr + 0.3575761 * lg + 0.1804375 * lb) / 0.95047;
+        const double y = (0.2126729 * lr + 0.7151522 * lg + 0.0721750 * lb);
+        const double z = (0.0193339 * lr + 0.1191920 * lg + 0.9503041 * lb) / 1.08883;
+        const double fx = LabCurve(x), fy = LabCurve(y), fz = LabCurve(z);
+        return Lab{ 116.0 * fy - 16.0, 500.0 * (fx - fy), 200.0 * (fy - fz) };
+    }
+
+    Lab ToLab(double r, double g, double b) {
+        return LinearToLab(Linearize(r), Linearize(g), Linearize(b));
+    }
+
+    // Integer channels - same values as ToLab, without the pow calls
+    Lab ToLab(int r, int g, int b) {
+        static const LinearTable table;
+        return LinearToLab(table.values[r], table.values[g], table.values[b]);
+    }
+
+    double DistanceSquared(const Lab& p, const Lab& q) {
+        const double dl = p.l - q.l, da = p.a - q.a, db = p.b - q.b;
+        return dl * dl + da * da + db * db;
+    }
+
+    struct PaletteLut {
+        Lab paletteLab[256];
+        std::vector<std::uint16_t> cells;               // ACI when uniform, else kRefinedCell | refined
+        std::vector<std::uint32_t> listOffsets;         // Candidate range per refined cell
+        std::vector<std::uint8_t> candidates;           // Ascending ACI indices
+        size_t uniformCells;
+
+        // Per refined cell, kBlockSize exact answers filled from the candidates on first use
+        std::unique_ptr<std::atomic<const std::uint8_t*>[]> blocks;
+        std::vector<std::unique_ptr<std::uint8_t[]>> blockStorage;
+        std::mutex blockMutex;
+
+        PaletteLut();
+        const std::uint8_t* FillBlock(size_t refined, int r, int g, int b);
+
+        // Lowest-distance entry among 'count' ascending indices, strict < keeps the lower index on ties
+        int Best(const Lab& color, const std::uint8_t* indices, size_t count) const {
+            int best = indices[0];
+            double bestDistance = DistanceSquared(color, paletteLab[best]);
+            for (size_t i = 1; i < count; ++i) {
+                const double distance = DistanceSquared(color, paletteLab[indices[i]]);
+                if (distance < bestDistance) {
+                    bestDistance = distance;
+                    best = indices[i];
+                }
+            }
+            return best;
+        }
+    };
+
+    PaletteLut::PaletteLut() : uniformCells(0) {
+        for (int i = 0; i < 256; ++i) {
+            paletteLab[i] = ToLab(kPalette[i].r, kPalette[i].g, kPalette[i].b);
+        }
+
+        cells.resize(kCellsPerAxis * kCellsPerAxis * kCellsPerAxis);
+        listOffsets.push_back(0);
+        const int cellSize = 1 << kCellBits;
+        double centerDistances[256];
+        for (int cr = 0; cr < kCellsPerAxis; ++cr) {
+            for (int cg = 0; cg < kCellsPerAxis; ++cg) {
+                for (int cb = 0; cb < kCellsPerAxis; ++cb) {
+                    // Radius of the cell in Lab from its center, taken at the 8 corner values
+                    const double lo[3] = { double(cr * cellSize), double(cg * cellSize), double(cb * cellSize) };
+                    const Lab center = ToLab(lo[0] + 0.5 * (cellSize - 1), lo[1] + 0.5 * (cellSize - 1),
+                                             lo[2] + 0.5 * (cellSize - 1));
+                    double radius = 0.0;
+                    for (int corner = 0; corner < 8; ++corner) {
+                        const Lab lab = ToLab(lo[0] + ((corner & 1) ? cellSize - 1 : 0),
+                                              lo[1] + ((corner & 2) ? cellSize - 1 : 0),
+                                              lo[2] + ((corner & 4) ? cellSize - 1 : 0));
+                        radius = std::fmax(radius, std::sqrt(DistanceSquared(center, lab)));
+                    }
+                    // The Lab image of the cube bulges slightly past its corners - pad the radius
+                    radius = radius * 1.25 + 1e-6;
+
+                    double nearest = HUGE_VAL;
+                    for (int i = 1; i < 256; ++i) {
+                        centerDistances[i] = std::sqrt(DistanceSquared(center, paletteLab[i]));
+                        nearest = std::fmin(nearest, centerDistances[i]);
+                    }
+
+                    // An entry farther than nearest + 2r from the center loses to the nearest entry everywhere in the cell
+                    const size_t first = candidates.size();
+                    for (int i = 1; i < 256; ++i) {
+                        if (centerDistances[i] <= nearest + 2.0 * radius) {
+                            candidates.push_back(static_cast<std::uint8_t>(i));
+                        }
+                    }
+
+                    const size_t cell = (static_cast<size_t>(cr) * kCellsPerAxis + cg) * kCellsPerAxis + cb;
+                    if (candidates.size() - first == 1) {
+                        cells[cell] = candidates[first];
+                        candidates.resize(first);
+                        ++uniformCells;
+                    } else {
+                        cells[cell] = static_cast<std::uint16_t>(kRefinedCell | (listOffsets.size() - 1));
+                        listOffsets.push_back(static_cast<std::uint32_t>(candidates.size()));
+                    }
+                }
+            }
+        }
+
+        const size_t refinedCells = listOffsets.size() - 1;
+        blocks.reset(new std::atomic<const std::uint8_t*>[refinedCells]);
+        for (size_t i = 0; i < refinedCells; ++i) {
+            blocks[i].store(nullptr, std::memory_order_relaxed);
+        }
+    }
+
+    // Any (r, g, b) inside the cell selects it
+    const std::uint8_t* PaletteLut::FillBlock(size_t refined, int r, int g, int b) {
+        std::lock_guard<std::mutex> lock(blockMutex);
+        const std::uint8_t* existing = blocks[refined].load(std::memory_order_acquire);
+        if (existing) {
+            return existing;
+        }
+
+        std::unique_ptr<std::uint8_t[]> block(new std::uint8_t[kBlockSize]);
+        const std::uint8_t* list = candidates.data() + listOffsets[refined];
+        const size_t count = listOffsets[refined + 1] - listOffsets[refined];
+        r &= ~kCellMask;
+        g &= ~kCellMask;
+        b &= ~kCellMask;
+        for (int i = 0; i < kBlockSize; ++i) {
+            const Lab color = ToLab(r + (i >> (2 * kCellBits)), g + ((i >> kCellBits) & kCellMask), b + (i & kCellMask));
+            block[i] = static_cast<std::uint8_t>(Best(color, list, count));
+        }
+
+        const std::uint8_t* published = block.get();
+        blockStorage.push_back(std::move(block));
+        blocks[refined].store(published, std::memory_order_release);
+        return published;
+    }
+
+    PaletteLut& GetLut() {
+        static PaletteLut lut;          // Thread-safe one-time build
+        return lut;
+    }
+}
+
+AciPalette::Rgb AciPalette::GetRgb(int colorIndex) {
+    return (colorIndex >= 0 && colorIndex < 256) ? kPalette[colorIndex] : kPalette[0];
+}
+
+int AciPalette::Nearest(int r, int g, int b) {
+    r = (r < 0) ? 0 : (r > 255 ? 255 : r);
+    g = (g < 0) ? 0 : (g > 255 ? 255 : g);
+    b = (b < 0) ? 0 : (b > 255 ? 255 : b);
+
+    PaletteLut& lut = GetLut();
+    const std::uint16_t cell = lut.cells[((r >> kCellBits) * kCellsPerAxis + (g >> kCellBits)) * kCellsPerAxis +
+                                         (b >> kCellBits)];
+    if (!(cell & kRefinedCell)) {
+        return cell;
+    }
+
+    // Mixed cell - one more load once its block exists
+    const size_t refined = cell & ~kRefinedCell;
+    const std::uint8_t* block = lut.blocks[refined].load(std::memory_order_acquire);
+    if (!block) {
+        block = lut.FillBlock(refined, r, g, b);
+    }
+    return block[((r & kCellMask) << (2 * kCellBits)) | ((g & kCellMask) << kCellBits) | (b & kCellMask)];
+}
+
+void AciPalette::NearestBatch(const std::uint32_t* rgbs, size_t count, int* colorIndices) {
+    // Drawings repeat a handful of true colors - consecutive duplicates reuse the last answer
+    std::uint32_t lastRgb = 0;
+    int lastIndex = -1;
+    for (size_t i = 0; i < count; ++i) {
+        const std::uint32_t rgb = rgbs[i] & 0xFFFFFFu;
+        if (lastIndex < 0 || rgb != lastRgb) {
+            lastRgb = rgb;
+            lastIndex = Nearest((rgb >> 16) & 0xFF, (rgb >> 8) & 0xFF, rgb & 0xFF);
+        }
+        colorIndices[i] = lastIndex;
+    }
+}
+
+int AciPalette::NearestExact(int r, int g, int b) {
+    r = (r < 0) ? 0 : (r > 255 ? 255 : r);
+    g = (g < 0) ? 0 : (g > 255 ? 255 : g);
+    b = (b < 0) ? 0 : (b > 255 ? 255 : b);
+
+    std::uint8_t allIndices[255];
+    for (int i = 1; i < 256; ++i) {
+        allIndices[i - 1] = static_cast<std::uint8_t>(i);
+    }
+    return GetLut().Best(ToLab(r, g, b), allIndices, 255);
+}
+
+size_t AciPalette::GetUniformCellCount() {
+    return GetLut().uniformCells;
+}
+
+size_t AciPalette::GetCandidateCount() {
+    return GetLut().candidates.size();
+}
+
+} // namespace EnhancedTakeoff
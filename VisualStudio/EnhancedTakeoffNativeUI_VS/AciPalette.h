@@ -0,0 +1,38 @@
+// AciPalette.h - AutoCAD Color Index palette and perceptual nearest-ACI lookup
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace EnhancedTakeoff {
+
+/**
+ * The 255-entry ACI palette and a true-color -> nearest ACI mapping by CIELAB distance (Delta E*ab)
+ * Lookups go through a 32x32x32 LUT over RGB: a cell whose whole RGB cube maps to one index
+ * answers with a single load, the rest keep a short candidate list that can contain the winner
+ * COPILOT-HINT: The LUT is built once on first use (about 8M distance terms) and is exact - Nearest == NearestExact
+ */
+class AciPalette {
+public:
+    struct Rgb {
+        std::uint8_t r, g, b;
+    };
+
+    // Palette RGB for 1-255 (0 ByBlock is reported as black)
+    static Rgb GetRgb(int colorIndex);
+
+    // Nearest ACI 1-255; ties go to the lower index
+    static int Nearest(int r, int g, int b);
+
+    // Packed 0xRRGGBB values, e.g. AcCmEntityColor::color() masked to 24 bits
+    static void NearestBatch(const std::uint32_t* rgbs, size_t count, int* colorIndices);
+
+    // Brute force over all 255 entries - reference for the LUT
+    static int NearestExact(int r, int g, int b);
+
+    // LUT shape, for diagnostics and benchmarks
+    static size_t GetUniformCellCount();
+    static size_t GetCandidateCount();
+};
+
+} // namespace EnhancedTakeoff
@@ -163,9 +163,9 @@ bool AttachmentManager::CreateMaterialBoundaryLayers(AcDbDatabase* pDb, AcDbTran
     
     for (const auto& material : materials) {
         // Create boundary, fill, and background layers for each material
-        CreateLayerIfNotExists(pLayerTable, pTr, "BOUNDARY_" + material.name, material.boundaryColor);
-        CreateLayerIfNotExists(pLayerTable, pTr, "FILL_" + material.name, material.fillColor);
-        CreateLayerIfNotExists(pLayerTable, pTr, "BACKGROUND_" + material.name, material.backgroundColor);
+        CreateLayerIfNotExists(pLayerTable, pTr, "BOUNDARY_" + material.name.str(), material.boundaryColor);
+        CreateLayerIfNotExists(pLayerTable, pTr, "FILL_" + material.name.str(), material.fillColor);
+        CreateLayerIfNotExists(pLayerTable, pTr, "BACKGROUND_" + material.name.str(), material.backgroundColor);
     }
     
     pLayerTable->close();
@@ -203,9 +203,10 @@ bool AttachmentManager::SetupLayerStates(AcDbDatabase* pDb, AcDbTransaction* pTr
     };
     
     for (const auto& stateName : layerStates) {
-        m_layerStates[stateName] = LayerStateManager();
-        m_layerStates[stateName].name = stateName;
-        m_layerStates[stateName].isActive = false;
+        LayerStateManager& state = m_layerStates[InternedName(stateName)];
+        state = LayerStateManager();
+        state.name = stateName;
+        state.isActive = false;
     }
     
     return true;
@@ -301,7 +302,7 @@ bool AttachmentManager::AttachPlan(const std::string& planPath, const std::strin
             config.isLoaded = true;
             config.elevationType = "AGS"; // Default
             
-            m_planConfigurations[planName] = config;
+            m_planConfigurations[config.name] = config;
             
             pTrans->endTransaction();
             NotifyChange("Plan '" + planName + "' attached successfully");
@@ -416,7 +417,7 @@ void AttachmentManager::AddBoundaryXData(AcDbEntity* pEntity, const std::string&
 #endif // HAS_BRX_SDK
 
 bool AttachmentManager::TogglePlan(const std::string& planName) {
-    auto it = m_planConfigurations.find(planName);
+    auto it = m_planConfigurations.find(InternedName::Find(planName));
     if (it == m_planConfigurations.end()) return false;
     
 #ifdef HAS_BRX_SDK
@@ -467,11 +468,11 @@ bool AttachmentManager::TogglePlan(const std::string& planName) {
 }
 
 bool AttachmentManager::ApplyElevationVariation(const std::string& planName, const std::string& elevationType) {
-    auto it = m_planConfigurations.find(planName);
+    auto it = m_planConfigurations.find(InternedName::Find(planName));
     if (it == m_planConfigurations.end()) return false;
     
     // Validate elevation type
-    if (m_elevationTypes.find(elevationType) == m_elevationTypes.end()) {
+    if (m_elevationTypes.find(InternedName::Find(elevationType)) == m_elevationTypes.end()) {
         NotifyChange("Invalid elevation type: " + elevationType);
         return false;
     }
@@ -550,6 +551,10 @@ std::vector<AttachmentManager::PlanConfiguration> AttachmentManager::GetPlanConf
         configs.push_back(pair.second);
     }
     
+    // Hash order is arbitrary - callers get plans by name, as before
+    std::sort(configs.begin(), configs.end(), [](const PlanConfiguration& a, const PlanConfiguration& b) {
+        return InternedName::TextLess(a.name, b.name);
+    });
     return configs;
 }
 
@@ -561,16 +566,17 @@ std::vector<std::string> AttachmentManager::GetElevationTypes() const {
         types.push_back(pair.first);
     }
     
+    std::sort(types.begin(), types.end());
     return types;
 }
 
 void AttachmentManager::SetBoundaryFilter(const std::string& boundaryName, 
                                          const std::vector<int>& colorIndices) {
-    m_boundaryFilters[boundaryName] = colorIndices;
+    m_boundaryFilters[InternedName(boundaryName)] = colorIndices;
 }
 
 std::vector<int> AttachmentManager::GetBoundaryFilter(const std::string& boundaryName) const {
-    auto it = m_boundaryFilters.find(boundaryName);
+    auto it = m_boundaryFilters.find(InternedName::Find(boundaryName));
     return (it != m_boundaryFilters.end()) ? it->second : std::vector<int>();
 }
 
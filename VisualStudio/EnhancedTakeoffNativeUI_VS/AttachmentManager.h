@@ -4,9 +4,12 @@
 #include <string>
 #include <vector>
 #include <map>
+#include <unordered_map>
 #include <memory>
 #include <functional>
 
+#include "NameTable.h"
+
 #ifdef HAS_BRX_SDK
 #include "acdb.h"
 #include "dbents.h"
@@ -30,9 +33,9 @@ class AttachmentManager {
 public:
     // Plan configuration structure
     struct PlanConfiguration {
-        std::string name;
+        InternedName name;
         std::string path;
-        std::string elevationType;      // AGS system code
+        InternedName elevationType;     // AGS system code
         bool isLoaded;
         double scale;
         double rotation;
@@ -56,7 +59,7 @@ public:
     
     // Layer definition structure
     struct LayerDefinition {
-        std::string name;
+        InternedName name;
         int colorIndex;
         std::string description;
         
@@ -66,7 +69,7 @@ public:
     
     // Material definition for boundary layers
     struct MaterialDefinition {
-        std::string name;
+        InternedName name;
         int boundaryColor;
         int fillColor; 
         int backgroundColor;
@@ -94,10 +97,10 @@ public:
     
     // Layer state manager
     struct LayerStateManager {
-        std::string name;
+        InternedName name;
         bool isActive;
-        std::vector<std::string> visibleLayers;
-        std::vector<std::string> hiddenLayers;
+        std::vector<InternedName> visibleLayers;
+        std::vector<InternedName> hiddenLayers;
         
         LayerStateManager() : isActive(false) {}
     };
@@ -157,11 +160,11 @@ public:
     void RegisterChangeCallback(ChangeCallback callback);
     
 private:
-    // Core data
-    std::map<std::string, PlanConfiguration> m_planConfigurations;
-    std::map<std::string, LayerStateManager> m_layerStates;
-    std::map<std::string, std::vector<int>> m_boundaryFilters;
-    std::map<std::string, std::string> m_elevationTypes;
+    // Core data - keyed by interned name; lookups from std::string go through InternedName::Find
+    std::unordered_map<InternedName, PlanConfiguration> m_planConfigurations;
+    std::unordered_map<InternedName, LayerStateManager> m_layerStates;
+    std::unordered_map<InternedName, std::vector<int>> m_boundaryFilters;
+    std::unordered_map<InternedName, std::string> m_elevationTypes;
     std::vector<ChangeCallback> m_callbacks;
     std::string m_templatePath;
     
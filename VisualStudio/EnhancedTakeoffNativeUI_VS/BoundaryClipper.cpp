@@ -0,0 +1,356 @@
+// BoundaryClipper.cpp - Partial LF/SF of entities that straddle a boundary outline
+// Enhanced Construction Takeoff - BricsCAD V25 Plugin
+// COPILOT-HINT: A piece lying on a boundary edge belongs to the side the counter-clockwise
+// outline runs along, so a wall shared by two boundaries is attributed exactly once
+
+#include "pch.h"
+#include "BoundaryClipper.h"
+#include "BoundaryPolygon.h"
+#include "EntitySnapshotStore.h"
+#include "MeasurementKernels.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace EnhancedTakeoff {
+
+namespace {
+    const double kBulgeEpsilon = 1e-12;
+    const double kParamEpsilon = 1e-12;
+
+    enum class PieceSide {
+        Outside,
+        Inside,
+        OnEdgeSameWay,      // Lies on an outline edge running the same direction
+        OnEdgeOtherWay
+    };
+
+    // Outline vertices plus the tolerance used to decide that a piece lies on an edge
+    struct Outline {
+        const double* xs;
+        const double* ys;
+        size_t count;
+        double orientation;     // +1 counter-clockwise, -1 clockwise
+        double tolerance;
+        const BoundaryPolygon* polygon;
+
+        explicit Outline(const BoundaryPolygon& source)
+            : xs(source.GetVertexX()), ys(source.GetVertexY()), count(source.GetVertexCount()),
+              orientation(source.GetSignedArea() >= 0.0 ? 1.0 : -1.0), polygon(&source) {
+            const double extent = std::max(source.GetMaxX() - source.GetMinX(),
+                                           source.GetMaxY() - source.GetMinY());
+            tolerance = 1e-9 * std::max(1.0, extent);
+        }
+    };
+
+    double Cross(double ax, double ay, double bx, double by) {
+        return ax * by - ay * bx;
+    }
+
+    double ArcLength(double x0, double y0, double x1, double y1, double bulge) {
+        const double chord = std::hypot(x1 - x0, y1 - y0);
+        const double sweep = 4.0 * std::atan(std::fabs(bulge));
+        if (chord == 0.0 || sweep < 1e-12) return chord;
+        const double radius = chord / (2.0 * std::sin(0.5 * sweep));
+        return radius * sweep;
+    }
+
+    // Points along a bulged segment after (x0, y0), ending exactly at (x1, y1)
+    void AppendArc(double x0, double y0, double x1, double y1, double bulge,
+                   std::vector<double>& xs, std::vector<double>& ys) {
+        const double dx = x1 - x0;
+        const double dy = y1 - y0;
+        const double chord = std::hypot(dx, dy);
+        if (chord == 0.0) {
+            xs.push_back(x1);
+            ys.push_back(y1);
+            return;
+        }
+
+        // Center sits on the left normal of the chord for a positive (counter-clockwise) bulge
+        const double apothem = chord * (1.0 - bulge * bulge) / (4.0 * bulge);
+        const double cx = 0.5 * (x0 + x1) - dy / chord * apothem;
+        const double cy = 0.5 * (y0 + y1) + dx / chord * apothem;
+        const double radius = std::hypot(x0 - cx, y0 - cy);
+        const double start = std::atan2(y0 - cy, x0 - cx);
+        const double sweep = 4.0 * std::atan(bulge);
+
+        for (int k = 1; k < BoundaryClipper::kArcSegments; ++k) {
+            const double angle = start + sweep * k / BoundaryClipper::kArcSegments;
+            xs.push_back(cx + radius * std::cos(angle));
+            ys.push_back(cy + radius * std::sin(angle));
+        }
+        xs.push_back(x1);
+        ys.push_back(y1);
+    }
+
+    // Split parameters of p0->p1 where it meets outline edges, including 0 and 1
+    void CollectBreaks(const Outline& outline, double x0, double y0, double x1, double y1,
+                       std::vector<double>& breaks) {
+        breaks.clear();
+        breaks.push_back(0.0);
+        breaks.push_back(1.0);
+
+        const double dx = x1 - x0;
+        const double dy = y1 - y0;
+        const double dd = dx * dx + dy * dy;
+        if (dd == 0.0) return;
+
+        for (size_t i = 0, j = outline.count - 1; i < outline.count; j = i++) {
+            const double qx = outline.xs[j], qy = outline.ys[j];
+            const double ex = outline.xs[i] - qx, ey = outline.ys[i] - qy;
+            const double wx = qx - x0, wy = qy - y0;
+            const double denom = Cross(dx, dy, ex, ey);
+
+            if (std::fabs(denom) > kParamEpsilon * std::sqrt(dd * (ex * ex + ey * ey))) {
+                const double t = Cross(wx, wy, ex, ey) / denom;
+                const double s = Cross(wx, wy, dx, dy) / denom;
+                if (s >= -kParamEpsilon && s <= 1.0 + kParamEpsilon &&
+                    t > kParamEpsilon && t < 1.0 - kParamEpsilon) {
+                    breaks.push_back(t);
+                }
+            } else if (std::fabs(Cross(wx, wy, dx, dy)) <= outline.tolerance * std::sqrt(dd)) {
+                // Collinear overlap - break where the edge's endpoints project
+                const double t0 = (wx * dx + wy * dy) / dd;
+                const double t1 = ((outline.xs[i] - x0) * dx + (outline.ys[i] - y0) * dy) / dd;
+                if (t0 > kParamEpsilon && t0 < 1.0 - kParamEpsilon) breaks.push_back(t0);
+                if (t1 > kParamEpsilon && t1 < 1.0 - kParamEpsilon) breaks.push_back(t1);
+            }
+        }
+
+        std::sort(breaks.begin(), breaks.end());
+        breaks.erase(std::unique(breaks.begin(), breaks.end(), [](double a, double b) {
+            return b - a <= kParamEpsilon;
+        }), breaks.end());
+    }
+
+    PieceSide ClassifyPiece(const Outline& outline, double mx, double my, double dx, double dy) {
+        for (size_t i = 0, j = outline.count - 1; i < outline.count; j = i++) {
+            const double qx = outline.xs[j], qy = outline.ys[j];
+            const double ex = outline.xs[i] - qx, ey = outline.ys[i] - qy;
+            const double ee = ex * ex + ey * ey;
+            if (ee == 0.0) continue;
+
+            const double s = std::min(1.0, std::max(0.0, ((mx - qx) * ex + (my - qy) * ey) / ee));
+            const double px = qx + s * ex - mx;
+            const double py = qy + s * ey - my;
+            if (px * px + py * py <= outline.tolerance * outline.tolerance) {
+                return ((dx * ex + dy * ey) * outline.orientation > 0.0) ? PieceSide::OnEdgeSameWay
+                                                                           : PieceSide::OnEdgeOtherWay;
+            }
+        }
+        return outline.polygon->Contains(mx, my) ? PieceSide::Inside : PieceSide::Outside;
+    }
+
+    // Inside length of one straight segment; pieces on an edge count when they run with the outline
+    double InsideSegmentLength(const Outline& outline, double x0, double y0, double x1, double y1,
+                               std::vector<double>& breaks) {
+        CollectBreaks(outline, x0, y0, x1, y1, breaks);
+
+        const double dx = x1 - x0;
+        const double dy = y1 - y0;
+        const double length = std::hypot(dx, dy);
+        double inside = 0.0;
+        for (size_t k = 1; k < breaks.size(); ++k) {
+            const double mid = 0.5 * (breaks[k - 1] + breaks[k]);
+            const PieceSide side = ClassifyPiece(outline, x0 + mid * dx, y0 + mid * dy, dx, dy);
+            if (side == PieceSide::Inside || side == PieceSide::OnEdgeSameWay) {
+                inside += (breaks[k] - breaks[k - 1]) * length;
+            }
+        }
+        return inside;
+    }
+
+    // Green's-theorem contribution of the pieces of 'path' that bound the overlap with 'other'
+    // Returns twice the signed contribution (as if 'path' were counter-clockwise)
+    double OverlapBoundaryTerm(const std::vector<double>& xs, const std::vector<double>& ys,
+                               double pathOrientation, const Outline& other, bool keepSharedEdges,
+                               bool& crossed, bool& allInside, std::vector<double>& breaks) {
+        double twiceArea = 0.0;
+        const size_t count = xs.size();
+        for (size_t i = 0, j = count - 1; i < count; j = i++) {
+            const double x0 = xs[j], y0 = ys[j];
+            const double dx = xs[i] - x0, dy = ys[i] - y0;
+            CollectBreaks(other, x0, y0, xs[i], ys[i], breaks);
+            if (breaks.size() > 2) crossed = true;
+
+            for (size_t k = 1; k < breaks.size(); ++k) {
+                const double t0 = breaks[k - 1], t1 = breaks[k];
+                const double mid = 0.5 * (t0 + t1);
+                const PieceSide side = ClassifyPiece(other, x0 + mid * dx, y0 + mid * dy,
+                                                     dx * pathOrientation, dy * pathOrientation);
+                if (side != PieceSide::Inside) allInside = false;
+                if (side == PieceSide::OnEdgeSameWay || side == PieceSide::OnEdgeOtherWay) crossed = true;
+
+                const bool keep = side == PieceSide::Inside ||
+                                  (keepSharedEdges && side == PieceSide::OnEdgeSameWay);
+                if (keep) {
+                    twiceArea += pathOrientation * Cross(x0 + t0 * dx, y0 + t0 * dy,
+                                                         x0 + t1 * dx, y0 + t1 * dy);
+                }
+            }
+        }
+        return twiceArea;
+    }
+
+    // Clipped share of a tessellated measure, restated against the entity's exact measure
+    double ScaleToKnown(double clipped, double known, double tessellated) {
+        return (tessellated > 0.0) ? std::min(known, clipped * (known / tessellated)) : 0.0;
+    }
+
+    void FlattenOutline(const double* xs, const double* ys, const double* bulges, size_t count,
+                        std::vector<double>& outX, std::vector<double>& outY) {
+        outX.clear();
+        outY.clear();
+        for (size_t i = 0; i < count; ++i) {
+            const size_t next = (i + 1 == count) ? 0 : i + 1;
+            const double bulge = bulges ? bulges[i] : 0.0;
+            if (std::fabs(bulge) < kBulgeEpsilon) {
+                outX.push_back(xs[next]);
+                outY.push_back(ys[next]);
+            } else {
+                AppendArc(xs[i], ys[i], xs[next], ys[next], bulge, outX, outY);
+            }
+        }
+    }
+}
+
+double BoundaryClipper::ClipPolylineLength(const BoundaryPolygon& region,
+                                           const double* xs, const double* ys, const double* bulges,
+                                           size_t count, bool closed) {
+    if (region.IsEmpty() || count < 2) return 0.0;
+
+    const Outline outline(region);
+    std::vector<double> breaks, arcX, arcY;
+    const size_t segmentCount = closed ? count : count - 1;
+    double inside = 0.0;
+
+    for (size_t i = 0; i < segmentCount; ++i) {
+        const size_t next = (i + 1 == count) ? 0 : i + 1;
+        const double bulge = bulges ? bulges[i] : 0.0;
+        if (std::fabs(bulge) < kBulgeEpsilon) {
+            inside += InsideSegmentLength(outline, xs[i], ys[i], xs[next], ys[next], breaks);
+            continue;
+        }
+
+        // Flatten the arc, then scale the inside chord length back to arc length
+        arcX.assign(1, xs[i]);
+        arcY.assign(1, ys[i]);
+        AppendArc(xs[i], ys[i], xs[next], ys[next], bulge, arcX, arcY);
+        double chordTotal = 0.0, chordInside = 0.0;
+        for (size_t k = 1; k < arcX.size(); ++k) {
+            chordTotal += std::hypot(arcX[k] - arcX[k - 1], arcY[k] - arcY[k - 1]);
+            chordInside += InsideSegmentLength(outline, arcX[k - 1], arcY[k - 1], arcX[k], arcY[k], breaks);
+        }
+        if (chordTotal > 0.0) {
+            inside += chordInside * ArcLength(xs[i], ys[i], xs[next], ys[next], bulge) / chordTotal;
+        }
+    }
+    return inside;
+}
+
+double BoundaryClipper::ClipPolygonArea(const BoundaryPolygon& region,
+                                        const double* xs, const double* ys, const double* bulges,
+                                        size_t count) {
+    if (region.IsEmpty() || count < 2) return 0.0;     // Two bulged vertices can close a circle
+
+    std::vector<double> pathX, pathY;
+    FlattenOutline(xs, ys, bulges, count, pathX, pathY);
+
+    BoundaryPolygon subject;
+    if (!subject.SetVertices(pathX.data(), pathY.data(), pathX.size())) return 0.0;
+    if (subject.GetMaxX() < region.GetMinX() || subject.GetMinX() > region.GetMaxX() ||
+        subject.GetMaxY() < region.GetMinY() || subject.GetMinY() > region.GetMaxY()) {
+        return 0.0;
+    }
+
+    const Outline regionOutline(region);
+    const Outline subjectOutline(subject);
+    std::vector<double> breaks;
+    bool crossed = false;
+    bool subjectInside = true;
+    bool regionInside = true;
+
+    // Overlap boundary = subject inside region (+ shared edges once) + region inside subject
+    double twiceArea = OverlapBoundaryTerm(pathX, pathY, subjectOutline.orientation, regionOutline,
+                                           true, crossed, subjectInside, breaks);
+    std::vector<double> regionX(region.GetVertexX(), region.GetVertexX() + region.GetVertexCount());
+    std::vector<double> regionY(region.GetVertexY(), region.GetVertexY() + region.GetVertexCount());
+    twiceArea += OverlapBoundaryTerm(regionX, regionY, regionOutline.orientation, subjectOutline,
+                                     false, crossed, regionInside, breaks);
+
+    // Wholly inside - keep the exact arc-aware area rather than the flattened one
+    if (!crossed && subjectInside) {
+        return std::fabs(MeasurementKernels::PolylineSignedArea(xs, ys, bulges, count));
+    }
+    return std::max(0.0, 0.5 * twiceArea);
+}
+
+EntityDelta::Measure BoundaryClipper::ClipEntity(const EntitySnapshotStore& store, size_t index,
+                                                 const BoundaryPolygon& region) {
+    EntityDelta::Measure measure;
+    if (index >= store.GetEntityCount() || region.IsEmpty()) return measure;
+
+    measure.colorIndex = store.GetColorIndices()[index];
+    if (store.GetMaxX()[index] < region.GetMinX() || store.GetMinX()[index] > region.GetMaxX() ||
+        store.GetMaxY()[index] < region.GetMinY() || store.GetMinY()[index] > region.GetMaxY()) {
+        return measure;
+    }
+
+    const size_t offset = store.GetVertexOffsets()[index];
+    const size_t vertexCount = store.GetVertexCounts()[index];
+    const double* xs = store.GetVertexX() + offset;
+    const double* ys = store.GetVertexY() + offset;
+    const double* bulges = store.GetVertexBulge() + offset;
+
+    // Tessellated curves carry their exact LF/SF - scale the clipped chords back to it, as for arcs
+    const double knownLength = store.GetLengths()[index];
+    const double knownArea = store.GetAreas()[index];
+
+    switch (store.GetKinds()[index]) {
+        case EntitySnapshotStore::EntityKind::Line:
+        case EntitySnapshotStore::EntityKind::Polyline:
+            measure.length = ClipPolylineLength(region, xs, ys, bulges, vertexCount, false);
+            if (knownLength >= 0.0) {
+                measure.length = ScaleToKnown(measure.length, knownLength,
+                    MeasurementKernels::PolylineLength(xs, ys, bulges, vertexCount, false));
+            }
+            break;
+        case EntitySnapshotStore::EntityKind::ClosedPolyline:
+            measure.length = ClipPolylineLength(region, xs, ys, bulges, vertexCount, true);
+            measure.area = ClipPolygonArea(region, xs, ys, bulges, vertexCount);
+            if (knownLength >= 0.0) {
+                measure.length = ScaleToKnown(measure.length, knownLength,
+                    MeasurementKernels::PolylineLength(xs, ys, bulges, vertexCount, true));
+            }
+            if (knownArea >= 0.0) {
+                measure.area = ScaleToKnown(measure.area, knownArea,
+                    std::fabs(MeasurementKernels::PolylineSignedArea(xs, ys, bulges, vertexCount)));
+            }
+            break;
+        case EntitySnapshotStore::EntityKind::Hatch: {
+            // Clip every loop on its own and subtract the islands' inside share
+            double clippedArea = 0.0;
+            double loopArea = 0.0;
+            store.ForEachLoop(index, [&](const double* loopX, const double* loopY, const double* loopBulges,
+                                         size_t loopVertexCount, bool isHole) {
+                const double sign = isHole ? -1.0 : 1.0;
+                clippedArea += sign * ClipPolygonArea(region, loopX, loopY, loopBulges, loopVertexCount);
+                loopArea += sign * std::fabs(MeasurementKernels::PolylineSignedArea(loopX, loopY, loopBulges,
+                                                                                    loopVertexCount));
+            });
+            // A loop wholly inside clips to exactly its own area, so equal sums mean the whole
+            // hatch is inside - report its net area as measured by the drawing
+            measure.area = (knownArea >= 0.0 && clippedArea == loopArea) ? knownArea : std::max(0.0, clippedArea);
+            break;
+        }
+        case EntitySnapshotStore::EntityKind::Block:
+        case EntitySnapshotStore::EntityKind::Point:
+            measure.count = (vertexCount > 0 && region.Contains(xs[0], ys[0])) ? 1.0 : 0.0;
+            break;
+    }
+    return measure;
+}
+
+} // namespace EnhancedTakeoff
@@ -0,0 +1,42 @@
+// BoundaryClipper.h - Partial LF/SF of entities that straddle a boundary outline
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "QuantityEngine.h"
+
+namespace EnhancedTakeoff {
+
+class BoundaryPolygon;
+class EntitySnapshotStore;
+
+/**
+ * Clips snapshot geometry against a boundary polygon (convex or not)
+ * Lengths: each segment is split at its crossings with the outline and the pieces whose
+ * midpoint is inside are summed. Areas: the boundary of (entity AND outline) is the inside
+ * part of each outline plus shared edges running the same way, so Green's theorem over those
+ * pieces gives the overlap area without building the clipped polygon
+ * COPILOT-HINT: Entities that do not cross the outline keep their exact (arc-aware) measure;
+ * only straddling arcs are flattened, kArcSegments chords per arc
+ */
+class BoundaryClipper {
+public:
+    static const int kArcSegments = 32;
+
+    // Inside length of an open or closed polyline (bulges may be null)
+    static double ClipPolylineLength(const BoundaryPolygon& region,
+                                     const double* xs, const double* ys, const double* bulges,
+                                     size_t count, bool closed);
+
+    // Overlap area of a closed outline with the region (always >= 0)
+    static double ClipPolygonArea(const BoundaryPolygon& region,
+                                  const double* xs, const double* ys, const double* bulges,
+                                  size_t count);
+
+    // Inside share of one snapshot entity - blocks and points count when their insertion point is inside
+    static EntityDelta::Measure ClipEntity(const EntitySnapshotStore& store, size_t index,
+                                           const BoundaryPolygon& region);
+};
+
+} // namespace EnhancedTakeoff
@@ -0,0 +1,286 @@
+// BoundaryFaceFinder.cpp - Minimal closed faces of a planar line drawing
+// Enhanced Construction Takeoff - BricsCAD V25 Plugin
+// COPILOT-HINT: Half-edges 2e and 2e+1 are the two directions of edge e; twin(h) = h ^ 1
+
+#include "pch.h"
+#include "BoundaryFaceFinder.h"
+
+#include <algorithm>
+#include <cmath>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace EnhancedTakeoff {
+
+namespace {
+    const double kParamEpsilon = 1e-12;
+
+    double Cross(double ax, double ay, double bx, double by) {
+        return ax * by - ay * bx;
+    }
+
+    std::uint64_t PackPair(std::uint32_t a, std::uint32_t b) {
+        return (static_cast<std::uint64_t>(a) << 32) | b;
+    }
+
+    struct GridKeyHash {
+        size_t operator()(const std::pair<std::int64_t, std::int64_t>& key) const {
+            return std::hash<std::int64_t>()(key.first * 73856093LL ^ key.second * 19349663LL);
+        }
+    };
+}
+
+BoundaryFaceFinder::BoundaryFaceFinder(double snapTolerance)
+    : m_tolerance(snapTolerance > 0.0 ? snapTolerance : 1e-6) {
+}
+
+void BoundaryFaceFinder::AddSegment(double x0, double y0, double x1, double y1) {
+    Segment segment = { x0, y0, x1, y1 };
+    m_segments.push_back(segment);
+}
+
+void BoundaryFaceFinder::AddPolyline(const double* xs, const double* ys, size_t count, bool closed) {
+    for (size_t i = 0; i + 1 < count; ++i) {
+        AddSegment(xs[i], ys[i], xs[i + 1], ys[i + 1]);
+    }
+    if (closed && count > 2) {
+        AddSegment(xs[count - 1], ys[count - 1], xs[0], ys[0]);
+    }
+}
+
+void BoundaryFaceFinder::SplitAtIntersections(std::vector<std::vector<double>>& splits) const {
+    const size_t count = m_segments.size();
+    splits.assign(count, std::vector<double>());
+
+    std::vector<std::uint32_t> order(count);
+    for (size_t i = 0; i < count; ++i) order[i] = static_cast<std::uint32_t>(i);
+    auto minX = [this](std::uint32_t s) { return std::min(m_segments[s].x0, m_segments[s].x1); };
+    auto maxX = [this](std::uint32_t s) { return std::max(m_segments[s].x0, m_segments[s].x1); };
+    std::sort(order.begin(), order.end(), [&](std::uint32_t a, std::uint32_t b) { return minX(a) < minX(b); });
+
+    // Adds the parameter on 'a' of point (px, py) when it is strictly inside 'a'
+    auto addSplit = [this, &splits](std::uint32_t a, double px, double py) {
+        const Segment& s = m_segments[a];
+        const double dx = s.x1 - s.x0, dy = s.y1 - s.y0;
+        const double dd = dx * dx + dy * dy;
+        if (dd == 0.0) return;
+        const double t = ((px - s.x0) * dx + (py - s.y0) * dy) / dd;
+        if (t > kParamEpsilon && t < 1.0 - kParamEpsilon) splits[a].push_back(t);
+    };
+
+    // Sweep: the active list holds segments whose X range still reaches the sweep position
+    std::vector<std::uint32_t> active;
+    for (std::uint32_t current : order) {
+        const Segment& a = m_segments[current];
+        const double sweepX = minX(current) - m_tolerance;
+        const double aMinY = std::min(a.y0, a.y1) - m_tolerance;
+        const double aMaxY = std::max(a.y0, a.y1) + m_tolerance;
+        const double adx = a.x1 - a.x0, ady = a.y1 - a.y0;
+        const double aLength = std::sqrt(adx * adx + ady * ady);
+
+        size_t keep = 0;
+        for (size_t k = 0; k < active.size(); ++k) {
+            const std::uint32_t other = active[k];
+            if (maxX(other) < sweepX) continue;     // Expired - drop from the active list
+            active[keep++] = other;
+
+            const Segment& b = m_segments[other];
+            if (std::max(b.y0, b.y1) < aMinY || std::min(b.y0, b.y1) > aMaxY) continue;
+
+            const double bdx = b.x1 - b.x0, bdy = b.y1 - b.y0;
+            const double bLength = std::sqrt(bdx * bdx + bdy * bdy);
+            const double denom = Cross(adx, ady, bdx, bdy);
+            const double wx = b.x0 - a.x0, wy = b.y0 - a.y0;
+
+            if (std::fabs(denom) > kParamEpsilon * aLength * bLength) {
+                const double t = Cross(wx, wy, bdx, bdy) / denom;
+                const double u = Cross(wx, wy, adx, ady) / denom;
+                const double tTol = aLength > 0.0 ? m_tolerance / aLength : 0.0;
+                const double uTol = bLength > 0.0 ? m_tolerance / bLength : 0.0;
+                if (t >= -tTol && t <= 1.0 + tTol && u >= -uTol && u <= 1.0 + uTol) {
+                    const double px = a.x0 + t * adx, py = a.y0 + t * ady;
+                    addSplit(current, px, py);
+                    addSplit(other, px, py);
+                }
+            } else if (aLength > 0.0 && std::fabs(Cross(wx, wy, adx, ady)) <= m_tolerance * aLength) {
+                // Collinear overlap - each segment splits at the other's endpoints
+                addSplit(current, b.x0, b.y0);
+                addSplit(current, b.x1, b.y1);
+                addSplit(other, a.x0, a.y0);
+                addSplit(other, a.x1, a.y1);
+            }
+        }
+        active.resize(keep);
+        active.push_back(current);
+    }
+}
+
+size_t BoundaryFaceFinder::FindFaces(std::vector<Face>& faces, double minArea) const {
+    faces.clear();
+    if (m_segments.empty()) return 0;
+
+    std::vector<std::vector<double>> splits;
+    SplitAtIntersections(splits);
+
+    // Snap split points to vertices
+    std::vector<double> vertexX, vertexY;
+    std::unordered_map<std::pair<std::int64_t, std::int64_t>, std::uint32_t, GridKeyHash> vertexOf;
+    vertexOf.reserve(m_segments.size() * 2);
+    auto vertexAt = [&](double x, double y) {
+        const std::pair<std::int64_t, std::int64_t> key(
+            static_cast<std::int64_t>(std::llround(x / m_tolerance)),
+            static_cast<std::int64_t>(std::llround(y / m_tolerance)));
+        auto it = vertexOf.find(key);
+        if (it != vertexOf.end()) return it->second;
+        const std::uint32_t id = static_cast<std::uint32_t>(vertexX.size());
+        vertexOf.emplace(key, id);
+        vertexX.push_back(x);
+        vertexY.push_back(y);
+        return id;
+    };
+
+    // Unique undirected edges between consecutive split points
+    std::vector<std::uint32_t> edgeFrom, edgeTo;
+    std::unordered_set<std::uint64_t> seenEdges;
+    seenEdges.reserve(m_segments.size() * 2);
+    for (size_t s = 0; s < m_segments.size(); ++s) {
+        const Segment& segment = m_segments[s];
+        std::vector<double>& params = splits[s];
+        params.push_back(0.0);
+        params.push_back(1.0);
+        std::sort(params.begin(), params.end());
+
+        std::uint32_t previous = vertexAt(segment.x0, segment.y0);
+        for (size_t k = 1; k < params.size(); ++k) {
+            const double t = params[k];
+            const std::uint32_t next = (k + 1 == params.size())
+                ? vertexAt(segment.x1, segment.y1)
+                : vertexAt(segment.x0 + t * (segment.x1 - segment.x0), segment.y0 + t * (segment.y1 - segment.y0));
+            if (next != previous &&
+                seenEdges.insert(PackPair(std::min(previous, next), std::max(previous, next))).second) {
+                edgeFrom.push_back(previous);
+                edgeTo.push_back(next);
+            }
+            previous = next;
+        }
+    }
+
+    // Prune dangling edges - they can never bound a face
+    const size_t vertexCount = vertexX.size();
+    const size_t edgeCount = edgeFrom.size();
+    std::vector<std::uint32_t> degree(vertexCount, 0);
+    for (size_t e = 0; e < edgeCount; ++e) {
+        degree[edgeFrom[e]]++;
+        degree[edgeTo[e]]++;
+    }
+
+    std::vector<std::uint32_t> firstOut(vertexCount + 1, 0);
+    for (size_t e = 0; e < edgeCount; ++e) {
+        firstOut[edgeFrom[e] + 1]++;
+        firstOut[edgeTo[e] + 1]++;
+    }
+    for (size_t v = 0; v < vertexCount; ++v) firstOut[v + 1] += firstOut[v];
+
+    // Outgoing half-edges per vertex (CSR): half-edge 2e runs from->to, 2e+1 runs to->from
+    std::vector<std::uint32_t> outgoing(edgeCount * 2);
+    {
+        std::vector<std::uint32_t> fill(firstOut.begin(), firstOut.end() - 1);
+        for (size_t e = 0; e < edgeCount; ++e) {
+            outgoing[fill[edgeFrom[e]]++] = static_cast<std::uint32_t>(2 * e);
+            outgoing[fill[edgeTo[e]]++] = static_cast<std::uint32_t>(2 * e + 1);
+        }
+    }
+    auto origin = [&](std::uint32_t h) { return (h & 1) ? edgeTo[h >> 1] : edgeFrom[h >> 1]; };
+    auto target = [&](std::uint32_t h) { return (h & 1) ? edgeFrom[h >> 1] : edgeTo[h >> 1]; };
+
+    std::vector<std::uint8_t> removed(edgeCount, 0);
+    std::vector<std::uint32_t> leaves;
+    for (std::uint32_t v = 0; v < vertexCount; ++v) {
+        if (degree[v] == 1) leaves.push_back(v);
+    }
+    while (!leaves.empty()) {
+        const std::uint32_t v = leaves.back();
+        leaves.pop_back();
+        if (degree[v] != 1) continue;
+        for (std::uint32_t k = firstOut[v]; k < firstOut[v + 1]; ++k) {
+            const std::uint32_t e = outgoing[k] >> 1;
+            if (removed[e]) continue;
+            removed[e] = 1;
+            degree[v]--;
+            const std::uint32_t other = target(outgoing[k]);
+            if (--degree[other] == 1) leaves.push_back(other);
+            break;
+        }
+    }
+
+    // Sort each vertex's live half-edges counter-clockwise and record each one's slot
+    std::vector<double> angle(edgeCount * 2);
+    for (size_t h = 0; h < edgeCount * 2; ++h) {
+        const std::uint32_t from = origin(static_cast<std::uint32_t>(h));
+        const std::uint32_t to = target(static_cast<std::uint32_t>(h));
+        angle[h] = std::atan2(vertexY[to] - vertexY[from], vertexX[to] - vertexX[from]);
+    }
+    std::vector<std::uint32_t> slotOf(edgeCount * 2, 0);
+    std::vector<std::uint32_t> liveCount(vertexCount, 0);
+    for (std::uint32_t v = 0; v < vertexCount; ++v) {
+        std::uint32_t* first = outgoing.data() + firstOut[v];
+        std::uint32_t* last = outgoing.data() + firstOut[v + 1];
+        last = std::partition(first, last, [&](std::uint32_t h) { return !removed[h >> 1]; });
+        std::sort(first, last, [&](std::uint32_t a, std::uint32_t b) { return angle[a] < angle[b]; });
+        liveCount[v] = static_cast<std::uint32_t>(last - first);
+        for (std::uint32_t k = 0; k < liveCount[v]; ++k) slotOf[first[k]] = k;
+    }
+
+    // Trace faces: after arriving at v over h, leave on the half-edge just clockwise of twin(h)
+    std::vector<std::uint8_t> visited(edgeCount * 2, 0);
+    std::vector<std::uint32_t> loop;
+    for (std::uint32_t start = 0; start < edgeCount * 2; ++start) {
+        if (visited[start] || removed[start >> 1]) continue;
+
+        loop.clear();
+        double twiceArea = 0.0;
+        std::uint32_t h = start;
+        while (!visited[h]) {
+            visited[h] = 1;
+            const std::uint32_t from = origin(h);
+            const std::uint32_t v = target(h);
+            loop.push_back(from);
+            twiceArea += Cross(vertexX[from], vertexY[from], vertexX[v], vertexY[v]);
+
+            const std::uint32_t twin = h ^ 1u;
+            const std::uint32_t slot = slotOf[twin];
+            const std::uint32_t live = liveCount[v];
+            h = outgoing[firstOut[v] + (slot + live - 1) % live];
+        }
+
+        const double area = 0.5 * twiceArea;
+        if (area <= minArea || area <= 0.0) continue;   // Outer boundary of a component runs clockwise
+
+        // Drop vertices where the outline runs straight on (T-junction and overlap splits)
+        Face face;
+        face.area = area;
+        const size_t n = loop.size();
+        for (size_t k = 0; k < n; ++k) {
+            const std::uint32_t prev = loop[(k + n - 1) % n];
+            const std::uint32_t curr = loop[k];
+            const std::uint32_t next = loop[(k + 1) % n];
+            const double turn = Cross(vertexX[curr] - vertexX[prev], vertexY[curr] - vertexY[prev],
+                                      vertexX[next] - vertexX[curr], vertexY[next] - vertexY[curr]);
+            const double scale = std::hypot(vertexX[curr] - vertexX[prev], vertexY[curr] - vertexY[prev]) *
+                                 std::hypot(vertexX[next] - vertexX[curr], vertexY[next] - vertexY[curr]);
+            const double along = (vertexX[curr] - vertexX[prev]) * (vertexX[next] - vertexX[curr]) +
+                                 (vertexY[curr] - vertexY[prev]) * (vertexY[next] - vertexY[curr]);
+            if (std::fabs(turn) <= 1e-12 * scale && along > 0.0) continue;
+            face.xs.push_back(vertexX[curr]);
+            face.ys.push_back(vertexY[curr]);
+        }
+        if (face.xs.size() >= 3) {
+            faces.push_back(face);
+        }
+    }
+
+    std::sort(faces.begin(), faces.end(), [](const Face& a, const Face& b) { return a.area > b.area; });
+    return faces.size();
+}
+
+} // namespace EnhancedTakeoff
@@ -0,0 +1,49 @@
+// BoundaryFaceFinder.h - Minimal closed faces of a planar line drawing
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace EnhancedTakeoff {
+
+/**
+ * Turns loose boundary linework into closed outlines
+ * 1. Sweep along X to split segments at crossings, T-junctions and collinear overlaps
+ * 2. Snap endpoints to a tolerance grid and merge duplicate edges
+ * 3. Prune dangling edges, sort each vertex's half-edges by angle
+ * 4. Walk next = clockwise-previous half-edge; every counter-clockwise loop is a minimal face
+ * COPILOT-HINT: Pure geometry - fed from BOUNDARY_* layers in BricsCAD or from synthetic segments headless
+ */
+class BoundaryFaceFinder {
+public:
+    struct Segment {
+        double x0, y0, x1, y1;
+    };
+
+    struct Face {
+        std::vector<double> xs;     // Counter-clockwise, collinear vertices removed
+        std::vector<double> ys;
+        double area;
+
+        Face() : area(0.0) {}
+    };
+
+    explicit BoundaryFaceFinder(double snapTolerance = 1e-6);
+
+    void Clear() { m_segments.clear(); }
+    void AddSegment(double x0, double y0, double x1, double y1);
+    void AddPolyline(const double* xs, const double* ys, size_t count, bool closed);
+    size_t GetSegmentCount() const { return m_segments.size(); }
+
+    // Bounded faces with area above minArea, largest first
+    size_t FindFaces(std::vector<Face>& faces, double minArea = 0.0) const;
+
+private:
+    double m_tolerance;
+    std::vector<Segment> m_segments;
+
+    void SplitAtIntersections(std::vector<std::vector<double>>& splits) const;
+};
+
+} // namespace EnhancedTakeoff
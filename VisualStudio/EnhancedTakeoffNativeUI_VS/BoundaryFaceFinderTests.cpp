@@ -0,0 +1,127 @@
+// BoundaryFaceFinderTests.cpp - Behavior tests for boundary face detection
+// Enhanced Construction Takeoff - BricsCAD V25 Plugin
+// COPILOT-HINT: Synthetic segments stand in for BOUNDARY_* layer linework
+
+#include "pch.h"
+#include "TakeoffTests.h"
+#include "BoundaryFaceFinder.h"
+
+#include <cmath>
+
+#ifdef BUILDING_TESTS
+
+namespace EnhancedTakeoff {
+
+namespace {
+    typedef BoundaryFaceFinder::Face Face;
+
+    bool Near(double a, double b) {
+        return std::fabs(a - b) < 1e-9;
+    }
+
+    double SignedArea(const Face& face) {
+        double twice = 0.0;
+        const size_t count = face.xs.size();
+        for (size_t i = 0; i < count; ++i) {
+            const size_t next = (i + 1) % count;
+            twice += face.xs[i] * face.ys[next] - face.xs[next] * face.ys[i];
+        }
+        return twice * 0.5;
+    }
+
+    void AddRectangle(BoundaryFaceFinder& finder, double x0, double y0, double x1, double y1, bool clockwise) {
+        const double xs[] = { x0, x1, x1, x0 };
+        const double ys[] = { y0, y0, y1, y1 };
+        const double rxs[] = { x0, x0, x1, x1 };
+        const double rys[] = { y0, y1, y1, y0 };
+        finder.AddPolyline(clockwise ? rxs : xs, clockwise ? rys : ys, 4, true);
+    }
+
+    void TestClosedPolylineIsOneFace(TakeoffTests::Result& result) {
+        BoundaryFaceFinder finder;
+        AddRectangle(finder, 0.0, 0.0, 10.0, 8.0, true);
+
+        std::vector<Face> faces;
+        if (!TakeoffTests::Expect(result, finder.FindFaces(faces) == 1, "one bounded face")) return;
+        TakeoffTests::Expect(result, Near(faces[0].area, 80.0), "face area matches the outline");
+        TakeoffTests::Expect(result, faces[0].xs.size() == 4, "four corners");
+        TakeoffTests::Expect(result, SignedArea(faces[0]) > 0.0, "clockwise input comes out counter-clockwise");
+    }
+
+    void TestGridLinesSplitIntoCells(TakeoffTests::Result& result) {
+        // 2 x 2 grid drawn as loose lines that overhang the outer frame
+        BoundaryFaceFinder finder;
+        for (int i = 0; i < 3; ++i) {
+            const double at = i * 10.0;
+            finder.AddSegment(-2.0, at, 22.0, at);
+            finder.AddSegment(at, -2.0, at, 22.0);
+        }
+
+        std::vector<Face> faces;
+        if (!TakeoffTests::Expect(result, finder.FindFaces(faces) == 4, "one face per grid cell")) return;
+        for (const Face& face : faces) {
+            TakeoffTests::Expect(result, Near(face.area, 100.0), "each cell is 10 x 10");
+            TakeoffTests::Expect(result, face.xs.size() == 4, "crossing points on a straight side are dropped");
+        }
+    }
+
+    void TestTJunctionSplitsFace(TakeoffTests::Result& result) {
+        BoundaryFaceFinder finder;
+        AddRectangle(finder, 0.0, 0.0, 10.0, 10.0, false);
+        finder.AddSegment(4.0, 0.0, 4.0, 10.0);   // Ends on the frame without a vertex there
+
+        std::vector<Face> faces;
+        if (!TakeoffTests::Expect(result, finder.FindFaces(faces) == 2, "the divider makes two faces")) return;
+        TakeoffTests::Expect(result, Near(faces[0].area, 60.0) && Near(faces[1].area, 40.0),
+                             "faces are returned largest first");
+    }
+
+    void TestOverlappingEdgesMerge(TakeoffTests::Result& result) {
+        // Adjacent rooms drawn separately share the wall at x = 10, and one is traced twice
+        BoundaryFaceFinder finder;
+        AddRectangle(finder, 0.0, 0.0, 10.0, 10.0, false);
+        AddRectangle(finder, 0.0, 0.0, 10.0, 10.0, true);
+        AddRectangle(finder, 10.0, 2.0, 16.0, 8.0, false);
+
+        std::vector<Face> faces;
+        if (!TakeoffTests::Expect(result, finder.FindFaces(faces) == 2, "duplicate and shared edges merge")) return;
+        TakeoffTests::Expect(result, Near(faces[0].area, 100.0) && Near(faces[1].area, 36.0), "room areas");
+    }
+
+    void TestOpenLineworkHasNoFaces(TakeoffTests::Result& result) {
+        BoundaryFaceFinder finder;
+        const double xs[] = { 0.0, 10.0, 10.0, 0.0 };
+        const double ys[] = { 0.0, 0.0, 10.0, 10.0 };
+        finder.AddPolyline(xs, ys, 4, false);
+        finder.AddSegment(20.0, 0.0, 30.0, 5.0);
+
+        std::vector<Face> faces;
+        TakeoffTests::Expect(result, finder.FindFaces(faces) == 0 && faces.empty(), "dangling edges are pruned");
+    }
+
+    void TestMinAreaFiltersSmallFaces(TakeoffTests::Result& result) {
+        BoundaryFaceFinder finder;
+        AddRectangle(finder, 0.0, 0.0, 10.0, 10.0, false);
+        AddRectangle(finder, 20.0, 0.0, 21.0, 1.0, false);
+
+        std::vector<Face> faces;
+        TakeoffTests::Expect(result, finder.FindFaces(faces) == 2, "both faces without a threshold");
+        TakeoffTests::Expect(result, finder.FindFaces(faces, 5.0) == 1 && Near(faces[0].area, 100.0),
+                             "faces at or below minArea are dropped");
+    }
+}
+
+std::vector<TakeoffTests::Result> TakeoffTests::RunBoundaryFaceFinderTests() {
+    return Run({
+        { "BoundaryFaceFinder.ClosedPolylineIsOneFace", TestClosedPolylineIsOneFace },
+        { "BoundaryFaceFinder.GridLinesSplitIntoCells", TestGridLinesSplitIntoCells },
+        { "BoundaryFaceFinder.TJunctionSplitsFace", TestTJunctionSplitsFace },
+        { "BoundaryFaceFinder.OverlappingEdgesMerge", TestOverlappingEdgesMerge },
+        { "BoundaryFaceFinder.OpenLineworkHasNoFaces", TestOpenLineworkHasNoFaces },
+        { "BoundaryFaceFinder.MinAreaFiltersSmallFaces", TestMinAreaFiltersSmallFaces },
+    });
+}
+
+} // namespace EnhancedTakeoff
+
+#endif
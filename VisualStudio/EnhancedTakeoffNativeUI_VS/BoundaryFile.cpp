@@ -0,0 +1,246 @@
+// BoundaryFile.cpp - Versioned binary boundary file with memory-mapped, zero-copy reading
+// Enhanced Construction Takeoff - BricsCAD V25 Plugin
+// COPILOT-HINT: The writer assembles the whole image in memory and writes it in one call; the
+// view never copies - callers turn records into BoundaryBox values themselves
+
+#include "pch.h"
+#include "BoundaryFile.h"
+
+#include <cstdio>
+#include <cstring>
+
+namespace EnhancedTakeoff {
+
+namespace {
+
+const char kMagic[8] = { 'E', 'T', 'B', 'N', 'D', 'R', 'Y', '\0' };
+
+static_assert(sizeof(BoundaryFile::Header) == 56, "BoundaryFile::Header layout changed");
+static_assert(sizeof(BoundaryFile::BoundaryRecord) == 136, "BoundaryFile::BoundaryRecord layout changed");
+static_assert(sizeof(BoundaryFile::VersionColorRecord) == 40, "BoundaryFile::VersionColorRecord layout changed");
+
+std::uint64_t AlignTo8(std::uint64_t size) {
+    return (size + 7) & ~static_cast<std::uint64_t>(7);
+}
+
+} // namespace
+
+// FNV-1a over 64-bit words with a length-seeded tail, so truncation and bit flips both change it
+std::uint64_t BoundaryFile::Checksum(const void* data, size_t size) {
+    const std::uint64_t kPrime = 0x100000001b3ull;
+    std::uint64_t hash = 0xcbf29ce484222325ull ^ static_cast<std::uint64_t>(size);
+
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    const size_t wordCount = size / 8;
+    for (size_t i = 0; i < wordCount; ++i) {
+        std::uint64_t word;
+        std::memcpy(&word, bytes + i * 8, 8);
+        hash = (hash ^ word) * kPrime;
+        hash ^= hash >> 29;
+    }
+    for (size_t i = wordCount * 8; i < size; ++i) {
+        hash = (hash ^ bytes[i]) * kPrime;
+    }
+    return hash;
+}
+
+// ============================================================================
+// BoundaryFileWriter
+// ============================================================================
+
+std::uint32_t BoundaryFileWriter::AddString(const std::string& text, std::uint32_t& length) {
+    const std::uint32_t offset = static_cast<std::uint32_t>(m_strings.size());
+    length = static_cast<std::uint32_t>(text.size());
+    m_strings.append(text);
+    m_strings.push_back('\0');  // Lets views hand out C strings
+    return offset;
+}
+
+void BoundaryFileWriter::Add(const BoundaryVersionManager::BoundaryBox& boundary) {
+    BoundaryFile::BoundaryRecord record;
+    std::memset(&record, 0, sizeof(record));
+
+    record.nameOffset = AddString(boundary.name, record.nameLength);
+    record.planOffset = AddString(boundary.attachmentPlan, record.planLength);
+    record.versionOffset = AddString(boundary.activeVersion, record.versionLength);
+
+    record.firstVersionColor = static_cast<std::uint32_t>(m_versionColors.size());
+    record.versionColorCount = static_cast<std::uint32_t>(boundary.versionColors.size());
+    for (const auto& entry : boundary.versionColors) {
+        BoundaryFile::VersionColorRecord colors;
+        std::memset(&colors, 0, sizeof(colors));
+        for (int w = 0; w < ColorMask::kWordCount; ++w) colors.colors[w] = entry.second.GetWord(w);
+        colors.component = static_cast<std::uint8_t>(entry.first);
+        m_versionColors.push_back(colors);
+    }
+
+    const size_t vertexCount = boundary.outline.GetVertexCount();
+    record.firstVertex = m_vertexX.size();
+    record.vertexCount = vertexCount;
+    m_vertexX.insert(m_vertexX.end(), boundary.outline.GetVertexX(), boundary.outline.GetVertexX() + vertexCount);
+    m_vertexY.insert(m_vertexY.end(), boundary.outline.GetVertexY(), boundary.outline.GetVertexY() + vertexCount);
+
+    for (int w = 0; w < ColorMask::kWordCount; ++w) record.baseColors[w] = boundary.baseColors.GetWord(w);
+    record.minX = boundary.minX;
+    record.minY = boundary.minY;
+    record.minZ = boundary.minZ;
+    record.maxX = boundary.maxX;
+    record.maxY = boundary.maxY;
+    record.maxZ = boundary.maxZ;
+    record.flags = (boundary.isActive ? BoundaryFile::kActive : 0u) |
+                   (boundary.hasExtents ? BoundaryFile::kHasExtents : 0u);
+    record.priority = boundary.priority;
+
+    m_records.push_back(record);
+}
+
+bool BoundaryFileWriter::WriteTo(const std::string& filePath) const {
+    const std::uint64_t recordBytes = m_records.size() * sizeof(BoundaryFile::BoundaryRecord);
+    const std::uint64_t colorBytes = m_versionColors.size() * sizeof(BoundaryFile::VersionColorRecord);
+    const std::uint64_t vertexBytes = m_vertexX.size() * sizeof(double);
+    const std::uint64_t stringBytes = AlignTo8(m_strings.size());
+    const std::uint64_t payloadBytes = recordBytes + colorBytes + 2 * vertexBytes + stringBytes;
+
+    std::vector<unsigned char> image(static_cast<size_t>(sizeof(BoundaryFile::Header) + payloadBytes), 0);
+    unsigned char* cursor = image.data() + sizeof(BoundaryFile::Header);
+    if (recordBytes) std::memcpy(cursor, m_records.data(), static_cast<size_t>(recordBytes));
+    cursor += recordBytes;
+    if (colorBytes) std::memcpy(cursor, m_versionColors.data(), static_cast<size_t>(colorBytes));
+    cursor += colorBytes;
+    if (vertexBytes) {
+        std::memcpy(cursor, m_vertexX.data(), static_cast<size_t>(vertexBytes));
+        std::memcpy(cursor + vertexBytes, m_vertexY.data(), static_cast<size_t>(vertexBytes));
+    }
+    cursor += 2 * vertexBytes;
+    if (!m_strings.empty()) std::memcpy(cursor, m_strings.data(), m_strings.size());
+
+    BoundaryFile::Header header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.formatVersion = BoundaryFile::kFormatVersion;
+    header.boundaryCount = static_cast<std::uint32_t>(m_records.size());
+    header.versionColorCount = static_cast<std::uint32_t>(m_versionColors.size());
+    header.vertexCount = m_vertexX.size();
+    header.stringBytes = stringBytes;
+    header.payloadBytes = payloadBytes;
+    header.checksum = BoundaryFile::Checksum(image.data() + sizeof(header), static_cast<size_t>(payloadBytes));
+    std::memcpy(image.data(), &header, sizeof(header));
+
+    FILE* file = std::fopen(filePath.c_str(), "wb");
+    if (!file) {
+        return false;
+    }
+    const bool written = std::fwrite(image.data(), 1, image.size(), file) == image.size();
+    return (std::fclose(file) == 0) && written;
+}
+
+// ============================================================================
+// BoundaryFileView
+// ============================================================================
+
+BoundaryFileView::BoundaryFileView()
+    : m_header(nullptr)
+    , m_records(nullptr)
+    , m_versionColors(nullptr)
+    , m_vertexX(nullptr)
+    , m_vertexY(nullptr)
+    , m_strings(nullptr) {
+}
+
+BoundaryFileView::~BoundaryFileView() {
+    Close();
+}
+
+bool BoundaryFileView::Open(const std::string& filePath) {
+    Close();
+
+    if (!m_file.Open(filePath) || m_file.GetSize() < sizeof(BoundaryFile::Header) || !Validate()) {
+        Close();
+        return false;
+    }
+    return true;
+}
+
+void BoundaryFileView::Close() {
+    m_file.Close();
+    m_header = nullptr;
+    m_records = nullptr;
+    m_versionColors = nullptr;
+    m_vertexX = nullptr;
+    m_vertexY = nullptr;
+    m_strings = nullptr;
+}
+
+bool BoundaryFileView::Validate() {
+    const unsigned char* base = static_cast<const unsigned char*>(m_file.GetData());
+    const BoundaryFile::Header* header = reinterpret_cast<const BoundaryFile::Header*>(base);
+
+    if (std::memcmp(header->magic, kMagic, sizeof(kMagic)) != 0 ||
+        header->formatVersion != BoundaryFile::kFormatVersion) {
+        return false;
+    }
+
+    // Section sizes must add up to exactly what is on disk - catches truncation before any record is touched.
+    // Each section is checked against the bytes still left before the next one, so no sum can wrap
+    const std::uint64_t available = m_file.GetSize() - sizeof(BoundaryFile::Header);
+    std::uint64_t remaining = available;
+    auto takeSection = [&remaining](std::uint64_t count, std::uint64_t elementSize, std::uint64_t& bytes) {
+        if (count > remaining / elementSize) {
+            return false;
+        }
+        bytes = count * elementSize;
+        remaining -= bytes;
+        return true;
+    };
+    std::uint64_t recordBytes = 0;
+    std::uint64_t colorBytes = 0;
+    std::uint64_t vertexBytes = 0;
+    if (header->payloadBytes != available ||
+        !takeSection(header->boundaryCount, sizeof(BoundaryFile::BoundaryRecord), recordBytes) ||
+        !takeSection(header->versionColorCount, sizeof(BoundaryFile::VersionColorRecord), colorBytes) ||
+        !takeSection(header->vertexCount, 2 * sizeof(double), vertexBytes) ||
+        header->stringBytes != remaining) {
+        return false;
+    }
+    if (BoundaryFile::Checksum(base + sizeof(BoundaryFile::Header), static_cast<size_t>(available)) != header->checksum) {
+        return false;
+    }
+
+    const unsigned char* cursor = base + sizeof(BoundaryFile::Header);
+    const BoundaryFile::BoundaryRecord* records = reinterpret_cast<const BoundaryFile::BoundaryRecord*>(cursor);
+    cursor += recordBytes;
+    const BoundaryFile::VersionColorRecord* versionColors = reinterpret_cast<const BoundaryFile::VersionColorRecord*>(cursor);
+    cursor += colorBytes;
+    const double* vertexX = reinterpret_cast<const double*>(cursor);
+    cursor += header->vertexCount * sizeof(double);
+    const double* vertexY = reinterpret_cast<const double*>(cursor);
+    cursor += header->vertexCount * sizeof(double);
+    const char* strings = reinterpret_cast<const char*>(cursor);
+
+    // A matching checksum still does not prove the records were written by us - bound every reference
+    for (std::uint32_t i = 0; i < header->boundaryCount; ++i) {
+        const BoundaryFile::BoundaryRecord& record = records[i];
+        const std::uint32_t offsets[3] = { record.nameOffset, record.planOffset, record.versionOffset };
+        const std::uint32_t lengths[3] = { record.nameLength, record.planLength, record.versionLength };
+        for (int s = 0; s < 3; ++s) {
+            if (static_cast<std::uint64_t>(offsets[s]) + lengths[s] >= header->stringBytes ||
+                strings[offsets[s] + lengths[s]] != '\0') {
+                return false;
+            }
+        }
+        if (static_cast<std::uint64_t>(record.firstVersionColor) + record.versionColorCount > header->versionColorCount ||
+            record.firstVertex > header->vertexCount || record.vertexCount > header->vertexCount - record.firstVertex) {
+            return false;
+        }
+    }
+
+    m_header = header;
+    m_records = records;
+    m_versionColors = versionColors;
+    m_vertexX = vertexX;
+    m_vertexY = vertexY;
+    m_strings = strings;
+    return true;
+}
+
+} // namespace EnhancedTakeoff
@@ -0,0 +1,118 @@
+// BoundaryFile.h - Versioned binary boundary file with memory-mapped, zero-copy reading
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "BoundaryVersionManager.h"
+#include "MappedFile.h"
+
+namespace EnhancedTakeoff {
+
+/**
+ * On-disk layout (little-endian, every section 8-byte aligned):
+ *   Header | BoundaryRecord[] | VersionColorRecord[] | vertex X[] | vertex Y[] | string bytes
+ * Records are fixed size and refer to the variable-length blocks by index/offset, so a
+ * mapped file can be read in place. The header checksum covers everything after the header
+ * COPILOT-HINT: Bump kFormatVersion whenever a record layout changes - old files are rejected, not misread
+ */
+class BoundaryFile {
+public:
+    static const std::uint32_t kFormatVersion = 1;
+
+    struct Header {
+        char magic[8];                  // "ETBNDRY\0"
+        std::uint32_t formatVersion;
+        std::uint32_t boundaryCount;
+        std::uint32_t versionColorCount;
+        std::uint32_t reserved;
+        std::uint64_t vertexCount;
+        std::uint64_t stringBytes;
+        std::uint64_t payloadBytes;     // Everything after the header
+        std::uint64_t checksum;         // Of the payload
+    };
+
+    struct BoundaryRecord {
+        std::uint32_t nameOffset, nameLength;       // Into the string block
+        std::uint32_t planOffset, planLength;
+        std::uint32_t versionOffset, versionLength; // Active elevation code
+        std::uint32_t firstVersionColor, versionColorCount;
+        std::uint64_t firstVertex, vertexCount;
+        std::uint64_t baseColors[ColorMask::kWordCount];
+        double minX, minY, minZ, maxX, maxY, maxZ;
+        std::uint32_t flags;
+        std::int32_t priority;                      // Zero in files written before priorities existed
+    };
+
+    struct VersionColorRecord {
+        std::uint64_t colors[ColorMask::kWordCount];
+        std::uint8_t component;                     // 'A', 'G', 'S', ...
+        std::uint8_t reserved[7];
+    };
+
+    enum RecordFlags : std::uint32_t {
+        kActive = 1u << 0,
+        kHasExtents = 1u << 1
+    };
+
+    static std::uint64_t Checksum(const void* data, size_t size);
+};
+
+/**
+ * Collects boundaries and writes them as one BoundaryFile image
+ */
+class BoundaryFileWriter {
+public:
+    void Add(const BoundaryVersionManager::BoundaryBox& boundary);
+    bool WriteTo(const std::string& filePath) const;
+
+private:
+    std::vector<BoundaryFile::BoundaryRecord> m_records;
+    std::vector<BoundaryFile::VersionColorRecord> m_versionColors;
+    std::vector<double> m_vertexX;
+    std::vector<double> m_vertexY;
+    std::string m_strings;
+
+    std::uint32_t AddString(const std::string& text, std::uint32_t& length);
+};
+
+/**
+ * Read-only memory-mapped view of a BoundaryFile; accessors point straight into the mapping
+ * Open() validates magic, version, section sizes against the file size, and the checksum
+ */
+class BoundaryFileView {
+public:
+    BoundaryFileView();
+    ~BoundaryFileView();
+
+    bool Open(const std::string& filePath);
+    void Close();
+    bool IsOpen() const { return m_header != nullptr; }
+
+    size_t GetBoundaryCount() const { return m_header ? m_header->boundaryCount : 0; }
+    const BoundaryFile::BoundaryRecord& GetRecord(size_t index) const { return m_records[index]; }
+    const BoundaryFile::VersionColorRecord* GetVersionColors(const BoundaryFile::BoundaryRecord& record) const {
+        return m_versionColors + record.firstVersionColor;
+    }
+    const double* GetVertexX(const BoundaryFile::BoundaryRecord& record) const { return m_vertexX + record.firstVertex; }
+    const double* GetVertexY(const BoundaryFile::BoundaryRecord& record) const { return m_vertexY + record.firstVertex; }
+    const char* GetString(std::uint32_t offset) const { return m_strings + offset; }
+
+private:
+    BoundaryFileView(const BoundaryFileView&);
+    BoundaryFileView& operator=(const BoundaryFileView&);
+
+    MappedFile m_file;
+    const BoundaryFile::Header* m_header;
+    const BoundaryFile::BoundaryRecord* m_records;
+    const BoundaryFile::VersionColorRecord* m_versionColors;
+    const double* m_vertexX;
+    const double* m_vertexY;
+    const char* m_strings;
+
+    bool Validate();
+};
+
+} // namespace EnhancedTakeoff
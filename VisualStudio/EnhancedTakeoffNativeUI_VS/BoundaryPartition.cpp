@@ -0,0 +1,186 @@
+// BoundaryPartition.cpp - Non-overlapping planar partition of prioritized boundary regions
+// Enhanced Construction Takeoff - BricsCAD V25 Plugin
+// COPILOT-HINT: Faces come from BoundaryFaceFinder over every region outline; ownership is
+// decided once per face from a point strictly inside it, never per entity
+
+#include "pch.h"
+#include "BoundaryPartition.h"
+#include "BoundaryFaceFinder.h"
+
+#include <algorithm>
+
+namespace EnhancedTakeoff {
+
+namespace {
+    // X of every edge crossing the horizontal line y (y must not hit a vertex)
+    void AddCrossings(const BoundaryPolygon& polygon, double y, std::vector<double>& crossings) {
+        const double* xs = polygon.GetVertexX();
+        const double* ys = polygon.GetVertexY();
+        const size_t count = polygon.GetVertexCount();
+        for (size_t i = 0, j = count - 1; i < count; j = i++) {
+            if ((ys[i] > y) != (ys[j] > y)) {
+                crossings.push_back(xs[j] + (y - ys[j]) * (xs[i] - xs[j]) / (ys[i] - ys[j]));
+            }
+        }
+    }
+
+    // A point strictly inside 'outer' and outside every hole: the middle of the widest inside
+    // interval on a horizontal line through the widest gap between vertex Y values
+    bool InteriorPoint(const BoundaryPolygon& outer, const std::vector<const BoundaryPolygon*>& holes,
+                       double& x, double& y) {
+        std::vector<double> levels(outer.GetVertexY(), outer.GetVertexY() + outer.GetVertexCount());
+        for (const BoundaryPolygon* hole : holes) {
+            levels.insert(levels.end(), hole->GetVertexY(), hole->GetVertexY() + hole->GetVertexCount());
+        }
+        std::sort(levels.begin(), levels.end());
+        levels.erase(std::unique(levels.begin(), levels.end()), levels.end());
+        if (levels.size() < 2) {
+            return false;
+        }
+
+        size_t widestGap = 0;
+        for (size_t i = 1; i + 1 < levels.size(); ++i) {
+            if (levels[i + 1] - levels[i] > levels[widestGap + 1] - levels[widestGap]) widestGap = i;
+        }
+        y = 0.5 * (levels[widestGap] + levels[widestGap + 1]);
+
+        // Holes lie inside the outline and apart from each other, so even-odd pairs are inside intervals
+        std::vector<double> crossings;
+        AddCrossings(outer, y, crossings);
+        for (const BoundaryPolygon* hole : holes) {
+            AddCrossings(*hole, y, crossings);
+        }
+        std::sort(crossings.begin(), crossings.end());
+
+        double widest = 0.0;
+        for (size_t i = 0; i + 1 < crossings.size(); i += 2) {
+            if (crossings[i + 1] - crossings[i] > widest) {
+                widest = crossings[i + 1] - crossings[i];
+                x = 0.5 * (crossings[i] + crossings[i + 1]);
+            }
+        }
+        return widest > 0.0;
+    }
+}
+
+void BoundaryPartition::Build(const std::vector<const BoundaryPolygon*>& regions, const std::vector<int>& priorities) {
+    Clear();
+    m_cellsOf.resize(regions.size());
+
+    BoundaryFaceFinder finder;
+    for (const BoundaryPolygon* region : regions) {
+        if (!region->IsEmpty()) {
+            finder.AddPolyline(region->GetVertexX(), region->GetVertexY(), region->GetVertexCount(), true);
+        }
+    }
+    std::vector<BoundaryFaceFinder::Face> faces;
+    finder.FindFaces(faces);
+
+    // Faces arrive largest first, so an enclosing face always has a lower index
+    m_cells.reserve(faces.size());
+    std::vector<EntitySpatialIndex::Entry> entries;
+    entries.reserve(faces.size());
+    for (const auto& face : faces) {
+        Cell cell;
+        if (!cell.shape.SetVertices(face.xs.data(), face.ys.data(), face.xs.size())) {
+            continue;
+        }
+        cell.area = face.area;
+        entries.push_back(EntitySpatialIndex::Entry(m_cells.size(),
+            EntitySpatialIndex::Box(cell.shape.GetMinX(), cell.shape.GetMinY(), cell.shape.GetMaxX(), cell.shape.GetMaxY())));
+        m_cells.push_back(cell);
+    }
+    m_cellIndex.BulkLoad(entries);
+
+    // Faces of one connected drawing never overlap; a face lies inside another only when its
+    // linework is disconnected from it (a porch drawn inside the house). Such faces become holes
+    std::vector<std::uint64_t> candidates;
+    const std::vector<const BoundaryPolygon*> noHoles;
+    for (size_t cell = 0; cell < m_cells.size(); ++cell) {
+        double x, y;
+        if (!InteriorPoint(m_cells[cell].shape, noHoles, x, y)) {
+            continue;
+        }
+        candidates.clear();
+        m_cellIndex.Query(EntitySpatialIndex::Box(x, y, x, y), candidates);
+
+        std::uint64_t parent = cell;
+        for (std::uint64_t other : candidates) {
+            if (other < cell && (parent == cell || other > parent) && m_cells[other].shape.Contains(x, y)) {
+                parent = other;
+            }
+        }
+        if (parent != cell) {
+            m_cells[parent].holes.push_back(static_cast<std::uint32_t>(cell));
+        }
+    }
+
+    // Every point of a cell (outside its holes) is covered by the same regions - test one of them
+    std::vector<const BoundaryPolygon*> holes;
+    for (size_t cell = 0; cell < m_cells.size(); ++cell) {
+        Cell& target = m_cells[cell];
+        holes.clear();
+        for (std::uint32_t hole : target.holes) {
+            holes.push_back(&m_cells[hole].shape);
+        }
+
+        double x, y;
+        if (!InteriorPoint(target.shape, holes, x, y)) {
+            continue;
+        }
+        for (size_t region = 0; region < regions.size(); ++region) {
+            const BoundaryPolygon& candidate = *regions[region];
+            if (candidate.IsEmpty() || x < candidate.GetMinX() || x > candidate.GetMaxX() ||
+                y < candidate.GetMinY() || y > candidate.GetMaxY()) {
+                continue;
+            }
+            if ((target.owner < 0 || priorities[region] > priorities[target.owner]) && candidate.Contains(x, y)) {
+                target.owner = static_cast<int>(region);
+            }
+        }
+        if (target.owner >= 0) {
+            m_cellsOf[target.owner].push_back(static_cast<std::uint32_t>(cell));
+        }
+    }
+}
+
+void BoundaryPartition::Clear() {
+    m_cells.clear();
+    m_cellsOf.clear();
+    m_cellIndex.Clear();
+}
+
+const std::vector<std::uint32_t>& BoundaryPartition::GetCellsOwnedBy(int region) const {
+    static const std::vector<std::uint32_t> kNoCells;
+    return (region >= 0 && static_cast<size_t>(region) < m_cellsOf.size()) ? m_cellsOf[region] : kNoCells;
+}
+
+int BoundaryPartition::Locate(double x, double y) const {
+    std::vector<std::uint64_t> candidates;
+    const int cell = LocateCell(x, y, candidates);
+    return (cell >= 0) ? m_cells[cell].owner : -1;
+}
+
+void BoundaryPartition::LocatePoints(const double* xs, const double* ys, size_t count, int* owners) const {
+    std::vector<std::uint64_t> candidates;
+    for (size_t i = 0; i < count; ++i) {
+        const int cell = LocateCell(xs[i], ys[i], candidates);
+        owners[i] = (cell >= 0) ? m_cells[cell].owner : -1;
+    }
+}
+
+int BoundaryPartition::LocateCell(double x, double y, std::vector<std::uint64_t>& candidates) const {
+    candidates.clear();
+    m_cellIndex.Query(EntitySpatialIndex::Box(x, y, x, y), candidates);
+
+    // Nested cells are smaller and come later - the innermost containing cell wins
+    int innermost = -1;
+    for (std::uint64_t cell : candidates) {
+        if (static_cast<int>(cell) > innermost && m_cells[cell].shape.Contains(x, y)) {
+            innermost = static_cast<int>(cell);
+        }
+    }
+    return innermost;
+}
+
+} // namespace EnhancedTakeoff
@@ -0,0 +1,52 @@
+// BoundaryPartition.h - Non-overlapping planar partition of prioritized boundary regions
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "BoundaryPolygon.h"
+#include "EntitySpatialIndex.h"
+
+namespace EnhancedTakeoff {
+
+/**
+ * Splits overlapping regions into the faces of their arrangement and gives each face to the
+ * highest-priority region covering it, so every point belongs to at most one region
+ * A cell is a counter-clockwise face minus the faces nested directly inside it (its holes);
+ * cells are ordered largest first and indexed in an R-tree for point location
+ * COPILOT-HINT: Rebuild whenever a region, its priority or the active set changes - cells keep no link to the source
+ */
+class BoundaryPartition {
+public:
+    struct Cell {
+        BoundaryPolygon shape;              // Outer outline (holes not cut out)
+        std::vector<std::uint32_t> holes;   // Cells nested directly inside this one
+        double area;                        // Of the outer outline
+        int owner;                          // Region index, -1 when no region covers the cell
+
+        Cell() : area(0.0), owner(-1) {}
+    };
+
+    // Higher priority wins; equal priorities go to the lower region index
+    void Build(const std::vector<const BoundaryPolygon*>& regions, const std::vector<int>& priorities);
+    void Clear();
+
+    bool IsEmpty() const { return m_cells.empty(); }
+    size_t GetCellCount() const { return m_cells.size(); }
+    const Cell& GetCell(size_t index) const { return m_cells[index]; }
+    const std::vector<std::uint32_t>& GetCellsOwnedBy(int region) const;
+
+    // Owning region of a point, -1 outside every region
+    int Locate(double x, double y) const;
+    void LocatePoints(const double* xs, const double* ys, size_t count, int* owners) const;
+
+private:
+    std::vector<Cell> m_cells;
+    std::vector<std::vector<std::uint32_t>> m_cellsOf;  // Region -> owned cells
+    EntitySpatialIndex m_cellIndex;                     // Cell outline boxes, handle = cell index
+
+    int LocateCell(double x, double y, std::vector<std::uint64_t>& candidates) const;
+};
+
+} // namespace EnhancedTakeoff
@@ -0,0 +1,169 @@
+// BoundaryPolygon.cpp - Closed boundary outline with a precomputed slab/edge table
+// Enhanced Construction Takeoff - BricsCAD V25 Plugin
+// COPILOT-HINT: Built once when a boundary is set; every containment query after that is read-only
+
+#include "pch.h"
+#include "BoundaryPolygon.h"
+
+#include <algorithm>
+
+namespace EnhancedTakeoff {
+
+namespace {
+    // Above this many edges a per-point slab lookup beats the edge-major sweep
+    const size_t kSweepEdgeLimit = 48;
+
+    // Points per block in the edge-major sweep - keeps X, Y and flags in L1
+    const size_t kSweepBlockSize = 512;
+}
+
+BoundaryPolygon::BoundaryPolygon()
+    : m_minX(0.0), m_minY(0.0), m_maxX(0.0), m_maxY(0.0) {
+}
+
+bool BoundaryPolygon::SetVertices(const double* xs, const double* ys, size_t count) {
+    Clear();
+
+    m_x.reserve(count);
+    m_y.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        // Skip consecutive duplicates (zero-length edges)
+        if (!m_x.empty() && xs[i] == m_x.back() && ys[i] == m_y.back()) continue;
+        m_x.push_back(xs[i]);
+        m_y.push_back(ys[i]);
+    }
+    while (m_x.size() > 1 && m_x.back() == m_x.front() && m_y.back() == m_y.front()) {
+        m_x.pop_back();
+        m_y.pop_back();
+    }
+
+    if (m_x.size() < 3) {
+        Clear();
+        return false;
+    }
+
+    m_minX = *std::min_element(m_x.begin(), m_x.end());
+    m_maxX = *std::max_element(m_x.begin(), m_x.end());
+    m_minY = *std::min_element(m_y.begin(), m_y.end());
+    m_maxY = *std::max_element(m_y.begin(), m_y.end());
+
+    BuildEdgeTable();
+    return true;
+}
+
+void BoundaryPolygon::Clear() {
+    m_x.clear();
+    m_y.clear();
+    m_edgeX0.clear();
+    m_edgeY0.clear();
+    m_edgeY1.clear();
+    m_edgeSlope.clear();
+    m_slabY.clear();
+    m_slabStart.clear();
+    m_slabEdges.clear();
+    m_minX = m_minY = m_maxX = m_maxY = 0.0;
+}
+
+double BoundaryPolygon::GetSignedArea() const {
+    double twiceArea = 0.0;
+    const size_t count = m_x.size();
+    for (size_t i = 0, j = count - 1; i < count; j = i++) {
+        twiceArea += m_x[j] * m_y[i] - m_x[i] * m_y[j];
+    }
+    return 0.5 * twiceArea;
+}
+
+void BoundaryPolygon::BuildEdgeTable() {
+    const size_t count = m_x.size();
+    for (size_t i = 0; i < count; ++i) {
+        const size_t next = (i + 1 == count) ? 0 : i + 1;
+        double x0 = m_x[i], y0 = m_y[i];
+        double x1 = m_x[next], y1 = m_y[next];
+        if (y0 == y1) continue;     // Horizontal edges never cross a scanline
+        if (y0 > y1) {
+            std::swap(x0, x1);
+            std::swap(y0, y1);
+        }
+        m_edgeX0.push_back(x0);
+        m_edgeY0.push_back(y0);
+        m_edgeY1.push_back(y1);
+        m_edgeSlope.push_back((x1 - x0) / (y1 - y0));
+    }
+
+    m_slabY = m_y;
+    std::sort(m_slabY.begin(), m_slabY.end());
+    m_slabY.erase(std::unique(m_slabY.begin(), m_slabY.end()), m_slabY.end());
+
+    const size_t slabCount = m_slabY.size() - 1;
+    m_slabStart.reserve(slabCount + 1);
+    std::vector<std::uint32_t> slabEdges;
+    for (size_t s = 0; s < slabCount; ++s) {
+        m_slabStart.push_back(static_cast<std::uint32_t>(m_slabEdges.size()));
+
+        const double bottom = m_slabY[s];
+        const double top = m_slabY[s + 1];
+        const double mid = 0.5 * (bottom + top);
+
+        slabEdges.clear();
+        for (std::uint32_t e = 0; e < m_edgeX0.size(); ++e) {
+            if (m_edgeY0[e] <= bottom && m_edgeY1[e] >= top) {
+                slabEdges.push_back(e);
+            }
+        }
+        // Edges of a simple polygon do not cross inside a slab, so the mid-height order holds throughout
+        std::sort(slabEdges.begin(), slabEdges.end(), [this, mid](std::uint32_t a, std::uint32_t b) {
+            return EdgeXAt(a, mid) < EdgeXAt(b, mid);
+        });
+        m_slabEdges.insert(m_slabEdges.end(), slabEdges.begin(), slabEdges.end());
+    }
+    m_slabStart.push_back(static_cast<std::uint32_t>(m_slabEdges.size()));
+}
+
+bool BoundaryPolygon::Contains(double x, double y) const {
+    if (IsEmpty() || x < m_minX || x > m_maxX || y < m_minY || y >= m_maxY) {
+        return false;
+    }
+
+    const size_t slab = static_cast<size_t>(
+        std::upper_bound(m_slabY.begin(), m_slabY.end(), y) - m_slabY.begin()) - 1;
+    const std::uint32_t* first = m_slabEdges.data() + m_slabStart[slab];
+    const std::uint32_t* last = m_slabEdges.data() + m_slabStart[slab + 1];
+
+    // Number of edges strictly left of the point - odd means inside
+    const std::uint32_t* split = std::partition_point(first, last, [this, x, y](std::uint32_t edge) {
+        return EdgeXAt(edge, y) < x;
+    });
+    return ((split - first) & 1) != 0;
+}
+
+void BoundaryPolygon::ContainsPoints(const double* xs, const double* ys, size_t count,
+                                     std::uint8_t* inside) const {
+    std::fill(inside, inside + count, static_cast<std::uint8_t>(0));
+    if (IsEmpty()) return;
+
+    if (m_edgeX0.size() > kSweepEdgeLimit) {
+        for (size_t i = 0; i < count; ++i) {
+            inside[i] = Contains(xs[i], ys[i]) ? 1 : 0;
+        }
+        return;
+    }
+
+    // Edge-major crossing count: branch-free body over contiguous points
+    const size_t edgeCount = m_edgeX0.size();
+    for (size_t blockStart = 0; blockStart < count; blockStart += kSweepBlockSize) {
+        const size_t blockEnd = std::min(count, blockStart + kSweepBlockSize);
+        for (size_t e = 0; e < edgeCount; ++e) {
+            const double x0 = m_edgeX0[e];
+            const double y0 = m_edgeY0[e];
+            const double y1 = m_edgeY1[e];
+            const double slope = m_edgeSlope[e];
+            for (size_t i = blockStart; i < blockEnd; ++i) {
+                const double py = ys[i];
+                const bool crosses = (py >= y0) & (py < y1) & (xs[i] > x0 + (py - y0) * slope);
+                inside[i] ^= static_cast<std::uint8_t>(crosses);
+            }
+        }
+    }
+}
+
+} // namespace EnhancedTakeoff
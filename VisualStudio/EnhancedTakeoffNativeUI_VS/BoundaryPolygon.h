@@ -0,0 +1,66 @@
+// BoundaryPolygon.h - Closed boundary outline with a precomputed slab/edge table
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace EnhancedTakeoff {
+
+/**
+ * Simple (non-self-intersecting) polygon prepared for fast containment tests
+ * Edges are stored as upward-oriented columns (x0, y0, y1, dx/dy) and bucketed into
+ * horizontal slabs between vertex Y values; each slab's edges are sorted by X, so a
+ * single point is a binary search over slabs plus one over edges
+ * COPILOT-HINT: Half-open rule (y0 <= y < y1, strictly left of edge) - shared edges count for one side only
+ */
+class BoundaryPolygon {
+public:
+    BoundaryPolygon();
+
+    // Takes the outline vertices in order; a repeated closing vertex is dropped
+    // Returns false (and leaves the polygon empty) for fewer than three distinct vertices
+    bool SetVertices(const double* xs, const double* ys, size_t count);
+    void Clear();
+
+    bool IsEmpty() const { return m_x.empty(); }
+    size_t GetVertexCount() const { return m_x.size(); }
+    const double* GetVertexX() const { return m_x.data(); }
+    const double* GetVertexY() const { return m_y.data(); }
+    double GetMinX() const { return m_minX; }
+    double GetMinY() const { return m_minY; }
+    double GetMaxX() const { return m_maxX; }
+    double GetMaxY() const { return m_maxY; }
+    double GetSignedArea() const;   // Positive for counter-clockwise outlines
+
+    // Single point - slab lookup, O(log n)
+    bool Contains(double x, double y) const;
+
+    // Many points (entity vertices or centers) - inside[i] is 1 or 0
+    // Small polygons run edge-major over blocks of points so the inner loop vectorizes
+    void ContainsPoints(const double* xs, const double* ys, size_t count, std::uint8_t* inside) const;
+
+private:
+    std::vector<double> m_x;
+    std::vector<double> m_y;
+    double m_minX, m_minY, m_maxX, m_maxY;
+
+    // Edge table (horizontal edges dropped, y0 < y1)
+    std::vector<double> m_edgeX0;
+    std::vector<double> m_edgeY0;
+    std::vector<double> m_edgeY1;
+    std::vector<double> m_edgeSlope;    // dx/dy
+
+    // Slab i spans [m_slabY[i], m_slabY[i + 1]); its edges are
+    // m_slabEdges[m_slabStart[i] .. m_slabStart[i + 1]) ordered left to right
+    std::vector<double> m_slabY;
+    std::vector<std::uint32_t> m_slabStart;
+    std::vector<std::uint32_t> m_slabEdges;
+
+    void BuildEdgeTable();
+    double EdgeXAt(std::uint32_t edge, double y) const {
+        return m_edgeX0[edge] + (y - m_edgeY0[edge]) * m_edgeSlope[edge];
+    }
+};
+
+} // namespace EnhancedTakeoff
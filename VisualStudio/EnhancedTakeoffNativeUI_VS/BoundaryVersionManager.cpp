@@ -4,10 +4,54 @@
 
 #include "pch.h"
 #include "BoundaryVersionManager.h"
+#include "EntitySpatialIndex.h"
+#include "EntitySnapshotStore.h"
+#include "BoundaryClipper.h"
+#include "BoundaryFaceFinder.h"
+#include "BoundaryFile.h"
+#include "BoundaryPartition.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <thread>
 
 namespace EnhancedTakeoff {
 
-BoundaryVersionManager::BoundaryVersionManager() {
+namespace {
+    const char* const kElevationCodes[BoundaryVersionManager::kElevationCodeCount] = {
+        "AGS", "AGH", "AGB", "ANS", "ANH", "ANB",
+        "HGS", "HGH", "HGB", "HNS", "HNH", "HNB"
+    };
+    
+    // Same closed ring of vertices, from any start vertex and in either direction
+    bool IsSameRing(const double* ax, const double* ay, size_t count,
+                    const double* bx, const double* by, size_t otherCount, double tolerance) {
+        if (count != otherCount || count == 0) return false;
+        auto near = [&](size_t a, size_t b) {
+            return std::fabs(ax[a] - bx[b]) <= tolerance && std::fabs(ay[a] - by[b]) <= tolerance;
+        };
+        for (size_t start = 0; start < count; ++start) {
+            if (!near(0, start)) continue;
+            bool forward = true;
+            bool backward = true;
+            for (size_t i = 1; i < count && (forward || backward); ++i) {
+                forward = forward && near(i, (start + i) % count);
+                backward = backward && near(i, (start + count - i) % count);
+            }
+            if (forward || backward) return true;
+        }
+        return false;
+    }
+}
+
+BoundaryVersionManager::BoundaryVersionManager()
+    : m_entityIndex(nullptr)
+    , m_snapshot(nullptr)
+    , m_overlapMode(OverlapMode::Independent)
+    , m_partition(std::make_unique<BoundaryPartition>())
+    , m_partitionValid(false) {
     // Initialize empty boundary collection
 }
 
@@ -27,6 +71,7 @@ bool BoundaryVersionManager::CreateBoundary(const std::string& name, const std::
     boundary.isActive = true;
     
     m_boundaries[name] = boundary;
+    RebuildPartition();
     return true;
 }
 
@@ -34,6 +79,7 @@ bool BoundaryVersionManager::DeleteBoundary(const std::string& name) {
     auto it = m_boundaries.find(name);
     if (it != m_boundaries.end()) {
         m_boundaries.erase(it);
+        RebuildPartition();
         return true;
     }
     return false;
@@ -43,6 +89,7 @@ bool BoundaryVersionManager::ToggleBoundary(const std::string& name, bool active
     auto it = m_boundaries.find(name);
     if (it != m_boundaries.end()) {
         it->second.isActive = active;
+        RebuildPartition();
         return true;
     }
     return false;
@@ -53,7 +100,21 @@ bool BoundaryVersionManager::AssignVersionColors(const std::string& boundaryName
                                                 const std::vector<int>& colorIndices) {
     auto it = m_boundaries.find(boundaryName);
     if (it != m_boundaries.end()) {
-        it->second.versionColors[versionComponent] = colorIndices;
+        BoundaryBox& boundary = it->second;
+        boundary.versionColors[versionComponent] = ColorMask(colorIndices);
+        
+        // Only codes that use this component change - re-resolve those and keep the rest
+        const std::uint16_t affected = GetCodesUsingComponent(versionComponent);
+        boundary.resolvedValid &= static_cast<std::uint16_t>(~affected);
+        for (int code = 0; code < kElevationCodeCount; ++code) {
+            if (affected & (1u << code)) {
+                ResolveVersionColors(boundary, code);
+            }
+        }
+        
+        if (!boundary.activeVersion.empty()) {
+            UpdateActiveColors(boundary, boundary.activeVersion);
+        }
         return true;
     }
     return false;
@@ -61,39 +122,34 @@ bool BoundaryVersionManager::AssignVersionColors(const std::string& boundaryName
 
 std::vector<int> BoundaryVersionManager::GetActiveVersionColors(const std::string& boundaryName,
                                                               const std::string& activeVersion) const {
+    return GetActiveVersionColorMask(boundaryName, activeVersion).ToVector();
+}
+
+ColorMask BoundaryVersionManager::GetActiveVersionColorMask(const std::string& boundaryName,
+                                                            const std::string& activeVersion) const {
     auto it = m_boundaries.find(boundaryName);
     if (it == m_boundaries.end() || activeVersion.length() < 3) {
-        return {};
-    }
-    
-    const BoundaryBox& boundary = it->second;
-    std::vector<int> activeColors = boundary.baseColors;
-    
-    // Apply version-specific colors
-    char frameType = activeVersion[0];  // A or H
-    char garageType = activeVersion[1]; // G or N  
-    char sidingType = activeVersion[2]; // S, H, or B
-    
-    // Add colors for active version components
-    auto frameIt = boundary.versionColors.find(frameType);
-    if (frameIt != boundary.versionColors.end()) {
-        activeColors.insert(activeColors.end(), frameIt->second.begin(), frameIt->second.end());
-    }
-    
-    auto garageIt = boundary.versionColors.find(garageType);
-    if (garageIt != boundary.versionColors.end()) {
-        activeColors.insert(activeColors.end(), garageIt->second.begin(), garageIt->second.end());
+        return ColorMask();
     }
     
-    auto sidingIt = boundary.versionColors.find(sidingType);
-    if (sidingIt != boundary.versionColors.end()) {
-        activeColors.insert(activeColors.end(), sidingIt->second.begin(), sidingIt->second.end());
+    const int code = GetElevationCodeIndex(activeVersion);
+    return (code >= 0) ? ResolveVersionColors(it->second, code)
+                       : ComposeVersionColors(it->second, activeVersion);
+}
+
+BoundaryVersionManager::BoundaryBox* BoundaryVersionManager::GetBoundary(const std::string& name) {
+    auto it = m_boundaries.find(name);
+    if (it == m_boundaries.end()) {
+        return nullptr;
     }
     
-    return activeColors;
+    // The caller may edit colors or geometry through the pointer - resolve again on next lookup
+    it->second.resolvedValid = 0;
+    InvalidatePartition();
+    return &it->second;
 }
 
-BoundaryVersionManager::BoundaryBox* BoundaryVersionManager::GetBoundary(const std::string& name) {
+const BoundaryVersionManager::BoundaryBox* BoundaryVersionManager::GetBoundary(const std::string& name) const {
     auto it = m_boundaries.find(name);
     return (it != m_boundaries.end()) ? &it->second : nullptr;
 }
@@ -112,8 +168,10 @@ std::vector<std::string> BoundaryVersionManager::GetAllBoundaryNames() const {
 std::vector<BoundaryVersionManager::BoundaryBox> BoundaryVersionManager::GetBoundariesForPlan(const std::string& planName) const {
     std::vector<BoundaryBox> result;
     
+    // One lookup, then id compares - a plan nobody used matches nothing
+    const InternedName plan = InternedName::Find(planName);
     for (const auto& pair : m_boundaries) {
-        if (pair.second.attachmentPlan == planName) {
+        if (pair.second.attachmentPlan == plan) {
             result.push_back(pair.second);
         }
     }
@@ -121,14 +179,443 @@ std::vector<BoundaryVersionManager::BoundaryBox> BoundaryVersionManager::GetBoun
     return result;
 }
 
+bool BoundaryVersionManager::SetBoundaryExtents(const std::string& name,
+                                                double minX, double minY,
+                                                double maxX, double maxY) {
+    auto it = m_boundaries.find(name);
+    if (it == m_boundaries.end()) {
+        return false;
+    }
+    
+    BoundaryBox& boundary = it->second;
+    boundary.minX = std::min(minX, maxX);
+    boundary.minY = std::min(minY, maxY);
+    boundary.maxX = std::max(minX, maxX);
+    boundary.maxY = std::max(minY, maxY);
+    boundary.hasExtents = true;
+    boundary.outline.Clear();
+    RebuildPartition();
+    return true;
+}
+
+bool BoundaryVersionManager::SetBoundaryOutline(const std::string& name,
+                                                const std::vector<double>& xs,
+                                                const std::vector<double>& ys) {
+    auto it = m_boundaries.find(name);
+    if (it == m_boundaries.end() || xs.size() != ys.size()) {
+        return false;
+    }
+    
+    if (!ApplyOutline(it->second, xs, ys)) {
+        return false;
+    }
+    RebuildPartition();
+    return true;
+}
+
+bool BoundaryVersionManager::ApplyOutline(BoundaryBox& boundary,
+                                          const std::vector<double>& xs,
+                                          const std::vector<double>& ys) const {
+    if (!boundary.outline.SetVertices(xs.data(), ys.data(), xs.size())) {
+        return false;
+    }
+    
+    // Extents follow the outline so the R-tree prefilter still applies
+    boundary.minX = boundary.outline.GetMinX();
+    boundary.minY = boundary.outline.GetMinY();
+    boundary.maxX = boundary.outline.GetMaxX();
+    boundary.maxY = boundary.outline.GetMaxY();
+    boundary.hasExtents = true;
+    return true;
+}
+
+bool BoundaryVersionManager::IsPlanPointInBoundary(double x, double y, const std::string& name) const {
+    auto it = m_boundaries.find(name);
+    return it != m_boundaries.end() && it->second.hasExtents && IsCenterOwned(it->second, x, y);
+}
+
+std::vector<std::uint64_t> BoundaryVersionManager::GetEntityHandlesInBoundary(const std::string& name) const {
+    std::vector<std::uint64_t> handles;
+    
+    auto it = m_boundaries.find(name);
+    if (it == m_boundaries.end() || !it->second.hasExtents || !m_entityIndex) {
+        return handles;
+    }
+    
+    const BoundaryBox& boundary = it->second;
+    std::vector<std::uint64_t> candidates;
+    m_entityIndex->Query(EntitySpatialIndex::Box(boundary.minX, boundary.minY, boundary.maxX, boundary.maxY),
+                         candidates);
+    
+    // The R-tree returns overlapping boxes; keep entities whose center is inside
+    FilterByCenter(boundary, candidates, handles);
+    return handles;
+}
+
+bool BoundaryVersionManager::IsEntityHandleInBoundary(std::uint64_t handle, const std::string& name) const {
+    auto it = m_boundaries.find(name);
+    if (it == m_boundaries.end() || !it->second.hasExtents || !m_entityIndex) {
+        return false;
+    }
+    
+    EntitySpatialIndex::Box box;
+    if (!m_entityIndex->GetBox(handle, box)) {
+        return false;
+    }
+    return IsCenterOwned(it->second, 0.5 * (box.minX + box.maxX), 0.5 * (box.minY + box.maxY));
+}
+
+std::map<std::string, std::vector<std::uint64_t>> BoundaryVersionManager::GetEntityHandlesInActiveBoundaries() const {
+    std::map<std::string, std::vector<std::uint64_t>> result;
+    if (!m_entityIndex) {
+        return result;
+    }
+    
+    // One batched traversal serves every active boundary
+    std::vector<const BoundaryBox*> active;
+    std::vector<EntitySpatialIndex::Box> regions;
+    for (const auto& pair : m_boundaries) {
+        const BoundaryBox& boundary = pair.second;
+        if (boundary.isActive && boundary.hasExtents) {
+            active.push_back(&boundary);
+            regions.push_back(EntitySpatialIndex::Box(boundary.minX, boundary.minY, boundary.maxX, boundary.maxY));
+        }
+    }
+    
+    std::vector<std::vector<std::uint64_t>> candidates;
+    m_entityIndex->QueryBatch(regions, candidates);
+    
+    for (size_t i = 0; i < active.size(); ++i) {
+        FilterByCenter(*active[i], candidates[i], result[active[i]->name]);
+    }
+    return result;
+}
+
+void BoundaryVersionManager::SetOverlapMode(OverlapMode mode) {
+    if (m_overlapMode != mode) {
+        m_overlapMode = mode;
+        RebuildPartition();
+    }
+}
+
+bool BoundaryVersionManager::SetBoundaryPriority(const std::string& name, int priority) {
+    auto it = m_boundaries.find(name);
+    if (it == m_boundaries.end()) {
+        return false;
+    }
+    
+    it->second.priority = priority;
+    RebuildPartition();
+    return true;
+}
+
+std::string BoundaryVersionManager::FindBoundaryAt(double x, double y) const {
+    if (m_overlapMode == OverlapMode::Priority) {
+        EnsurePartition();
+        const int region = m_partition->Locate(x, y);
+        return (region >= 0) ? m_partitionRegions[region]->name.str() : std::string();
+    }
+    
+    // Without a partition, the highest-priority active boundary covering the point
+    const BoundaryBox* best = nullptr;
+    for (const auto& pair : m_boundaries) {
+        const BoundaryBox& boundary = pair.second;
+        if (boundary.isActive && boundary.hasExtents && (!best || boundary.priority > best->priority) &&
+            IsCenterInExtents(boundary, x, y)) {
+            best = &boundary;
+        }
+    }
+    return best ? best->name.str() : std::string();
+}
+
+#ifndef BUILDING_TESTS
+#if HAS_BRX_SDK
+bool BoundaryVersionManager::SetBoundaryExtents(const std::string& name,
+                                                const AcGePoint3d& minPt,
+                                                const AcGePoint3d& maxPt) {
+    auto it = m_boundaries.find(name);
+    if (it == m_boundaries.end()) {
+        return false;
+    }
+    
+    it->second.minPoint = minPt;
+    it->second.maxPoint = maxPt;
+    it->second.minZ = std::min(minPt.z, maxPt.z);
+    it->second.maxZ = std::max(minPt.z, maxPt.z);
+    return SetBoundaryExtents(name, minPt.x, minPt.y, maxPt.x, maxPt.y);
+}
+
+std::vector<AcDbObjectId> BoundaryVersionManager::GetEntitiesInBoundary(const std::string& name) const {
+    std::vector<AcDbObjectId> entities;
+    
+    AcDbDatabase* pDb = acdbHostApplicationServices()->workingDatabase();
+    if (!pDb) {
+        return entities;
+    }
+    
+    for (std::uint64_t handleValue : GetEntityHandlesInBoundary(name)) {
+        AcDbObjectId entityId;
+        AcDbHandle handle(static_cast<int>(handleValue & 0xFFFFFFFFu), static_cast<int>(handleValue >> 32));
+        if (pDb->getAcDbObjectId(entityId, false, handle) == Acad::eOk) {
+            entities.push_back(entityId);
+        }
+    }
+    return entities;
+}
+
+bool BoundaryVersionManager::IsEntityInBoundary(const AcDbObjectId& entityId, const std::string& name) const {
+    AcDbHandle handle = entityId.handle();
+    const std::uint64_t handleValue = (static_cast<std::uint64_t>(handle.high()) << 32) | handle.low();
+    return IsEntityHandleInBoundary(handleValue, name);
+}
+
+bool BoundaryVersionManager::SetBoundaryFromPolyline(const std::string& name, const AcDbObjectId& polylineId) {
+    auto it = m_boundaries.find(name);
+    if (it == m_boundaries.end()) {
+        return false;
+    }
+    
+    AcDbPolyline* pPoly = nullptr;
+    if (acdbOpenObject(pPoly, polylineId, AcDb::kForRead) != Acad::eOk || !pPoly) {
+        return false;
+    }
+    
+    // Vertices only - boundary outlines from CreateBoundaryBox have no arc segments
+    std::vector<double> xs, ys;
+    for (unsigned int i = 0; i < pPoly->numVerts(); ++i) {
+        AcGePoint2d pt;
+        pPoly->getPointAt(i, pt);
+        xs.push_back(pt.x);
+        ys.push_back(pt.y);
+    }
+    pPoly->close();
+    
+    if (!SetBoundaryOutline(name, xs, ys)) {
+        return false;
+    }
+    it->second.boundaryEntity = polylineId;
+    it->second.minPoint = AcGePoint3d(it->second.minX, it->second.minY, 0.0);
+    it->second.maxPoint = AcGePoint3d(it->second.maxX, it->second.maxY, 0.0);
+    return true;
+}
+
+bool BoundaryVersionManager::IsPointInBoundary(const AcGePoint3d& pt, const BoundaryBox& boundary) const {
+    return boundary.hasExtents && IsCenterOwned(boundary, pt.x, pt.y);
+}
+#endif
+#endif
+
+int BoundaryVersionManager::DetectBoundariesFromLinework(const std::string& attachmentPlan,
+                                                         const std::string& namePrefix,
+                                                         const BoundaryFaceFinder& linework,
+                                                         double minArea) {
+    std::vector<BoundaryFaceFinder::Face> faces;
+    linework.FindFaces(faces, minArea);
+    
+    // Boundaries go in directly so a large plan rebuilds the partition once, not once per face
+    int created = 0;
+    int suffix = 1;
+    for (const auto& face : faces) {
+        if (HasBoundaryOutline(attachmentPlan, face.xs, face.ys)) {
+            continue;   // Detected on an earlier run - a second copy would count the region twice
+        }
+        
+        std::string name;
+        do {
+            name = namePrefix + " " + std::to_string(suffix++);
+        } while (m_boundaries.count(name));
+        
+        BoundaryBox boundary;
+        boundary.name = name;
+        boundary.attachmentPlan = attachmentPlan;
+        boundary.isActive = true;
+        if (ValidateBoundaryName(name) && ApplyOutline(boundary, face.xs, face.ys)) {
+            m_boundaries[name] = boundary;
+            created++;
+        }
+    }
+    if (created > 0) {
+        RebuildPartition();
+    }
+    return created;
+}
+
+bool BoundaryVersionManager::HasBoundaryOutline(const std::string& attachmentPlan,
+                                                const std::vector<double>& xs,
+                                                const std::vector<double>& ys) const {
+    if (xs.empty() || xs.size() != ys.size()) return false;
+    
+    const auto bounds = std::minmax_element(xs.begin(), xs.end());
+    const auto boundsY = std::minmax_element(ys.begin(), ys.end());
+    const double extent = std::max(*bounds.second - *bounds.first, *boundsY.second - *boundsY.first);
+    const double tolerance = 1e-6 * std::max(1.0, extent);
+    
+    const InternedName plan = InternedName::Find(attachmentPlan);
+    for (const auto& pair : m_boundaries) {
+        const BoundaryBox& boundary = pair.second;
+        if (boundary.attachmentPlan != plan || !boundary.hasExtents ||
+            std::fabs(boundary.minX - *bounds.first) > tolerance || std::fabs(boundary.maxX - *bounds.second) > tolerance ||
+            std::fabs(boundary.minY - *boundsY.first) > tolerance || std::fabs(boundary.maxY - *boundsY.second) > tolerance) {
+            continue;
+        }
+        
+        // An outline-less boundary is its extents rectangle
+        const double boxX[] = { boundary.minX, boundary.maxX, boundary.maxX, boundary.minX };
+        const double boxY[] = { boundary.minY, boundary.minY, boundary.maxY, boundary.maxY };
+        const bool hasOutline = !boundary.outline.IsEmpty();
+        if (IsSameRing(xs.data(), ys.data(), xs.size(),
+                       hasOutline ? boundary.outline.GetVertexX() : boxX,
+                       hasOutline ? boundary.outline.GetVertexY() : boxY,
+                       hasOutline ? boundary.outline.GetVertexCount() : 4, tolerance)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+#if !defined(BUILDING_TESTS) && HAS_BRX_SDK
+namespace {
+    const char* const kBoundaryLayerPrefix = "BOUNDARY_";
+    const ACHAR* const kBoundaryXDataApp = _T("ENHANCED_TAKEOFF_BOUNDARY");
+    
+    // Boundary type stored by AttachmentManager::AddBoundaryXData, empty when absent
+    std::string GetBoundaryXDataType(const AcDbEntity* pEnt) {
+        std::string type;
+        struct resbuf* pXData = pEnt->xData(kBoundaryXDataApp);
+        for (struct resbuf* pRb = pXData; pRb; pRb = pRb->rbnext) {
+            if (pRb->restype == AcDb::kDxfXdAsciiString) {
+                type = CT2A(pRb->resval.rstring);
+                break;
+            }
+        }
+        if (pXData) acutRelRb(pXData);
+        return type;
+    }
+    
+    // Lines and polylines feed the face finder; returns false for other entity types
+    bool AddLinework(const AcDbEntity* pEnt, BoundaryFaceFinder& linework) {
+        if (const AcDbLine* pLine = AcDbLine::cast(pEnt)) {
+            linework.AddSegment(pLine->startPoint().x, pLine->startPoint().y,
+                                pLine->endPoint().x, pLine->endPoint().y);
+            return true;
+        }
+        if (const AcDbPolyline* pPoly = AcDbPolyline::cast(pEnt)) {
+            std::vector<double> xs, ys;
+            for (unsigned int i = 0; i < pPoly->numVerts(); ++i) {
+                AcGePoint2d pt;
+                pPoly->getPointAt(i, pt);
+                xs.push_back(pt.x);
+                ys.push_back(pt.y);
+            }
+            linework.AddPolyline(xs.data(), ys.data(), xs.size(), pPoly->isClosed());
+            return true;
+        }
+        return false;
+    }
+}
+#endif
+
 bool BoundaryVersionManager::AutoDetectBoundaries(const std::string& attachmentPlan) {
-    // Placeholder implementation - would scan drawing for boundary objects
+#if !defined(BUILDING_TESTS) && HAS_BRX_SDK
+    AcDbDatabase* pDb = acdbHostApplicationServices()->workingDatabase();
+    if (!pDb) return false;
+    
+    AcDbBlockTable* pBlockTable = nullptr;
+    if (pDb->getBlockTable(pBlockTable, AcDb::kForRead) != Acad::eOk) return false;
+    AcDbBlockTableRecord* pModelSpace = nullptr;
+    Acad::ErrorStatus es = pBlockTable->getAt(ACDB_MODEL_SPACE, pModelSpace, AcDb::kForRead);
+    pBlockTable->close();
+    if (es != Acad::eOk) return false;
+    
+    // Tagged closed polylines are boundaries already; other linework is grouped per layer
+    std::map<std::string, BoundaryFaceFinder> lineworkByLayer;
+    std::vector<std::pair<std::string, AcDbObjectId>> taggedOutlines;
+    AcDbBlockTableRecordIterator* pIter = nullptr;
+    if (pModelSpace->newIterator(pIter) == Acad::eOk) {
+        for (; !pIter->done(); pIter->step()) {
+            AcDbEntity* pEnt = nullptr;
+            if (pIter->getEntity(pEnt, AcDb::kForRead) != Acad::eOk) continue;
+            
+            const std::string layer = CT2A(pEnt->layer());
+            const std::string tag = GetBoundaryXDataType(pEnt);
+            const AcDbPolyline* pPoly = AcDbPolyline::cast(pEnt);
+            if (!tag.empty() && pPoly && pPoly->isClosed()) {
+                taggedOutlines.push_back(std::make_pair(tag, pEnt->objectId()));
+            } else if (layer.compare(0, std::strlen(kBoundaryLayerPrefix), kBoundaryLayerPrefix) == 0 || !tag.empty()) {
+                AddLinework(pEnt, lineworkByLayer[layer]);
+            }
+            pEnt->close();
+        }
+        delete pIter;
+    }
+    pModelSpace->close();
+    
+    int created = 0;
+    for (const auto& outline : taggedOutlines) {
+        // A tagged polyline that already backs a boundary was picked up on an earlier run
+        const bool known = std::any_of(m_boundaries.begin(), m_boundaries.end(),
+            [&](const std::pair<const std::string, BoundaryBox>& pair) {
+                return pair.second.boundaryEntity == outline.second;
+            });
+        if (known) continue;
+        
+        std::string name = outline.first;
+        for (int suffix = 2; m_boundaries.count(name); ++suffix) {
+            name = outline.first + " " + std::to_string(suffix);
+        }
+        if (!CreateBoundary(name, attachmentPlan)) continue;
+        if (SetBoundaryFromPolyline(name, outline.second)) {
+            created++;
+        } else {
+            DeleteBoundary(name);   // Unreadable outline - do not leave an empty boundary behind
+        }
+    }
+    for (const auto& layer : lineworkByLayer) {
+        const std::string prefix = (layer.first.compare(0, std::strlen(kBoundaryLayerPrefix), kBoundaryLayerPrefix) == 0)
+            ? layer.first.substr(std::strlen(kBoundaryLayerPrefix)) : layer.first;
+        created += DetectBoundariesFromLinework(attachmentPlan, prefix, layer.second);
+    }
+    return created > 0;
+#else
+    // No drawing to scan headless - feed DetectBoundariesFromLinework directly
     return false;
+#endif
 }
 
 bool BoundaryVersionManager::DetectBoundaryFromSelection(const std::string& name) {
-    // Placeholder implementation - would create boundary from user selection
+#if !defined(BUILDING_TESTS) && HAS_BRX_SDK
+    if (!ValidateBoundaryName(name)) return false;
+    
+    ads_name selection;
+    if (acedSSGet(nullptr, nullptr, nullptr, nullptr, selection) != RTNORM) return false;
+    
+    BoundaryFaceFinder linework;
+    Adesk::Int32 length = 0;
+    acedSSLength(selection, &length);
+    for (Adesk::Int32 i = 0; i < length; ++i) {
+        ads_name entityName;
+        AcDbObjectId entityId;
+        AcDbEntity* pEnt = nullptr;
+        if (acedSSName(selection, i, entityName) != RTNORM ||
+            acdbGetObjectId(entityId, entityName) != Acad::eOk ||
+            acdbOpenObject(pEnt, entityId, AcDb::kForRead) != Acad::eOk) {
+            continue;
+        }
+        AddLinework(pEnt, linework);
+        pEnt->close();
+    }
+    acedSSFree(selection);
+    
+    // The selection's largest closed face becomes the boundary outline
+    std::vector<BoundaryFaceFinder::Face> faces;
+    if (linework.FindFaces(faces, 1.0) == 0) return false;
+    
+    if (!m_boundaries.count(name) && !CreateBoundary(name, m_activeAttachment)) return false;
+    return SetBoundaryOutline(name, faces.front().xs, faces.front().ys);
+#else
+    // Needs an interactive selection
     return false;
+#endif
 }
 
 void BoundaryVersionManager::SwitchVersion(const std::string& boundaryName, const std::string& newVersion) {
@@ -138,56 +625,496 @@ void BoundaryVersionManager::SwitchVersion(const std::string& boundaryName, cons
     }
 }
 
+void BoundaryVersionManager::SwitchAllVersions(const std::string& newVersion) {
+    for (auto& pair : m_boundaries) {
+        UpdateActiveColors(pair.second, newVersion);
+    }
+}
+
+bool BoundaryVersionManager::ApplyChanges(const ChangeSet& changes, ColorMask* affectedColors) {
+    // Validate everything first so a rejected set leaves no partial edits behind
+    for (const auto& toggle : changes.toggles) {
+        if (!m_boundaries.count(toggle.first)) {
+            return false;
+        }
+    }
+    for (const auto& version : changes.versions) {
+        if (!m_boundaries.count(version.first) || version.second.length() < 3) {
+            return false;
+        }
+    }
+    
+    ColorMask affected;
+    bool activeSetChanged = false;
+    for (const auto& toggle : changes.toggles) {
+        BoundaryBox& boundary = m_boundaries.find(toggle.first)->second;
+        if (boundary.isActive == toggle.second) {
+            continue;
+        }
+        boundary.isActive = toggle.second;
+        activeSetChanged = true;
+    }
+    
+    for (const auto& version : changes.versions) {
+        BoundaryBox& boundary = m_boundaries.find(version.first)->second;
+        const ColorMask previous = boundary.activeColors;
+        UpdateActiveColors(boundary, version.second);
+        affected |= previous ^ boundary.activeColors;
+    }
+    
+    if (activeSetChanged) {
+        RebuildPartition();
+        // Clipped totals count every color under an outline, not only the boundary's assigned
+        // ones - and detected boundaries have none assigned - so any color can move
+        affected = ColorMask::All();
+    }
+    if (affectedColors) {
+        *affectedColors = affected;
+    }
+    if (!affected.IsEmpty()) {
+        NotifyChange(affected);
+    }
+    return true;
+}
+
+void BoundaryVersionManager::RegisterChangeCallback(ChangeCallback callback) {
+    if (callback) {
+        m_callbacks.push_back(callback);
+    }
+}
+
+void BoundaryVersionManager::NotifyChange(const ColorMask& affectedColors) {
+    for (auto& callback : m_callbacks) {
+        if (callback) {
+            callback(affectedColors);
+        }
+    }
+}
+
+void BoundaryVersionManager::PrecomputeVersionTables() {
+    for (const auto& pair : m_boundaries) {
+        for (int code = 0; code < kElevationCodeCount; ++code) {
+            ResolveVersionColors(pair.second, code);
+        }
+    }
+}
+
+int BoundaryVersionManager::GetElevationCodeIndex(const std::string& version) {
+    if (version.length() < 3) {
+        return -1;
+    }
+    
+    int frame, garage, siding;
+    switch (version[0]) {
+        case 'A': frame = 0; break;
+        case 'H': frame = 1; break;
+        default: return -1;
+    }
+    switch (version[1]) {
+        case 'G': garage = 0; break;
+        case 'N': garage = 1; break;
+        default: return -1;
+    }
+    switch (version[2]) {
+        case 'S': siding = 0; break;
+        case 'H': siding = 1; break;
+        case 'B': siding = 2; break;
+        default: return -1;
+    }
+    return frame * 6 + garage * 3 + siding;
+}
+
+const char* BoundaryVersionManager::GetElevationCode(int index) {
+    return (index >= 0 && index < kElevationCodeCount) ? kElevationCodes[index] : "";
+}
+
 std::set<int> BoundaryVersionManager::GetColorDifference(const std::string& boundaryName,
                                                        const std::string& version1,
                                                        const std::string& version2) const {
-    std::vector<int> colors1 = GetActiveVersionColors(boundaryName, version1);
-    std::vector<int> colors2 = GetActiveVersionColors(boundaryName, version2);
+    // Colors in exactly one of the two versions
+    ColorMask difference = GetActiveVersionColorMask(boundaryName, version1) ^
+                           GetActiveVersionColorMask(boundaryName, version2);
     
-    std::set<int> difference;
+    std::vector<int> colors = difference.ToVector();
+    return std::set<int>(colors.begin(), colors.end());
+}
+
+void BoundaryVersionManager::SetEntitySnapshot(const EntitySnapshotStore* snapshot) {
+    m_snapshot = snapshot;
+    m_snapshotRowOf.clear();
+    if (!snapshot) {
+        return;
+    }
     
-    // Find colors in version1 but not in version2
-    for (int color : colors1) {
-        if (std::find(colors2.begin(), colors2.end(), color) == colors2.end()) {
-            difference.insert(color);
+    const std::uint64_t* handles = snapshot->GetHandles();
+    m_snapshotRowOf.reserve(snapshot->GetEntityCount());
+    for (size_t row = 0; row < snapshot->GetEntityCount(); ++row) {
+        m_snapshotRowOf[handles[row]] = static_cast<std::uint32_t>(row);
+    }
+}
+
+BoundaryVersionManager::BoundaryTotals BoundaryVersionManager::CalculateBoundaryTotals(const std::string& name) const {
+    BoundaryTotals totals;
+    auto it = m_boundaries.find(name);
+    if (it != m_boundaries.end()) {
+        ClipBoundary(it->second, totals);
+    }
+    return totals;
+}
+
+std::map<std::string, BoundaryVersionManager::BoundaryTotals>
+BoundaryVersionManager::CalculateActiveBoundaryTotals(unsigned int threadCount) const {
+    std::vector<const BoundaryBox*> active;
+    for (const auto& pair : m_boundaries) {
+        if (pair.second.isActive && pair.second.hasExtents) {
+            active.push_back(&pair.second);
         }
     }
     
-    // Find colors in version2 but not in version1
-    for (int color : colors2) {
-        if (std::find(colors1.begin(), colors1.end(), color) == colors1.end()) {
-            difference.insert(color);
+    // Boundaries are independent - each worker clips whole boundaries into its own slot
+    EnsurePartition();
+    std::vector<BoundaryTotals> perBoundary(active.size());
+    if (threadCount == 0) {
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+    threadCount = static_cast<unsigned int>(std::min<size_t>(threadCount, active.size()));
+    
+    std::atomic<size_t> nextBoundary(0);
+    auto worker = [&]() {
+        for (size_t i = nextBoundary++; i < active.size(); i = nextBoundary++) {
+            ClipBoundary(*active[i], perBoundary[i]);
+        }
+    };
+    
+    if (threadCount <= 1) {
+        worker();
+    } else {
+        std::vector<std::thread> threads;
+        threads.reserve(threadCount);
+        for (unsigned int t = 0; t < threadCount; ++t) {
+            threads.emplace_back(worker);
+        }
+        for (auto& thread : threads) {
+            thread.join();
         }
     }
     
-    return difference;
+    std::map<std::string, BoundaryTotals> result;
+    for (size_t i = 0; i < active.size(); ++i) {
+        result[active[i]->name].swap(perBoundary[i]);
+    }
+    return result;
 }
 
 std::map<int, double> BoundaryVersionManager::CalculateQuantitiesInBoundary(const std::string& name) const {
-    // Placeholder implementation - would calculate actual quantities
     std::map<int, double> quantities;
     
-    auto it = m_boundaries.find(name);
-    if (it != m_boundaries.end()) {
-        const BoundaryBox& boundary = it->second;
-        
-        // Mock calculation for base colors
-        for (int color : boundary.baseColors) {
-            quantities[color] = 100.0; // Placeholder value
+    for (const auto& pair : CalculateBoundaryTotals(name)) {
+        const QuantityEngine::ColorTotals& totals = pair.second;
+        if (totals.squareFeet > 0.0) {
+            quantities[pair.first] = totals.squareFeet;
+        } else if (totals.linearFeet > 0.0) {
+            quantities[pair.first] = totals.linearFeet;
+        } else {
+            quantities[pair.first] = totals.each;
         }
     }
     
     return quantities;
 }
 
+void BoundaryVersionManager::ClipBoundary(const BoundaryBox& boundary, BoundaryTotals& totals) const {
+    if (!m_snapshot || !boundary.hasExtents) {
+        return;
+    }
+    
+    const int region = GetPartitionRegion(boundary);
+    if (region >= 0) {
+        ClipPartitionCells(region, totals);
+        return;
+    }
+    
+    // Rectangle-only boundaries clip against their extents
+    BoundaryPolygon rectangle;
+    const BoundaryPolygon* outline = &boundary.outline;
+    if (boundary.outline.IsEmpty()) {
+        const double xs[4] = { boundary.minX, boundary.maxX, boundary.maxX, boundary.minX };
+        const double ys[4] = { boundary.minY, boundary.minY, boundary.maxY, boundary.maxY };
+        if (!rectangle.SetVertices(xs, ys, 4)) {
+            return;
+        }
+        outline = &rectangle;
+    }
+    
+    std::vector<std::uint32_t> rows;
+    GetSnapshotRows(boundary.minX, boundary.minY, boundary.maxX, boundary.maxY, rows);
+    
+    for (std::uint32_t row : rows) {
+        EntityDelta::Measure measure = BoundaryClipper::ClipEntity(*m_snapshot, row, *outline);
+        if (measure.length <= 0.0 && measure.area <= 0.0 && measure.count <= 0.0) {
+            continue;
+        }
+        
+        QuantityEngine::ColorTotals& bucket = totals[measure.colorIndex];
+        bucket.linearFeet += measure.length;
+        bucket.squareFeet += measure.area;
+        bucket.each += measure.count;
+        bucket.entityCount++;
+    }
+}
+
+void BoundaryVersionManager::ClipPartitionCells(int region, BoundaryTotals& totals) const {
+    // A cell is its outline minus its holes; an entity may touch several cells of one boundary,
+    // so shares are gathered per row and each entity is counted once
+    std::vector<std::pair<std::uint32_t, EntityDelta::Measure>> shares;
+    std::vector<std::uint32_t> rows;
+    for (std::uint32_t cellIndex : m_partition->GetCellsOwnedBy(region)) {
+        const BoundaryPartition::Cell& cell = m_partition->GetCell(cellIndex);
+        GetSnapshotRows(cell.shape.GetMinX(), cell.shape.GetMinY(), cell.shape.GetMaxX(), cell.shape.GetMaxY(), rows);
+        
+        for (std::uint32_t row : rows) {
+            EntityDelta::Measure measure = BoundaryClipper::ClipEntity(*m_snapshot, row, cell.shape);
+            if (measure.length <= 0.0 && measure.area <= 0.0 && measure.count <= 0.0) {
+                continue;
+            }
+            for (std::uint32_t hole : cell.holes) {
+                const EntityDelta::Measure inHole = BoundaryClipper::ClipEntity(*m_snapshot, row, m_partition->GetCell(hole).shape);
+                measure.length -= inHole.length;
+                measure.area -= inHole.area;
+                measure.count -= inHole.count;
+            }
+            shares.push_back(std::make_pair(row, measure));
+        }
+    }
+    
+    std::sort(shares.begin(), shares.end(),
+              [](const std::pair<std::uint32_t, EntityDelta::Measure>& a,
+                 const std::pair<std::uint32_t, EntityDelta::Measure>& b) { return a.first < b.first; });
+    
+    // Hole subtraction leaves rounding residue on entities that are wholly inside a hole
+    const double kResidue = 1e-9;
+    for (size_t i = 0; i < shares.size();) {
+        EntityDelta::Measure measure = shares[i].second;
+        size_t next = i + 1;
+        for (; next < shares.size() && shares[next].first == shares[i].first; ++next) {
+            measure.length += shares[next].second.length;
+            measure.area += shares[next].second.area;
+            measure.count += shares[next].second.count;
+        }
+        i = next;
+        
+        if (measure.length <= kResidue && measure.area <= kResidue && measure.count <= kResidue) {
+            continue;
+        }
+        QuantityEngine::ColorTotals& bucket = totals[measure.colorIndex];
+        bucket.linearFeet += std::max(measure.length, 0.0);
+        bucket.squareFeet += std::max(measure.area, 0.0);
+        bucket.each += std::max(measure.count, 0.0);
+        bucket.entityCount++;
+    }
+}
+
+void BoundaryVersionManager::GetSnapshotRows(double minX, double minY, double maxX, double maxY,
+                                             std::vector<std::uint32_t>& rows) const {
+    rows.clear();
+    
+    // Only entities whose boxes overlap the region are clipped
+    if (m_entityIndex) {
+        std::vector<std::uint64_t> candidates;
+        m_entityIndex->Query(EntitySpatialIndex::Box(minX, minY, maxX, maxY), candidates);
+        rows.reserve(candidates.size());
+        for (std::uint64_t handle : candidates) {
+            auto rowIt = m_snapshotRowOf.find(handle);
+            if (rowIt != m_snapshotRowOf.end()) {
+                rows.push_back(rowIt->second);
+            }
+        }
+        std::sort(rows.begin(), rows.end());
+    } else {
+        rows.resize(m_snapshot->GetEntityCount());
+        for (size_t row = 0; row < rows.size(); ++row) {
+            rows[row] = static_cast<std::uint32_t>(row);
+        }
+    }
+}
+
 bool BoundaryVersionManager::SaveBoundaries(const std::string& filePath) const {
-    // Placeholder implementation - would save to file
-    return false;
+    BoundaryFileWriter writer;
+    for (const auto& entry : m_boundaries) {
+        writer.Add(entry.second);
+    }
+    return writer.WriteTo(filePath);
 }
 
 bool BoundaryVersionManager::LoadBoundaries(const std::string& filePath) {
-    // Placeholder implementation - would load from file
-    return false;
+    BoundaryFileView view;
+    if (!view.Open(filePath)) {
+        return false;
+    }
+    
+    // Build into a fresh map so a rejected file leaves the current boundaries untouched
+    std::map<std::string, BoundaryBox> boundaries;
+    for (size_t i = 0; i < view.GetBoundaryCount(); ++i) {
+        const BoundaryFile::BoundaryRecord& record = view.GetRecord(i);
+        
+        BoundaryBox boundary;
+        boundary.name = InternedName(std::string_view(view.GetString(record.nameOffset), record.nameLength));
+        boundary.attachmentPlan = InternedName(std::string_view(view.GetString(record.planOffset), record.planLength));
+        boundary.isActive = (record.flags & BoundaryFile::kActive) != 0;
+        boundary.priority = record.priority;
+        for (int w = 0; w < ColorMask::kWordCount; ++w) boundary.baseColors.SetWord(w, record.baseColors[w]);
+        
+        const BoundaryFile::VersionColorRecord* versionColors = view.GetVersionColors(record);
+        for (std::uint32_t c = 0; c < record.versionColorCount; ++c) {
+            ColorMask& colors = boundary.versionColors[static_cast<char>(versionColors[c].component)];
+            for (int w = 0; w < ColorMask::kWordCount; ++w) colors.SetWord(w, versionColors[c].colors[w]);
+        }
+        
+        boundary.hasExtents = (record.flags & BoundaryFile::kHasExtents) != 0;
+        boundary.minX = record.minX;
+        boundary.minY = record.minY;
+        boundary.minZ = record.minZ;
+        boundary.maxX = record.maxX;
+        boundary.maxY = record.maxY;
+        boundary.maxZ = record.maxZ;
+        if (record.vertexCount > 0 &&
+            !boundary.outline.SetVertices(view.GetVertexX(record), view.GetVertexY(record),
+                                          static_cast<size_t>(record.vertexCount))) {
+            return false;   // A degenerate outline would load as an extents-only boundary
+        }
+#ifndef BUILDING_TESTS
+#if HAS_BRX_SDK
+        boundary.minPoint = AcGePoint3d(boundary.minX, boundary.minY, boundary.minZ);
+        boundary.maxPoint = AcGePoint3d(boundary.maxX, boundary.maxY, boundary.maxZ);
+#endif
+#endif
+        
+        if (record.versionLength > 0) {
+            UpdateActiveColors(boundary, std::string(view.GetString(record.versionOffset), record.versionLength));
+        }
+        if (!boundaries.insert(std::make_pair(boundary.name.str(), boundary)).second) {
+            return false;   // Duplicate names mean the file was not written by SaveBoundaries
+        }
+    }
+    
+    m_boundaries.swap(boundaries);
+    RebuildPartition();
+    return true;
+}
+
+bool BoundaryVersionManager::IsCenterInExtents(const BoundaryBox& boundary, double x, double y) const {
+    if (!boundary.outline.IsEmpty()) {
+        return boundary.outline.Contains(x, y);
+    }
+    return x >= boundary.minX && x <= boundary.maxX &&
+           y >= boundary.minY && y <= boundary.maxY;
+}
+
+bool BoundaryVersionManager::IsCenterOwned(const BoundaryBox& boundary, double x, double y) const {
+    const int region = GetPartitionRegion(boundary);
+    return (region >= 0) ? m_partition->Locate(x, y) == region : IsCenterInExtents(boundary, x, y);
+}
+
+void BoundaryVersionManager::EnsurePartition() const {
+    if (m_overlapMode != OverlapMode::Priority || m_partitionValid.load(std::memory_order_acquire)) {
+        return;
+    }
+    
+    // Only stale after edits through GetBoundary - concurrent queries wait for one rebuild
+    std::lock_guard<std::mutex> lock(m_partitionMutex);
+    if (m_partitionValid.load(std::memory_order_relaxed)) {
+        return;
+    }
+    
+    // Regions follow map (name) order so GetPartitionRegion can binary search them
+    m_partitionRegions.clear();
+    for (const auto& pair : m_boundaries) {
+        if (pair.second.isActive && pair.second.hasExtents) {
+            m_partitionRegions.push_back(&pair.second);
+        }
+    }
+    
+    std::vector<BoundaryPolygon> rectangles(m_partitionRegions.size());
+    std::vector<const BoundaryPolygon*> regions;
+    std::vector<int> priorities;
+    regions.reserve(m_partitionRegions.size());
+    priorities.reserve(m_partitionRegions.size());
+    for (size_t i = 0; i < m_partitionRegions.size(); ++i) {
+        const BoundaryBox& boundary = *m_partitionRegions[i];
+        if (boundary.outline.IsEmpty()) {
+            const double xs[4] = { boundary.minX, boundary.maxX, boundary.maxX, boundary.minX };
+            const double ys[4] = { boundary.minY, boundary.minY, boundary.maxY, boundary.maxY };
+            rectangles[i].SetVertices(xs, ys, 4);
+            regions.push_back(&rectangles[i]);
+        } else {
+            regions.push_back(&boundary.outline);
+        }
+        priorities.push_back(boundary.priority);
+    }
+    
+    m_partition->Build(regions, priorities);
+    m_partitionValid.store(true, std::memory_order_release);
+}
+
+int BoundaryVersionManager::GetPartitionRegion(const BoundaryBox& boundary) const {
+    if (m_overlapMode != OverlapMode::Priority || !boundary.isActive || !boundary.hasExtents) {
+        return -1;
+    }
+    EnsurePartition();
+    
+    auto it = std::lower_bound(m_partitionRegions.begin(), m_partitionRegions.end(), boundary.name.str(),
+                               [](const BoundaryBox* region, const std::string& name) { return region->name.str() < name; });
+    return (it != m_partitionRegions.end() && *it == &boundary)
+        ? static_cast<int>(it - m_partitionRegions.begin()) : -1;
+}
+
+void BoundaryVersionManager::FilterByCenter(const BoundaryBox& boundary,
+                                            const std::vector<std::uint64_t>& candidates,
+                                            std::vector<std::uint64_t>& handles) const {
+    std::vector<std::uint64_t> known;
+    std::vector<double> centerX, centerY;
+    known.reserve(candidates.size());
+    centerX.reserve(candidates.size());
+    centerY.reserve(candidates.size());
+    for (std::uint64_t handle : candidates) {
+        EntitySpatialIndex::Box box;
+        if (m_entityIndex->GetBox(handle, box)) {
+            known.push_back(handle);
+            centerX.push_back(0.5 * (box.minX + box.maxX));
+            centerY.push_back(0.5 * (box.minY + box.maxY));
+        }
+    }
+    
+    // Partitioned boundaries keep the centers whose owning cell is theirs
+    const int region = GetPartitionRegion(boundary);
+    if (region >= 0) {
+        std::vector<int> owners(known.size());
+        m_partition->LocatePoints(centerX.data(), centerY.data(), known.size(), owners.data());
+        for (size_t i = 0; i < known.size(); ++i) {
+            if (owners[i] == region) {
+                handles.push_back(known[i]);
+            }
+        }
+        return;
+    }
+    
+    if (boundary.outline.IsEmpty()) {
+        for (size_t i = 0; i < known.size(); ++i) {
+            if (IsCenterInExtents(boundary, centerX[i], centerY[i])) {
+                handles.push_back(known[i]);
+            }
+        }
+        return;
+    }
+    
+    // Polygon boundaries test all centers in one batch
+    std::vector<std::uint8_t> inside(known.size());
+    boundary.outline.ContainsPoints(centerX.data(), centerY.data(), known.size(), inside.data());
+    for (size_t i = 0; i < known.size(); ++i) {
+        if (inside[i]) {
+            handles.push_back(known[i]);
+        }
+    }
 }
 
 bool BoundaryVersionManager::ValidateBoundaryName(const std::string& name) const {
@@ -195,8 +1122,54 @@ bool BoundaryVersionManager::ValidateBoundaryName(const std::string& name) const
 }
 
 void BoundaryVersionManager::UpdateActiveColors(BoundaryBox& boundary, const std::string& activeVersion) {
-    // Implementation would update the active color set based on version
-    // This is called when switching between AGS variations
+    boundary.activeVersion = activeVersion;
+    
+    const int code = GetElevationCodeIndex(activeVersion);
+    if (code >= 0) {
+        boundary.activeColors = ResolveVersionColors(boundary, code);
+    } else {
+        boundary.activeColors = (activeVersion.length() < 3) ? ColorMask()
+                                                             : ComposeVersionColors(boundary, activeVersion);
+    }
+}
+
+const ColorMask& BoundaryVersionManager::ResolveVersionColors(const BoundaryBox& boundary, int codeIndex) const {
+    const std::uint16_t bit = static_cast<std::uint16_t>(1u << codeIndex);
+    if (!(boundary.resolvedValid & bit)) {
+        boundary.resolvedColors[codeIndex] = ComposeVersionColors(boundary, kElevationCodes[codeIndex]);
+        boundary.resolvedValid |= bit;
+    }
+    return boundary.resolvedColors[codeIndex];
+}
+
+ColorMask BoundaryVersionManager::ComposeVersionColors(const BoundaryBox& boundary, const std::string& version) {
+    ColorMask activeColors = boundary.baseColors;
+    
+    // Apply version-specific colors
+    char frameType = version[0];  // A or H
+    char garageType = version[1]; // G or N  
+    char sidingType = version[2]; // S, H, or B
+    
+    // Add colors for active version components
+    for (char component : { frameType, garageType, sidingType }) {
+        auto componentIt = boundary.versionColors.find(component);
+        if (componentIt != boundary.versionColors.end()) {
+            activeColors |= componentIt->second;
+        }
+    }
+    
+    return activeColors;
+}
+
+std::uint16_t BoundaryVersionManager::GetCodesUsingComponent(char versionComponent) {
+    std::uint16_t codes = 0;
+    for (int code = 0; code < kElevationCodeCount; ++code) {
+        const char* letters = kElevationCodes[code];
+        if (letters[0] == versionComponent || letters[1] == versionComponent || letters[2] == versionComponent) {
+            codes |= static_cast<std::uint16_t>(1u << code);
+        }
+    }
+    return codes;
 }
 
 } // namespace EnhancedTakeoff
\ No newline at end of file
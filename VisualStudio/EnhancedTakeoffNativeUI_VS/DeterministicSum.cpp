@@ -0,0 +1,78 @@
+// DeterministicSum.cpp - Order-independent summation for quantities and costs
+// Enhanced Construction Takeoff - BricsCAD V25 Plugin
+// COPILOT-HINT: Integer addition is exact, so the partition used by worker threads never matters
+
+#include "pch.h"
+#include "DeterministicSum.h"
+
+#include <algorithm>
+#include <cmath>
+#include <thread>
+#include <vector>
+
+namespace EnhancedTakeoff {
+
+namespace {
+    // Largest magnitude that still fits in micro-units (about 9.2 trillion)
+    const double kMaxWhole = 9.0e12;
+
+    const size_t kMinValuesPerThread = 65536;
+}
+
+std::int64_t DeterministicSum::GetCents() const {
+    const std::int64_t unitsPerCent = kUnitsPerWhole / 100;
+    const std::int64_t half = unitsPerCent / 2;
+    return (m_units >= 0) ? (m_units + half) / unitsPerCent
+                          : -((-m_units + half) / unitsPerCent);
+}
+
+std::int64_t DeterministicSum::ToUnits(double value) {
+    // Non-finite or absurd values would poison the total - drop them
+    if (!std::isfinite(value) || std::fabs(value) > kMaxWhole) return 0;
+    return static_cast<std::int64_t>(std::llround(value * kUnitsPerWhole));
+}
+
+double DeterministicSum::Sum(const double* values, size_t count, unsigned int threadCount) {
+    if (count == 0) return 0.0;
+
+    if (threadCount == 0) {
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+    threadCount = static_cast<unsigned int>(
+        std::min<size_t>(threadCount, (count + kMinValuesPerThread - 1) / kMinValuesPerThread));
+
+    if (threadCount <= 1) {
+        DeterministicSum total;
+        for (size_t i = 0; i < count; ++i) {
+            total.Add(values[i]);
+        }
+        return total.GetValue();
+    }
+
+    std::vector<DeterministicSum> partials(threadCount);
+    std::vector<std::thread> threads;
+    threads.reserve(threadCount);
+    const size_t perThread = (count + threadCount - 1) / threadCount;
+    for (unsigned int t = 0; t < threadCount; ++t) {
+        const size_t begin = std::min(count, t * perThread);
+        const size_t end = std::min(count, begin + perThread);
+        threads.emplace_back([&partials, values, begin, end, t]() {
+            DeterministicSum local;
+            for (size_t i = begin; i < end; ++i) {
+                local.Add(values[i]);
+            }
+            partials[t] = local;
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    DeterministicSum total;
+    for (const auto& partial : partials) {
+        total.Merge(partial);
+    }
+    return total.GetValue();
+}
+
+} // namespace EnhancedTakeoff
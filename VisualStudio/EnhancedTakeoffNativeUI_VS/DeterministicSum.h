@@ -0,0 +1,39 @@
+// DeterministicSum.h - Order-independent summation for quantities and costs
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace EnhancedTakeoff {
+
+/**
+ * Fixed-point accumulator (millionths of a unit in a 64-bit integer)
+ * Each addend is rounded once to a micro-unit, after which addition is exact and
+ * associative - totals are identical for any ordering, thread count or add/remove history
+ * COPILOT-HINT: Use for anything an estimator compares across runs (cost totals, feeder sheet values)
+ */
+class DeterministicSum {
+public:
+    static const std::int64_t kUnitsPerWhole = 1000000;
+
+    DeterministicSum() : m_units(0) {}
+
+    void Add(double value) { m_units += ToUnits(value); }
+    void Subtract(double value) { m_units -= ToUnits(value); }
+    void Merge(const DeterministicSum& other) { m_units += other.m_units; }
+    void Reset() { m_units = 0; }
+
+    double GetValue() const { return static_cast<double>(m_units) / kUnitsPerWhole; }
+    std::int64_t GetRawUnits() const { return m_units; }
+    std::int64_t GetCents() const;     // Rounded half away from zero
+    bool IsZero() const { return m_units == 0; }
+
+    // Parallel reduction over a column of values (0 threads = hardware concurrency)
+    static double Sum(const double* values, size_t count, unsigned int threadCount = 0);
+    static std::int64_t ToUnits(double value);
+
+private:
+    std::int64_t m_units;
+};
+
+} // namespace EnhancedTakeoff
@@ -9,6 +9,10 @@
 #include <memory>
 #include <vector>
 #include <map>
+#include <string>
+
+#include "QuantityRowModel.h"
+#include "QuantityEngine.h"
 
 // Forward declarations
 namespace EnhancedTakeoff {
@@ -16,6 +20,11 @@ namespace EnhancedTakeoff {
     class AttachmentManager;
     class BoundaryVersionManager;
     class FeederSheetManager;
+    class QuantityEngine;
+    class EntityDeltaFeed;
+    class EntitySnapshotStore;
+    class EntitySpatialIndex;
+    class ColorMask;
 }
 
 /**
@@ -50,6 +59,7 @@ public:
     afx_msg void OnAreaSelChange();
     afx_msg void OnPlanSelChange();
     afx_msg void OnElevationSelChange();
+    afx_msg void OnMaterialTextChange();
     afx_msg void OnAutoRefreshToggle();
     afx_msg void OnTimer(UINT_PTR nIDEvent);
     
@@ -62,11 +72,15 @@ public:
     afx_msg void OnVersionSelChange();
 
     // Additional message handlers referenced in implementation
-    afx_msg void OnColorAssignmentChanged(int colorIndex);
+    afx_msg void OnColorAssignmentChanged(const ColorMask& changedColors);
     afx_msg void OnAssignToBoundary();
     afx_msg void OnToggleAttachment();
     afx_msg void OnColorListSelChange();
     afx_msg void OnExcelCellChange();
+    
+    // Boundary checkboxes - changes arriving in one burst are applied as a single batch
+    afx_msg void OnBoundaryCheck(NMHDR* pNMHDR, LRESULT* pResult);
+    afx_msg LRESULT OnApplyBoundaryChanges(WPARAM wParam, LPARAM lParam);
 
 private:
     // Core managers - flexible system
@@ -75,6 +89,21 @@ private:
     std::unique_ptr<EnhancedTakeoff::BoundaryVersionManager> m_pBoundaryMgr;
     std::unique_ptr<EnhancedTakeoff::FeederSheetManager> m_pFeederSheet;
     
+    // Incremental quantities - fed by drawing change deltas instead of full rescans
+    std::unique_ptr<EnhancedTakeoff::QuantityEngine> m_pQuantityEngine;
+    std::unique_ptr<EnhancedTakeoff::EntityDeltaFeed> m_pDeltaFeed;
+    
+    // While any boundary is checked, quantities are the clipped totals of the checked boundaries
+    // COPILOT-HINT: The snapshot is recaptured only when the engine revision moved since the last capture
+    std::unique_ptr<EnhancedTakeoff::EntitySnapshotStore> m_pSnapshot;
+    std::unique_ptr<EnhancedTakeoff::EntitySpatialIndex> m_pEntityIndex;
+    std::uint64_t m_snapshotRevision;
+    std::map<int, EnhancedTakeoff::QuantityEngine::ColorTotals> m_boundaryTotals;   // Color -> summed over boundaries
+    bool m_useBoundaryTotals;
+    
+    // Rows currently shown in m_quantityList - refreshes only touch changed cells
+    std::unique_ptr<EnhancedTakeoff::QuantityRowModel> m_pQuantityRows;
+    
     // UI Controls that are referenced in the implementation
     CComboBox m_areaCombo;
     CComboBox m_planCombo;
@@ -99,6 +128,10 @@ private:
     // State variables
     bool m_autoRefreshEnabled;
     UINT_PTR m_refreshTimerID;
+    bool m_quantitiesStale;           // Assignments changed since last refresh
+    std::map<std::string, bool> m_pendingBoundaryToggles;   // Boundary -> checked, not yet applied
+    bool m_boundaryApplyPosted;
+    bool m_syncingBoundaryTree;       // Checkbox changes made by the dialog itself are not user toggles
     std::string m_currentArea;        // Added missing member
     std::string m_currentPlan;        // Added missing member  
     std::string m_currentElevation;   // Added missing member
@@ -124,17 +157,21 @@ private:
     void UpdateQuantityDisplay();
     void InitializeDropdowns();
     void PopulateAreaCombo();
+    void PopulateMaterialCombo(const CString& typedText);   // One page of library matches
     void PopulatePlanCombo(const std::string& selectedArea);
     void PopulateElevationCombo(const std::string& selectedPlan);
     void InitializeColorList();
     void InitializeQuantityList();
     void InitializeAttachmentTree();
+    void PopulateBoundaryTree();      // Checkboxes follow each boundary's isActive
     void RefreshColorAssignments();
     void RefreshQuantityDisplay();
     void UpdateTotalCost();
     void ApplyElevationVariation(const std::string& elevationCode);
     void UpdateUIState();
-    void RefreshQuantities();
+    void RefreshQuantities(const EnhancedTakeoff::ColorMask* onlyColors = nullptr);   // null = every color
+    void UpdateBoundaryTotals(EnhancedTakeoff::ColorMask& changedColors);   // Adds colors whose totals moved
+    double GetRawQuantity(int colorIndex, EnhancedTakeoff::FlexibleColorAssignment::MeasurementType type) const;
     void UpdateColorList();
     
     // Helper methods referenced in implementation
@@ -144,4 +181,6 @@ private:
     bool GetAssignmentDetailsFromUser(EnhancedTakeoff::FlexibleColorAssignment::ColorAssignment& assignment);
     bool GetExcelPathFromUser(CString& excelPath);
     void UpdateTotalCostDisplay(double totalCost);
+    void ApplyQuantityRowChanges(const std::vector<EnhancedTakeoff::QuantityRowModel::Change>& changes);
+    CString FormatQuantityCell(const EnhancedTakeoff::QuantityRowModel::Row& row, int column);
 };
\ No newline at end of file
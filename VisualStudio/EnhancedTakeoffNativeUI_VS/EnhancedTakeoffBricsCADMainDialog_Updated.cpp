@@ -5,9 +5,15 @@
 #include "pch.h"
 #include "EnhancedTakeoffBricsCADMainDialog.h"
 #include "FlexibleColorAssignment.h"
+#include "MaterialLibrary.h"
 #include "AttachmentManager.h"
 #include "BoundaryVersionManager.h"
 #include "FeederSheetManager.h"
+#include "QuantityEngine.h"
+#include "EntitySnapshotStore.h"
+#include "EntitySpatialIndex.h"
+#include "DeterministicSum.h"
+#include "ColorMask.h"
 
 #ifdef HAS_BRX_SDK
 #include "acedads.h"
@@ -18,6 +24,19 @@
 
 using namespace EnhancedTakeoff;
 
+namespace {
+    // Posted once per burst of boundary checkbox changes
+    const UINT WM_APPLY_BOUNDARY_CHANGES = WM_APP + 1;
+    
+    // Material dropdown rows per keystroke - the library itself may hold tens of thousands of SKUs
+    const size_t kMaterialComboPageSize = 50;
+    
+    bool SameTotals(const QuantityEngine::ColorTotals& a, const QuantityEngine::ColorTotals& b) {
+        return a.linearFeet == b.linearFeet && a.squareFeet == b.squareFeet &&
+               a.each == b.each && a.entityCount == b.entityCount;
+    }
+}
+
 IMPLEMENT_DYNAMIC(CEnhancedTakeoffBricsCADMainDialog, CDialogEx)
 
 BEGIN_MESSAGE_MAP(CEnhancedTakeoffBricsCADMainDialog, CDialogEx)
@@ -28,7 +47,10 @@ BEGIN_MESSAGE_MAP(CEnhancedTakeoffBricsCADMainDialog, CDialogEx)
     ON_CBN_SELCHANGE(IDC_AREA_COMBO, &CEnhancedTakeoffBricsCADMainDialog::OnAreaSelChange)
     ON_CBN_SELCHANGE(IDC_PLAN_COMBO, &CEnhancedTakeoffBricsCADMainDialog::OnPlanSelChange)
     ON_CBN_SELCHANGE(IDC_ELEVATION_COMBO, &CEnhancedTakeoffBricsCADMainDialog::OnElevationSelChange)
+    ON_CBN_EDITCHANGE(IDC_MATERIAL_TYPE_COMBO, &CEnhancedTakeoffBricsCADMainDialog::OnMaterialTextChange)
     ON_BN_CLICKED(IDC_AUTO_REFRESH_CHECK, &CEnhancedTakeoffBricsCADMainDialog::OnAutoRefreshToggle)
+    ON_NOTIFY(TVN_ITEMCHANGED, IDC_BOUNDARY_TREE, &CEnhancedTakeoffBricsCADMainDialog::OnBoundaryCheck)
+    ON_MESSAGE(WM_APPLY_BOUNDARY_CHANGES, &CEnhancedTakeoffBricsCADMainDialog::OnApplyBoundaryChanges)
     ON_WM_TIMER()
     
     // Legacy method mappings for compatibility
@@ -45,6 +67,11 @@ CEnhancedTakeoffBricsCADMainDialog::CEnhancedTakeoffBricsCADMainDialog(CWnd* pPa
     : CDialogEx(IDD_ENHANCED_TAKEOFF_MAIN, pParent)
     , m_autoRefreshEnabled(false)
     , m_refreshTimerID(0)
+    , m_quantitiesStale(true)
+    , m_boundaryApplyPosted(false)
+    , m_syncingBoundaryTree(false)
+    , m_snapshotRevision(UINT64_MAX)
+    , m_useBoundaryTotals(false)
     , m_currentArea("")
     , m_currentPlan("")
     , m_currentElevation("")
@@ -54,6 +81,20 @@ CEnhancedTakeoffBricsCADMainDialog::CEnhancedTakeoffBricsCADMainDialog(CWnd* pPa
     m_pAttachmentMgr = std::make_unique<AttachmentManager>();
     m_pBoundaryMgr = std::make_unique<BoundaryVersionManager>();
     m_pFeederSheet = std::make_unique<FeederSheetManager>();
+    
+    // Quantities are maintained incrementally from entity add/modify/erase deltas
+    m_pQuantityEngine = std::make_unique<QuantityEngine>();
+    m_pQuantityRows = std::make_unique<QuantityRowModel>();
+    m_pSnapshot = std::make_unique<EntitySnapshotStore>();
+    m_pEntityIndex = std::make_unique<EntitySpatialIndex>();
+#if HAS_BRX_SDK
+    auto pReactor = std::make_unique<DatabaseDeltaReactor>(
+        acdbHostApplicationServices()->workingDatabase());
+    pReactor->SeedFromDatabase();
+    m_pDeltaFeed = std::move(pReactor);
+#else
+    m_pDeltaFeed = std::make_unique<InMemoryDeltaFeed>();
+#endif
 }
 
 CEnhancedTakeoffBricsCADMainDialog::~CEnhancedTakeoffBricsCADMainDialog()
@@ -70,9 +111,19 @@ BOOL CEnhancedTakeoffBricsCADMainDialog::OnInitDialog()
     // Initialize elevation variations (AGS system)
     InitializeElevationVariations();
     
-    // Set up flexible color assignment callbacks
-    m_pColorAssignment->RegisterColorChangeCallback(
-        [this](int colorIndex) { OnColorAssignmentChanged(colorIndex); }
+    // Set up flexible color assignment callbacks - coalesced, so a preset load refreshes once
+    m_pColorAssignment->RegisterColorMaskCallback(
+        [this](const ColorMask& changedColors) { OnColorAssignmentChanged(changedColors); }
+    );
+    
+    // A batch of boundary toggles/version switches refreshes only the colors it touched
+    m_pBoundaryMgr->RegisterChangeCallback(
+        [this](const ColorMask& affectedColors) {
+            m_quantitiesStale = true;
+            if (m_autoRefreshEnabled) {
+                RefreshQuantities(&affectedColors);
+            }
+        }
     );
     
     // Initialize UI in logical order: Project Setup -> Color Assignment -> Live Monitoring
@@ -80,6 +131,7 @@ BOOL CEnhancedTakeoffBricsCADMainDialog::OnInitDialog()
     InitializeColorList();
     InitializeQuantityList();
     InitializeAttachmentTree();
+    PopulateBoundaryTree();
     
     // Set window title
     SetWindowText(_T("Enhanced Construction Takeoff - BricsCAD V25 (Flexible System)"));
@@ -96,6 +148,7 @@ void CEnhancedTakeoffBricsCADMainDialog::DoDataExchange(CDataExchange* pDX)
     DDX_Control(pDX, IDC_COLOR_LIST, m_colorList);
     DDX_Control(pDX, IDC_QUANTITY_LIST, m_quantityList);
     DDX_Control(pDX, IDC_ATTACHMENT_TREE, m_attachmentTree);
+    DDX_Control(pDX, IDC_BOUNDARY_TREE, m_boundaryTree);
     DDX_Control(pDX, IDC_MATERIAL_TYPE_COMBO, m_materialTypeCombo);
     DDX_Control(pDX, IDC_EXCEL_CELL_EDIT, m_excelCellEdit);
     DDX_Control(pDX, IDC_UNIT_COST_EDIT, m_unitCostEdit);
@@ -136,7 +189,7 @@ void CEnhancedTakeoffBricsCADMainDialog::OnPickColor()
         // Get user-defined material details from UI controls
         CString materialName;
         m_materialTypeCombo.GetWindowText(materialName);
-        assignment.materialName = CT2A(materialName);
+        assignment.materialName = std::string(CT2A(materialName));
         
         CString unitCostText;
         m_unitCostEdit.GetWindowText(unitCostText);
@@ -190,7 +243,7 @@ void CEnhancedTakeoffBricsCADMainDialog::OnMatchColor()
             // Let user define what this color represents
             CString materialName;
             if (GetMaterialNameFromUser(materialName)) {
-                assignment.materialName = CT2A(materialName);
+                assignment.materialName = std::string(CT2A(materialName));
                 
                 // Get additional details from user
                 if (GetAssignmentDetailsFromUser(assignment)) {
@@ -253,6 +306,13 @@ void CEnhancedTakeoffBricsCADMainDialog::OnElevationSelChange()
     }
 }
 
+void CEnhancedTakeoffBricsCADMainDialog::OnMaterialTextChange()
+{
+    CString typedText;
+    m_materialTypeCombo.GetWindowText(typedText);
+    PopulateMaterialCombo(typedText);
+}
+
 void CEnhancedTakeoffBricsCADMainDialog::ApplyElevationVariation(const std::string& elevationCode)
 {
     if (elevationCode.length() < 3) return;
@@ -272,53 +332,236 @@ void CEnhancedTakeoffBricsCADMainDialog::OnRefreshQuantities()
     AfxMessageBox(_T("Quantities refreshed successfully!"));
 }
 
-void CEnhancedTakeoffBricsCADMainDialog::RefreshQuantities()
+void CEnhancedTakeoffBricsCADMainDialog::RefreshQuantities(const ColorMask* onlyColors)
 {
-    m_quantityList.DeleteAllItems();
+    // Fold in any drawing changes queued since the last refresh
+    m_pQuantityEngine->Pump(*m_pDeltaFeed);
+    
+    // Checked boundaries replace the whole-drawing totals
+    ColorMask boundaryColors;
+    UpdateBoundaryTotals(boundaryColors);
+    
+    // A partial refresh still picks up colors the drawing or the boundary clipping changed
+    ColorMask refreshColors;
+    if (onlyColors) {
+        refreshColors = ColorMask(m_pQuantityEngine->TakeDirtyColors());
+        refreshColors |= *onlyColors;
+        refreshColors |= boundaryColors;
+    }
     
     // Calculate quantities based on active colors and boundaries
     auto assignments = m_pColorAssignment->GetAllAssignments();
     
-    int row = 0;
-    double totalCost = 0.0;
+    // Rows outside a partial refresh keep what is displayed; both lists ascend by color
+    const std::vector<QuantityRowModel::Row>& shownRows = m_pQuantityRows->GetRows();
+    auto shownIt = shownRows.begin();
+    std::vector<const QuantityRowModel::Row*> keptRows;
+    keptRows.reserve(assignments.size());
+    
+    // Gather raw engine totals for every recomputed color, then price them in one batch
+    std::vector<int> colors;
+    std::vector<double> rawValues;
+    std::vector<FlexibleColorAssignment::MeasurementType> types;
+    colors.reserve(assignments.size());
+    rawValues.reserve(assignments.size());
+    types.reserve(assignments.size());
     
     for (const auto& assignment : assignments) {
         if (assignment.isActive) {
-            // Calculate quantities for this color
-            double quantity = CalculateColorQuantity(assignment.colorIndex);
-            double cost = m_pColorAssignment->CalculateCost(assignment.colorIndex, quantity);
-            
-            CString colorStr;
-            colorStr.Format(_T("%d"), assignment.colorIndex);
-            m_quantityList.InsertItem(row, colorStr);
-            
-            m_quantityList.SetItemText(row, 1, CString(assignment.materialName.c_str()));
-            
-            CString qtyStr;
-            qtyStr.Format(_T("%.2f"), quantity);
-            m_quantityList.SetItemText(row, 2, qtyStr);
-            
-            // Show measurement unit
-            if (!assignment.measurementTypes.empty()) {
-                CString unitStr = GetMeasurementTypeString(assignment.measurementTypes[0]);
-                m_quantityList.SetItemText(row, 3, unitStr);
+            while (shownIt != shownRows.end() && shownIt->colorIndex < assignment.colorIndex) ++shownIt;
+            if (onlyColors && !refreshColors.Test(assignment.colorIndex) &&
+                shownIt != shownRows.end() && shownIt->colorIndex == assignment.colorIndex) {
+                keptRows.push_back(&*shownIt);
+                continue;
             }
+            keptRows.push_back(nullptr);
             
-            CString costStr;
-            costStr.Format(_T("$%.2f"), assignment.unitCost);
-            m_quantityList.SetItemText(row, 4, costStr);
+            FlexibleColorAssignment::MeasurementType type = assignment.measurementTypes.empty()
+                ? FlexibleColorAssignment::MeasurementType::LF : assignment.measurementTypes[0];
+            colors.push_back(assignment.colorIndex);
+            rawValues.push_back(GetRawQuantity(assignment.colorIndex, type));
+            types.push_back(type);
+        }
+    }
+    
+    FlexibleColorAssignment::QuantityBatch batch;
+    batch.colorIndices = colors.data();
+    batch.rawValues = rawValues.data();
+    batch.types = types.data();
+    batch.count = colors.size();
+    
+    std::vector<double> quantities(colors.size());
+    std::vector<double> costs(colors.size());
+    m_pColorAssignment->CalculateQuantities(batch, quantities.data());
+    m_pColorAssignment->CalculateCosts(colors.data(), quantities.data(), colors.size(), costs.data());
+    
+    std::vector<QuantityRowModel::Row> rows;
+    rows.reserve(keptRows.size());
+    DeterministicSum totalCost;   // Same total regardless of how the costs were produced
+    
+    size_t index = 0;
+    size_t activeIndex = 0;
+    for (const auto& assignment : assignments) {
+        if (assignment.isActive) {
+            if (const QuantityRowModel::Row* kept = keptRows[activeIndex++]) {
+                totalCost.Add(kept->totalCost);
+                rows.push_back(*kept);
+                continue;
+            }
             
-            CString totalStr;
-            totalStr.Format(_T("$%.2f"), cost);
-            m_quantityList.SetItemText(row, 5, totalStr);
+            QuantityRowModel::Row row;
+            row.colorIndex = assignment.colorIndex;
+            row.materialName = assignment.materialName;
+            row.quantity = quantities[index];
+            row.measurementType = assignment.measurementTypes.empty()
+                ? -1 : static_cast<int>(assignment.measurementTypes[0]);
+            row.unitCost = assignment.unitCost;
+            row.totalCost = costs[index];
             
-            totalCost += cost;
-            row++;
+            totalCost.Add(row.totalCost);
+            rows.push_back(row);
+            index++;
         }
     }
     
+    // Only touch the list items whose displayed values changed
+    ApplyQuantityRowChanges(m_pQuantityRows->Diff(rows));
+    
     // Update total cost display
-    UpdateTotalCostDisplay(totalCost);
+    UpdateTotalCostDisplay(totalCost.GetValue());
+    
+    if (!onlyColors) {
+        m_pQuantityEngine->TakeDirtyColors();
+    }
+    m_quantitiesStale = false;
+}
+
+void CEnhancedTakeoffBricsCADMainDialog::UpdateBoundaryTotals(ColorMask& changedColors)
+{
+    std::map<int, QuantityEngine::ColorTotals> previous;
+    previous.swap(m_boundaryTotals);
+    const bool wasUsingBoundaries = m_useBoundaryTotals;
+    m_useBoundaryTotals = false;
+    
+#if HAS_BRX_SDK
+    const BoundaryVersionManager& boundaries = *m_pBoundaryMgr;
+    for (const auto& name : boundaries.GetAllBoundaryNames()) {
+        const BoundaryVersionManager::BoundaryBox* pBoundary = boundaries.GetBoundary(name);
+        if (pBoundary->isActive && pBoundary->hasExtents) {
+            m_useBoundaryTotals = true;
+            break;
+        }
+    }
+    
+    if (m_useBoundaryTotals) {
+        // Clipping needs entity geometry - capture again only after the drawing changed
+        if (m_snapshotRevision != m_pQuantityEngine->GetRevision()) {
+            m_pSnapshot->CaptureFromDatabase(acdbHostApplicationServices()->workingDatabase());
+            m_pEntityIndex->BuildFromSnapshot(*m_pSnapshot);
+            m_pBoundaryMgr->SetEntityIndex(m_pEntityIndex.get());
+            m_pBoundaryMgr->SetEntitySnapshot(m_pSnapshot.get());
+            m_snapshotRevision = m_pQuantityEngine->GetRevision();
+        }
+        
+        // Straddling entities contribute only their inside part; overlaps count once in Priority mode
+        for (const auto& boundary : m_pBoundaryMgr->CalculateActiveBoundaryTotals()) {
+            for (const auto& color : boundary.second) {
+                QuantityEngine::ColorTotals& sum = m_boundaryTotals[color.first];
+                sum.linearFeet += color.second.linearFeet;
+                sum.squareFeet += color.second.squareFeet;
+                sum.each += color.second.each;
+                sum.entityCount += color.second.entityCount;
+            }
+        }
+    }
+#endif
+    
+    // Switching between whole-drawing and boundary totals moves every color
+    if (m_useBoundaryTotals != wasUsingBoundaries) {
+        changedColors |= ColorMask::All();
+        return;
+    }
+    for (const auto& entry : m_boundaryTotals) {
+        auto it = previous.find(entry.first);
+        if (it == previous.end() || !SameTotals(it->second, entry.second)) {
+            changedColors.Set(entry.first);
+        }
+    }
+    for (const auto& entry : previous) {
+        if (!m_boundaryTotals.count(entry.first)) {
+            changedColors.Set(entry.first);
+        }
+    }
+}
+
+double CEnhancedTakeoffBricsCADMainDialog::GetRawQuantity(int colorIndex,
+                                                          FlexibleColorAssignment::MeasurementType type) const
+{
+    if (!m_useBoundaryTotals) {
+        return m_pQuantityEngine->GetQuantity(colorIndex, type);
+    }
+    auto it = m_boundaryTotals.find(colorIndex);
+    return (it != m_boundaryTotals.end()) ? QuantityEngine::SelectQuantity(it->second, type) : 0.0;
+}
+
+void CEnhancedTakeoffBricsCADMainDialog::ApplyQuantityRowChanges(
+    const std::vector<QuantityRowModel::Change>& changes)
+{
+    if (changes.empty()) return;
+    
+    // Suppress repaints while several items change, then redraw once
+    m_quantityList.SetRedraw(FALSE);
+    for (const auto& change : changes) {
+        switch (change.op) {
+            case QuantityRowModel::Change::Op::Insert:
+                m_quantityList.InsertItem(change.position, FormatQuantityCell(change.row, QuantityRowModel::ColumnColor));
+                for (int column = QuantityRowModel::ColumnMaterial; column < QuantityRowModel::ColumnCount; ++column) {
+                    m_quantityList.SetItemText(change.position, column, FormatQuantityCell(change.row, column));
+                }
+                break;
+            case QuantityRowModel::Change::Op::Update:
+                for (int column = 0; column < QuantityRowModel::ColumnCount; ++column) {
+                    if (change.columnMask & (1u << column)) {
+                        m_quantityList.SetItemText(change.position, column, FormatQuantityCell(change.row, column));
+                    }
+                }
+                break;
+            case QuantityRowModel::Change::Op::Remove:
+                m_quantityList.DeleteItem(change.position);
+                break;
+        }
+    }
+    m_quantityList.SetRedraw(TRUE);
+    m_quantityList.Invalidate(FALSE);
+}
+
+CString CEnhancedTakeoffBricsCADMainDialog::FormatQuantityCell(const QuantityRowModel::Row& row, int column)
+{
+    CString text;
+    switch (column) {
+        case QuantityRowModel::ColumnColor:
+            text.Format(_T("%d"), row.colorIndex);
+            break;
+        case QuantityRowModel::ColumnMaterial:
+            text = CString(row.materialName.c_str());
+            break;
+        case QuantityRowModel::ColumnQuantity:
+            text.Format(_T("%.2f"), row.quantity);
+            break;
+        case QuantityRowModel::ColumnUnit:
+            // Show measurement unit
+            if (row.measurementType >= 0) {
+                text = GetMeasurementTypeString(row.measurementType);
+            }
+            break;
+        case QuantityRowModel::ColumnUnitCost:
+            text.Format(_T("$%.2f"), row.unitCost);
+            break;
+        case QuantityRowModel::ColumnTotalCost:
+            text.Format(_T("$%.2f"), row.totalCost);
+            break;
+    }
+    return text;
 }
 
 void CEnhancedTakeoffBricsCADMainDialog::OnExportExcel()
@@ -327,6 +570,12 @@ void CEnhancedTakeoffBricsCADMainDialog::OnExportExcel()
     CString excelPath;
     if (GetExcelPathFromUser(excelPath)) {
         if (m_pFeederSheet->ConnectToWorkbook(CT2A(excelPath))) {
+            // Export what the list shows - the checked boundaries' totals when any are checked.
+            // The partial refresh repaints the rows the drawing or the clipping changed, so the
+            // next refresh does not diff against totals the list never displayed
+            const ColorMask noOtherColors;
+            RefreshQuantities(&noOtherColors);
+            
             // Map colors to cells based on user assignments
             auto assignments = m_pColorAssignment->GetAllAssignments();
             
@@ -368,7 +617,11 @@ void CEnhancedTakeoffBricsCADMainDialog::OnAutoRefreshToggle()
 void CEnhancedTakeoffBricsCADMainDialog::OnTimer(UINT_PTR nIDEvent)
 {
     if (nIDEvent == m_refreshTimerID && m_autoRefreshEnabled) {
-        RefreshQuantities();
+        // Only rebuild when the drawing or the assignments actually changed
+        m_pQuantityEngine->Pump(*m_pDeltaFeed);
+        if (m_pQuantityEngine->HasChanges() || m_quantitiesStale) {
+            RefreshQuantities();
+        }
     }
     CDialogEx::OnTimer(nIDEvent);
 }
@@ -376,9 +629,15 @@ void CEnhancedTakeoffBricsCADMainDialog::OnTimer(UINT_PTR nIDEvent)
 // Helper methods implementation
 double CEnhancedTakeoffBricsCADMainDialog::CalculateColorQuantity(int colorIndex)
 {
-    // Placeholder calculation - real implementation would scan drawing for entities
-    // This would integrate with BricsCAD to calculate actual quantities
-    return 100.0 + (colorIndex * 10.0);
+    // Running totals come from the incremental engine (or the last boundary clip) - no drawing scan here
+    FlexibleColorAssignment::MeasurementType type = FlexibleColorAssignment::MeasurementType::LF;
+    const FlexibleColorAssignment::ColorAssignment* assignment = m_pColorAssignment->FindAssignment(colorIndex);
+    if (assignment && !assignment->measurementTypes.empty()) {
+        type = assignment->measurementTypes[0];
+    }
+    
+    double rawValue = GetRawQuantity(colorIndex, type);
+    return m_pColorAssignment->CalculateQuantity(colorIndex, rawValue, type);
 }
 
 bool CEnhancedTakeoffBricsCADMainDialog::GetMaterialNameFromUser(CString& materialName)
@@ -433,6 +692,7 @@ CString CEnhancedTakeoffBricsCADMainDialog::GetMeasurementTypeString(FlexibleCol
 void CEnhancedTakeoffBricsCADMainDialog::InitializeDropdowns() 
 {
     PopulateAreaCombo();
+    PopulateMaterialCombo(_T(""));
     // Plan and elevation combos are populated dynamically
 }
 
@@ -447,6 +707,37 @@ void CEnhancedTakeoffBricsCADMainDialog::PopulateAreaCombo()
     m_areaCombo.AddString(_T("Custom"));
 }
 
+void CEnhancedTakeoffBricsCADMainDialog::PopulateMaterialCombo(const CString& typedText)
+{
+    // Names starting with the text come straight out of the sorted library; typos fall back to fuzzy matches
+    const std::string query(CT2A(typedText));
+    const MaterialLibrary& library = m_pColorAssignment->GetMaterialLibrary();
+    const MaterialLibrary::View prefixMatches = library.FindPrefix(query).Page(0, kMaterialComboPageSize);
+    std::vector<MaterialLibrary::Match> fuzzyMatches;
+    if (prefixMatches.empty() && !query.empty()) {
+        library.FindFuzzy(query, kMaterialComboPageSize, fuzzyMatches);
+    }
+    
+    // ResetContent also clears the edit field - put back what the user typed and the caret
+    const DWORD editSel = m_materialTypeCombo.GetEditSel();
+    m_materialTypeCombo.SetRedraw(FALSE);
+    m_materialTypeCombo.ResetContent();
+    for (const auto& name : prefixMatches) {
+        m_materialTypeCombo.AddString(CString(name.c_str()));
+    }
+    for (const auto& match : fuzzyMatches) {
+        m_materialTypeCombo.AddString(CString(match.name.c_str()));
+    }
+    m_materialTypeCombo.SetWindowText(typedText);
+    m_materialTypeCombo.SetEditSel(LOWORD(editSel), HIWORD(editSel));
+    m_materialTypeCombo.SetRedraw(TRUE);
+    m_materialTypeCombo.Invalidate();
+    
+    if (!typedText.IsEmpty() && m_materialTypeCombo.GetCount() > 0) {
+        m_materialTypeCombo.ShowDropDown(TRUE);
+    }
+}
+
 void CEnhancedTakeoffBricsCADMainDialog::PopulatePlanCombo(const std::string& selectedArea)
 {
     m_planCombo.ResetContent();
@@ -506,6 +797,35 @@ void CEnhancedTakeoffBricsCADMainDialog::InitializeAttachmentTree()
     // Real implementation would populate with actual attachments
 }
 
+void CEnhancedTakeoffBricsCADMainDialog::PopulateBoundaryTree()
+{
+    // Checkbox state images are only created when the style is applied to an existing window
+    m_boundaryTree.ModifyStyle(TVS_CHECKBOXES, 0);
+    m_boundaryTree.ModifyStyle(0, TVS_CHECKBOXES);
+    
+    m_syncingBoundaryTree = true;
+    m_boundaryTree.SetRedraw(FALSE);
+    m_boundaryTree.DeleteAllItems();
+    
+    const std::vector<std::string> names = m_pBoundaryMgr->GetAllBoundaryNames();
+    if (!names.empty()) {
+        // Read through the const interface - the mutable GetBoundary marks the partition stale
+        const BoundaryVersionManager& boundaries = *m_pBoundaryMgr;
+        HTREEITEM hAll = m_boundaryTree.InsertItem(_T("All boundaries"));
+        bool allActive = true;
+        for (const auto& name : names) {
+            const bool active = boundaries.GetBoundary(name)->isActive;
+            m_boundaryTree.SetCheck(m_boundaryTree.InsertItem(CString(name.c_str()), hAll), active);
+            allActive = allActive && active;
+        }
+        m_boundaryTree.SetCheck(hAll, allActive);
+        m_boundaryTree.Expand(hAll, TVE_EXPAND);
+    }
+    
+    m_boundaryTree.SetRedraw(TRUE);
+    m_syncingBoundaryTree = false;
+}
+
 void CEnhancedTakeoffBricsCADMainDialog::UpdateColorList()
 {
     m_colorList.DeleteAllItems();
@@ -545,13 +865,66 @@ void CEnhancedTakeoffBricsCADMainDialog::UpdateUIState()
     // Update status or other UI elements as needed
 }
 
-void CEnhancedTakeoffBricsCADMainDialog::OnColorAssignmentChanged(int colorIndex)
+void CEnhancedTakeoffBricsCADMainDialog::OnColorAssignmentChanged(const ColorMask& changedColors)
 {
-    // Handle color assignment change
+    // Handle color assignment change - only the changed colors' quantity rows are rebuilt
+    m_quantitiesStale = true;
     UpdateColorList();
     if (m_autoRefreshEnabled) {
-        RefreshQuantities();
+        RefreshQuantities(&changedColors);
+    }
+}
+
+void CEnhancedTakeoffBricsCADMainDialog::OnBoundaryCheck(NMHDR* pNMHDR, LRESULT* pResult)
+{
+    *pResult = 0;
+    if (m_syncingBoundaryTree) {
+        return;
+    }
+    const NMTVITEMCHANGE* pChange = reinterpret_cast<const NMTVITEMCHANGE*>(pNMHDR);
+    if (!((pChange->uStateNew ^ pChange->uStateOld) & TVIS_STATEIMAGEMASK)) {
+        return;
+    }
+    
+    // State image 2 is the checked box
+    const bool checked = ((pChange->uStateNew & TVIS_STATEIMAGEMASK) >> 12) == 2;
+    
+    // Group items ("All boundaries") cascade to their children, whose notifications land here too
+    if (m_boundaryTree.ItemHasChildren(pChange->hItem)) {
+        for (HTREEITEM hChild = m_boundaryTree.GetChildItem(pChange->hItem); hChild;
+             hChild = m_boundaryTree.GetNextSiblingItem(hChild)) {
+            m_boundaryTree.SetCheck(hChild, checked);
+        }
+        return;
+    }
+    
+    m_pendingBoundaryToggles[std::string(CT2A(m_boundaryTree.GetItemText(pChange->hItem)))] = checked;
+    if (!m_boundaryApplyPosted) {
+        m_boundaryApplyPosted = PostMessage(WM_APPLY_BOUNDARY_CHANGES) != FALSE;
+    }
+}
+
+LRESULT CEnhancedTakeoffBricsCADMainDialog::OnApplyBoundaryChanges(WPARAM, LPARAM)
+{
+    m_boundaryApplyPosted = false;
+    if (m_pendingBoundaryToggles.empty()) {
+        return 0;
+    }
+    
+    BoundaryVersionManager::ChangeSet changes;
+    for (const auto& toggle : m_pendingBoundaryToggles) {
+        changes.Toggle(toggle.first, toggle.second);
+    }
+    
+    // One ApplyChanges call -> one change callback -> one refresh
+    const bool applied = m_pBoundaryMgr->ApplyChanges(changes);
+    m_pendingBoundaryToggles.clear();
+    if (!applied) {
+        // Nothing was applied - put every checkbox back to its boundary's actual state
+        PopulateBoundaryTree();
+        AfxMessageBox(_T("Boundary selection could not be applied - a checked item no longer exists."));
     }
+    return 0;
 }
 
 // Legacy compatibility method implementations
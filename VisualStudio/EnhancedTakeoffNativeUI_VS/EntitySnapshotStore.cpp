@@ -0,0 +1,575 @@
+// EntitySnapshotStore.cpp - Columnar entity snapshot implementation
+// Enhanced Construction Takeoff - BricsCAD V25 Plugin
+// COPILOT-HINT: Keep the hot loops branch-light - they run over every entity in the plan
+
+#include "pch.h"
+#include "EntitySnapshotStore.h"
+#include "MeasurementKernels.h"
+#include "BoundaryPolygon.h"
+
+#include <cmath>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+#ifndef BUILDING_TESTS
+#if HAS_BRX_SDK
+#include "dbapserv.h"
+#include "dbsymtb.h"
+#include "dbents.h"
+#include "dbhatch.h"
+#include "dbpl.h"
+#include "gepnt2d.h"
+#include "gearc2d.h"
+#include "gelnsg2d.h"
+#include "gecurv2d.h"
+#include "gevptar.h"
+#include "geintarr.h"
+#endif
+#endif
+
+namespace EnhancedTakeoff {
+
+namespace {
+    const std::string kEmptyLayerName;
+}
+
+EntitySnapshotStore::EntitySnapshotStore() {
+    // Layer 0 always exists so unassigned entities have a valid layer id
+    InternLayer("0");
+}
+
+EntitySnapshotStore::~EntitySnapshotStore() {
+    Clear();
+}
+
+void EntitySnapshotStore::Clear() {
+    m_handle.clear();
+    m_colorIndex.clear();
+    m_layerId.clear();
+    m_kind.clear();
+    m_vertexOffset.clear();
+    m_vertexCount.clear();
+    m_minX.clear();
+    m_minY.clear();
+    m_maxX.clear();
+    m_maxY.clear();
+    m_boundaryId.clear();
+    m_area.clear();
+    m_length.clear();
+    m_loopOffset.clear();
+    m_loopCount.clear();
+    m_loops.clear();
+    m_vertexX.clear();
+    m_vertexY.clear();
+    m_vertexBulge.clear();
+}
+
+void EntitySnapshotStore::Reserve(size_t entityCount, size_t vertexCount) {
+    m_handle.reserve(entityCount);
+    m_colorIndex.reserve(entityCount);
+    m_layerId.reserve(entityCount);
+    m_kind.reserve(entityCount);
+    m_vertexOffset.reserve(entityCount);
+    m_vertexCount.reserve(entityCount);
+    m_minX.reserve(entityCount);
+    m_minY.reserve(entityCount);
+    m_maxX.reserve(entityCount);
+    m_maxY.reserve(entityCount);
+    m_boundaryId.reserve(entityCount);
+    m_area.reserve(entityCount);
+    m_length.reserve(entityCount);
+    m_loopOffset.reserve(entityCount);
+    m_loopCount.reserve(entityCount);
+    m_vertexX.reserve(vertexCount);
+    m_vertexY.reserve(vertexCount);
+    m_vertexBulge.reserve(vertexCount);
+}
+
+std::uint32_t EntitySnapshotStore::InternLayer(const std::string& layerName) {
+    auto it = m_layerLookup.find(layerName);
+    if (it != m_layerLookup.end()) {
+        return it->second;
+    }
+
+    std::uint32_t layerId = static_cast<std::uint32_t>(m_layerNames.size());
+    m_layerNames.push_back(layerName);
+    m_layerLookup[layerName] = layerId;
+    return layerId;
+}
+
+size_t EntitySnapshotStore::AddEntity(const EntityRecord& record,
+                                      const double* xs, const double* ys, const double* bulges,
+                                      size_t vertexCount, const Loop* loops, size_t loopCount) {
+    size_t index = m_handle.size();
+    std::uint32_t offset = static_cast<std::uint32_t>(m_vertexX.size());
+
+    // Colors outside 1-255 (ByLayer/ByBlock leftovers) are kept but never aggregated
+    int colorIndex = record.colorIndex;
+    if (colorIndex < 1 || colorIndex > 255) colorIndex = 0;
+
+    size_t covered = 0;
+    for (size_t l = 0; loops && l < loopCount; ++l) covered += loops[l].vertexCount;
+    if (!loops || covered != vertexCount) loopCount = 0;
+
+    double minX = 0.0, minY = 0.0, maxX = 0.0, maxY = 0.0;
+    size_t loopIndex = 0;
+    size_t loopBegin = 0;
+    size_t loopEnd = (loopCount > 0) ? loops[0].vertexCount : vertexCount;
+    for (size_t i = 0; i < vertexCount; ++i) {
+        while (i >= loopEnd) {
+            loopBegin = loopEnd;
+            loopEnd += loops[++loopIndex].vertexCount;
+        }
+        double x = xs[i];
+        double y = ys[i];
+        double bulge = bulges ? bulges[i] : 0.0;
+
+        m_vertexX.push_back(x);
+        m_vertexY.push_back(y);
+        m_vertexBulge.push_back(bulge);
+
+        if (i == 0) {
+            minX = maxX = x;
+            minY = maxY = y;
+        } else {
+            minX = std::min(minX, x);
+            minY = std::min(minY, y);
+            maxX = std::max(maxX, x);
+            maxY = std::max(maxY, y);
+        }
+
+        // Arc segments can bow outside their chord - grow the box by the sagitta
+        if (bulge != 0.0 && loopEnd - loopBegin > 1) {
+            size_t next = (i + 1 == loopEnd) ? loopBegin : i + 1;
+            double chord = std::hypot(xs[next] - x, ys[next] - y);
+            double sagitta = std::fabs(bulge) * chord * 0.5;
+            minX = std::min(minX, std::min(x, xs[next]) - sagitta);
+            minY = std::min(minY, std::min(y, ys[next]) - sagitta);
+            maxX = std::max(maxX, std::max(x, xs[next]) + sagitta);
+            maxY = std::max(maxY, std::max(y, ys[next]) + sagitta);
+        }
+    }
+
+    m_handle.push_back(record.handle);
+    m_colorIndex.push_back(static_cast<std::uint8_t>(colorIndex));
+    m_layerId.push_back(record.layerId < m_layerNames.size() ? record.layerId : 0);
+    m_kind.push_back(record.kind);
+    m_vertexOffset.push_back(offset);
+    m_vertexCount.push_back(static_cast<std::uint32_t>(vertexCount));
+    m_minX.push_back(minX);
+    m_minY.push_back(minY);
+    m_maxX.push_back(maxX);
+    m_maxY.push_back(maxY);
+    m_boundaryId.push_back(record.boundaryId);
+    m_area.push_back(record.area >= 0.0 ? record.area : -1.0);
+    m_length.push_back(record.length >= 0.0 ? record.length : -1.0);
+    m_loopOffset.push_back(static_cast<std::uint32_t>(m_loops.size()));
+    m_loopCount.push_back(static_cast<std::uint32_t>(loopCount));
+    m_loops.insert(m_loops.end(), loops, loops + loopCount);
+
+    return index;
+}
+
+void EntitySnapshotStore::AggregateByColor(ColorTotalsArray& totals) const {
+    AggregateByColorParallel(totals, 1);
+}
+
+void EntitySnapshotStore::AggregateByColorParallel(ColorTotalsArray& totals,
+                                                   unsigned int threadCount) const {
+    totals.fill(QuantityEngine::ColorTotals());
+
+    const size_t count = m_handle.size();
+    const size_t chunkCount = (count + kAggregationChunkSize - 1) / kAggregationChunkSize;
+    if (chunkCount == 0) return;
+
+    if (threadCount == 0) {
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+    threadCount = static_cast<unsigned int>(std::min<size_t>(threadCount, chunkCount));
+
+    // One 256-slot partial per chunk - chunk boundaries never depend on the thread count
+    std::vector<ColorTotalsArray> partials(chunkCount);
+    std::atomic<size_t> nextChunk(0);
+
+    auto worker = [&]() {
+        // Thread-local accumulator, copied out once per chunk
+        ColorTotalsArray local;
+        for (size_t chunk = nextChunk++; chunk < chunkCount; chunk = nextChunk++) {
+            local.fill(QuantityEngine::ColorTotals());
+            const size_t begin = chunk * kAggregationChunkSize;
+            AggregateRange(begin, std::min(begin + kAggregationChunkSize, count), local.data());
+            partials[chunk] = local;
+        }
+    };
+
+    if (threadCount == 1) {
+        worker();
+    } else {
+        std::vector<std::thread> threads;
+        threads.reserve(threadCount - 1);
+        for (unsigned int t = 1; t < threadCount; ++t) {
+            threads.emplace_back(worker);
+        }
+        worker();
+        for (auto& thread : threads) {
+            thread.join();
+        }
+    }
+
+    // Merge in chunk order so the floating-point sum has a fixed shape
+    for (const auto& partial : partials) {
+        for (size_t c = 1; c < 256; ++c) {
+            const QuantityEngine::ColorTotals& src = partial[c];
+            if (src.entityCount == 0) continue;
+            QuantityEngine::ColorTotals& dst = totals[c];
+            dst.linearFeet += src.linearFeet;
+            dst.squareFeet += src.squareFeet;
+            dst.each += src.each;
+            dst.entityCount += src.entityCount;
+        }
+    }
+}
+
+void EntitySnapshotStore::AggregateRange(size_t begin, size_t end,
+                                         QuantityEngine::ColorTotals* slots) const {
+    for (size_t i = begin; i < end; ++i) {
+        const std::uint8_t colorIndex = m_colorIndex[i];
+        if (colorIndex == 0) continue;
+
+        EntityDelta::Measure measure = MeasureEntity(i);
+        QuantityEngine::ColorTotals& bucket = slots[colorIndex];
+        bucket.linearFeet += measure.length;
+        bucket.squareFeet += measure.area;
+        bucket.each += measure.count;
+        bucket.entityCount++;
+    }
+}
+
+EntityDelta::Measure EntitySnapshotStore::MeasureEntity(size_t index) const {
+    EntityDelta::Measure measure;
+    if (index >= m_handle.size()) return measure;
+
+    measure.colorIndex = m_colorIndex[index];
+
+    const double* xs = m_vertexX.data() + m_vertexOffset[index];
+    const double* ys = m_vertexY.data() + m_vertexOffset[index];
+    const double* bulges = m_vertexBulge.data() + m_vertexOffset[index];
+    const size_t vertexCount = m_vertexCount[index];
+
+    switch (m_kind[index]) {
+        case EntityKind::Line:
+        case EntityKind::Polyline:
+            measure.length = (m_length[index] >= 0.0)
+                ? m_length[index]
+                : MeasurementKernels::PolylineLength(xs, ys, bulges, vertexCount, false);
+            break;
+        case EntityKind::ClosedPolyline:
+            measure.length = (m_length[index] >= 0.0)
+                ? m_length[index]
+                : MeasurementKernels::PolylineLength(xs, ys, bulges, vertexCount, true);
+            measure.area = (m_area[index] >= 0.0)
+                ? m_area[index]
+                : std::fabs(MeasurementKernels::PolylineSignedArea(xs, ys, bulges, vertexCount));
+            break;
+        case EntityKind::Hatch:
+            if (m_area[index] >= 0.0) {
+                measure.area = m_area[index];
+            } else {
+                // Outer loops less their islands
+                ForEachLoop(index, [&](const double* loopX, const double* loopY, const double* loopBulges,
+                                       size_t loopVertexCount, bool isHole) {
+                    const double area = std::fabs(MeasurementKernels::PolylineSignedArea(
+                        loopX, loopY, loopBulges, loopVertexCount));
+                    measure.area += isHole ? -area : area;
+                });
+                measure.area = std::max(0.0, measure.area);
+            }
+            break;
+        case EntityKind::Block:
+        case EntityKind::Point:
+            measure.count = 1.0;
+            break;
+    }
+
+    return measure;
+}
+
+const std::string& EntitySnapshotStore::GetLayerName(std::uint32_t layerId) const {
+    return layerId < m_layerNames.size() ? m_layerNames[layerId] : kEmptyLayerName;
+}
+
+void EntitySnapshotStore::SetBoundaryId(size_t index, std::int32_t boundaryId) {
+    if (index < m_boundaryId.size()) {
+        m_boundaryId[index] = boundaryId;
+    }
+}
+
+#ifndef BUILDING_TESTS
+#if HAS_BRX_SDK
+namespace {
+    // Appends one hatch edge loop as vertices + bulges; ellipse arcs and splines become chords
+    void AppendEdgeLoop(const AcGeVoidPointerArray& edges, const AcGeIntArray& edgeTypes,
+                        std::vector<double>& xs, std::vector<double>& ys, std::vector<double>& bulges) {
+        for (int e = 0; e < edges.length(); ++e) {
+            if (edgeTypes[e] == AcDbHatch::kLine) {
+                const AcGeLineSeg2d* pLine = static_cast<const AcGeLineSeg2d*>(edges[e]);
+                xs.push_back(pLine->startPoint().x);
+                ys.push_back(pLine->startPoint().y);
+                bulges.push_back(0.0);
+            } else if (edgeTypes[e] == AcDbHatch::kCirArc) {
+                // Two half arcs, so a full-circle edge (start == end) still has a defined bulge
+                const AcGeCircArc2d* pArc = static_cast<const AcGeCircArc2d*>(edges[e]);
+                const double halfSweep = 0.5 * (pArc->endAng() - pArc->startAng());
+                const double direction = pArc->isClockWise() ? -1.0 : 1.0;
+                const double bulge = direction * std::tan(0.5 * halfSweep);
+                AcGeVector2d toMiddle = pArc->refVec().normal();
+                toMiddle.rotateBy(direction * (pArc->startAng() + halfSweep));
+                const AcGePoint2d middle = pArc->center() + toMiddle * pArc->radius();
+                xs.insert(xs.end(), { pArc->startPoint().x, middle.x });
+                ys.insert(ys.end(), { pArc->startPoint().y, middle.y });
+                bulges.insert(bulges.end(), { bulge, bulge });
+            } else {
+                const AcGeCurve2d* pCurve = static_cast<const AcGeCurve2d*>(edges[e]);
+                AcGePoint2dArray points;
+                pCurve->getSamplePoints(EntitySnapshotStore::kCurveSegments + 1, points);
+                for (int k = 0; k + 1 < points.length(); ++k) {     // The next edge starts at the last point
+                    xs.push_back(points[k].x);
+                    ys.push_back(points[k].y);
+                    bulges.push_back(0.0);
+                }
+            }
+        }
+    }
+
+    // Every loop of a hatch with its role: nesting depth decides, as the hatch style fills -
+    // even depth is filled, odd depth is an island; Outer style stops after the first island
+    // level and Ignore style keeps only the outermost loops
+    void CaptureHatchLoops(const AcDbHatch* pHatch, std::vector<double>& xs, std::vector<double>& ys,
+                           std::vector<double>& bulges, std::vector<EntitySnapshotStore::Loop>& loops) {
+        const int loopCount = pHatch->numLoops();
+        std::vector<std::vector<double>> loopX(loopCount), loopY(loopCount), loopBulges(loopCount);
+        for (int loop = 0; loop < loopCount; ++loop) {
+            Adesk::Int32 loopType = pHatch->loopTypeAt(loop);
+            if (loopType & AcDbHatch::kPolyline) {
+                AcGePoint2dArray vertices;
+                AcGeDoubleArray vertexBulges;
+                if (pHatch->getLoopAt(loop, loopType, vertices, vertexBulges) != Acad::eOk) continue;
+                for (int i = 0; i < vertices.length(); ++i) {
+                    loopX[loop].push_back(vertices[i].x);
+                    loopY[loop].push_back(vertices[i].y);
+                    loopBulges[loop].push_back(i < vertexBulges.length() ? vertexBulges[i] : 0.0);
+                }
+            } else {
+                // Edges point into the hatch's own loop data - not ours to delete
+                AcGeVoidPointerArray edges;
+                AcGeIntArray edgeTypes;
+                if (pHatch->getLoopAt(loop, loopType, edges, edgeTypes) != Acad::eOk) continue;
+                AppendEdgeLoop(edges, edgeTypes, loopX[loop], loopY[loop], loopBulges[loop]);
+            }
+        }
+
+        std::vector<BoundaryPolygon> rings(loopCount);
+        for (int loop = 0; loop < loopCount; ++loop) {
+            rings[loop].SetVertices(loopX[loop].data(), loopY[loop].data(), loopX[loop].size());
+        }
+
+        const int maxDepth = (pHatch->style() == AcDbHatch::kIgnore) ? 0
+                           : (pHatch->style() == AcDbHatch::kOuter) ? 1 : loopCount;
+        for (int loop = 0; loop < loopCount; ++loop) {
+            if (rings[loop].IsEmpty()) continue;
+            int depth = 0;
+            for (int other = 0; other < loopCount; ++other) {
+                if (other != loop && !rings[other].IsEmpty() &&
+                    rings[other].Contains(loopX[loop][0], loopY[loop][0])) {
+                    ++depth;
+                }
+            }
+            if (depth > maxDepth) continue;
+
+            xs.insert(xs.end(), loopX[loop].begin(), loopX[loop].end());
+            ys.insert(ys.end(), loopY[loop].begin(), loopY[loop].end());
+            bulges.insert(bulges.end(), loopBulges[loop].begin(), loopBulges[loop].end());
+            loops.push_back(EntitySnapshotStore::Loop(static_cast<std::uint32_t>(loopX[loop].size()),
+                                                      (depth % 2) != 0));
+        }
+    }
+}
+
+size_t EntitySnapshotStore::CaptureFromDatabase(AcDbDatabase* pDb) {
+    if (!pDb) return 0;
+
+    Clear();
+
+    AcDbBlockTable* pBlockTable = nullptr;
+    if (pDb->getBlockTable(pBlockTable, AcDb::kForRead) != Acad::eOk) return 0;
+
+    AcDbBlockTableRecord* pModelSpace = nullptr;
+    Acad::ErrorStatus es = pBlockTable->getAt(ACDB_MODEL_SPACE, pModelSpace, AcDb::kForRead);
+    pBlockTable->close();
+    if (es != Acad::eOk) return 0;
+
+    std::vector<double> xs, ys, bulges;
+    std::vector<Loop> loops;
+    AcDbBlockTableRecordIterator* pIter = nullptr;
+    if (pModelSpace->newIterator(pIter) == Acad::eOk) {
+        for (; !pIter->done(); pIter->step()) {
+            AcDbEntity* pEnt = nullptr;
+            if (pIter->getEntity(pEnt, AcDb::kForRead) != Acad::eOk) continue;
+
+            EntityRecord record;
+            record.handle = DatabaseDeltaReactor::GetHandleValue(pEnt);
+            record.colorIndex = DatabaseDeltaReactor::ResolveColorIndex(pEnt);
+            record.layerId = InternLayer(std::string(CT2A(pEnt->layer())));
+
+            xs.clear();
+            ys.clear();
+            bulges.clear();
+            loops.clear();
+            bool captured = true;
+
+            if (AcDbLine* pLine = AcDbLine::cast(pEnt)) {
+                record.kind = EntityKind::Line;
+                xs = { pLine->startPoint().x, pLine->endPoint().x };
+                ys = { pLine->startPoint().y, pLine->endPoint().y };
+                bulges = { 0.0, 0.0 };
+            } else if (AcDbPolyline* pPline = AcDbPolyline::cast(pEnt)) {
+                record.kind = pPline->isClosed() ? EntityKind::ClosedPolyline : EntityKind::Polyline;
+                // WCS points; bulges are signed about the normal, so an extruded (-Z) outline flips them
+                const double bulgeSign = (pPline->normal().z < 0.0) ? -1.0 : 1.0;
+                for (unsigned int i = 0; i < pPline->numVerts(); ++i) {
+                    AcGePoint3d pt;
+                    double bulge = 0.0;
+                    pPline->getPointAt(i, pt);
+                    pPline->getBulgeAt(i, bulge);
+                    xs.push_back(pt.x);
+                    ys.push_back(pt.y);
+                    bulges.push_back(bulgeSign * bulge);
+                }
+            } else if (AcDbCircle* pCircle = AcDbCircle::cast(pEnt)) {
+                // Two half-circle arcs (bulge 1) reproduce the circle exactly
+                record.kind = EntityKind::ClosedPolyline;
+                AcGePoint3d c = pCircle->center();
+                double r = pCircle->radius();
+                xs = { c.x - r, c.x + r };
+                ys = { c.y, c.y };
+                bulges = { 1.0, 1.0 };
+            } else if (AcDbArc* pArc = AcDbArc::cast(pEnt)) {
+                record.kind = EntityKind::Polyline;
+                AcGePoint3d startPt, endPt;
+                pArc->getStartPoint(startPt);
+                pArc->getEndPoint(endPt);
+                double sweep = pArc->endAngle() - pArc->startAngle();
+                if (sweep < 0.0) sweep += 8.0 * std::atan(1.0);
+                // Angles run counter-clockwise about the normal - seen from +Z an extruded arc runs clockwise
+                const double bulge = std::tan(sweep * 0.25);
+                xs = { startPt.x, endPt.x };
+                ys = { startPt.y, endPt.y };
+                bulges = { (pArc->normal().z < 0.0) ? -bulge : bulge, 0.0 };
+            } else if (AcDb2dPolyline* p2dPline = AcDb2dPolyline::cast(pEnt)) {
+                // Old-style polyline - fit vertices carry the curve, spline control vertices do not
+                record.kind = p2dPline->isClosed() ? EntityKind::ClosedPolyline : EntityKind::Polyline;
+                const double bulgeSign = (p2dPline->normal().z < 0.0) ? -1.0 : 1.0;
+                AcDbObjectIterator* pVertices = p2dPline->vertexIterator();
+                for (; pVertices && !pVertices->done(); pVertices->step()) {
+                    AcDb2dVertex* pVertex = nullptr;
+                    if (p2dPline->openVertex(pVertex, pVertices->objectId(), AcDb::kForRead) != Acad::eOk) continue;
+                    if (pVertex->vertexType() != AcDb::k2dSplineCtlVertex) {
+                        const AcGePoint3d pt = p2dPline->vertexPosition(*pVertex);
+                        xs.push_back(pt.x);
+                        ys.push_back(pt.y);
+                        bulges.push_back(bulgeSign * pVertex->bulge());
+                    }
+                    pVertex->close();
+                }
+                delete pVertices;
+            } else if (AcDb3dPolyline* p3dPline = AcDb3dPolyline::cast(pEnt)) {
+                record.kind = p3dPline->isClosed() ? EntityKind::ClosedPolyline : EntityKind::Polyline;
+                AcDbObjectIterator* pVertices = p3dPline->vertexIterator();
+                for (; pVertices && !pVertices->done(); pVertices->step()) {
+                    AcDb3dPolylineVertex* pVertex = nullptr;
+                    if (p3dPline->openVertex(pVertex, pVertices->objectId(), AcDb::kForRead) != Acad::eOk) continue;
+                    if (pVertex->vertexType() != AcDb::k3dControlVertex) {
+                        xs.push_back(pVertex->position().x);
+                        ys.push_back(pVertex->position().y);
+                        bulges.push_back(0.0);
+                    }
+                    pVertex->close();
+                }
+                delete pVertices;
+                // Measured in 3D like the reactor does; the plan-view vertices only place it
+                double endParam = 0.0;
+                double length = 0.0;
+                if (p3dPline->getEndParam(endParam) == Acad::eOk &&
+                    p3dPline->getDistAtParam(endParam, length) == Acad::eOk) {
+                    record.length = length;
+                }
+                double area = 0.0;
+                if (p3dPline->isClosed() && p3dPline->getArea(area) == Acad::eOk) {
+                    record.area = area;
+                }
+            } else if (AcDbHatch* pHatch = AcDbHatch::cast(pEnt)) {
+                // SF is the hatch's own net area (islands and holes removed) - the figure QuantityEngine
+                // uses; every loop is kept with its role so boundary clipping can subtract the islands
+                record.kind = EntityKind::Hatch;
+                double area = 0.0;
+                if (pHatch->getArea(area) == Acad::eOk) {
+                    record.area = area;
+                }
+                CaptureHatchLoops(pHatch, xs, ys, bulges, loops);
+            } else if (AcDbBlockReference* pRef = AcDbBlockReference::cast(pEnt)) {
+                record.kind = EntityKind::Block;
+                xs = { pRef->position().x };
+                ys = { pRef->position().y };
+                bulges = { 0.0 };
+            } else if (AcDbPoint* pPoint = AcDbPoint::cast(pEnt)) {
+                record.kind = EntityKind::Point;
+                xs = { pPoint->position().x };
+                ys = { pPoint->position().y };
+                bulges = { 0.0 };
+            } else if (AcDbCurve* pCurve = AcDbCurve::cast(pEnt)) {
+                // Splines, ellipses and any other curve: kCurveSegments chords evenly spaced in
+                // parameter, with the curve's own LF/SF kept as the entity's measure
+                const bool closed = pCurve->isClosed();
+                record.kind = closed ? EntityKind::ClosedPolyline : EntityKind::Polyline;
+                double startParam = 0.0;
+                double endParam = 0.0;
+                if (pCurve->getStartParam(startParam) == Acad::eOk && pCurve->getEndParam(endParam) == Acad::eOk) {
+                    const int samples = closed ? kCurveSegments : kCurveSegments + 1;
+                    for (int k = 0; k < samples; ++k) {
+                        AcGePoint3d pt;
+                        const double param = startParam + (endParam - startParam) * k / kCurveSegments;
+                        if (pCurve->getPointAtParam(param, pt) == Acad::eOk) {
+                            xs.push_back(pt.x);
+                            ys.push_back(pt.y);
+                            bulges.push_back(0.0);
+                        }
+                    }
+                    double length = 0.0;
+                    if (pCurve->getDistAtParam(endParam, length) == Acad::eOk) {
+                        record.length = length;
+                    }
+                }
+                double area = 0.0;
+                if (closed && pCurve->getArea(area) == Acad::eOk) {
+                    record.area = area;
+                }
+            } else {
+                captured = false;
+            }
+
+            if (captured) {
+                AddEntity(record, xs.data(), ys.data(), bulges.data(), xs.size(), loops.data(), loops.size());
+            }
+            pEnt->close();
+        }
+        delete pIter;
+    }
+    pModelSpace->close();
+
+    return GetEntityCount();
+}
+#endif
+#endif
+
+} // namespace EnhancedTakeoff
@@ -0,0 +1,168 @@
+// EntitySnapshotStore.h - Columnar (structure-of-arrays) snapshot of takeoff entities
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <array>
+#include <map>
+
+#include "QuantityEngine.h"
+
+#ifndef BUILDING_TESTS
+#if HAS_BRX_SDK
+#include "dbmain.h"
+#endif
+#endif
+
+namespace EnhancedTakeoff {
+
+/**
+ * Structure-of-arrays snapshot of takeoff-relevant entities
+ * Each attribute lives in its own contiguous column so per-color aggregation
+ * is a linear, cache-friendly sweep instead of opening AcDb objects one by one
+ * COPILOT-HINT: Fill from the drawing with CaptureFromDatabase or from tests with AddEntity
+ */
+class EntitySnapshotStore {
+public:
+    enum class EntityKind : std::uint8_t {
+        Line,            // Open segment(s) - contributes LF
+        Polyline,        // Open polyline or tessellated curve with optional bulges - contributes LF
+        ClosedPolyline,  // Closed polyline or curve - contributes LF (perimeter) and SF
+        Hatch,           // Filled region - contributes SF only
+        Block,           // Block reference - contributes EA
+        Point            // Point marker - contributes EA
+    };
+
+    struct EntityRecord {
+        std::uint64_t handle;       // Stable entity handle
+        int colorIndex;             // BricsCAD color index (1-255)
+        std::uint32_t layerId;      // Index into the layer name table
+        EntityKind kind;
+        std::int32_t boundaryId;    // Owning boundary, -1 when unassigned
+        double area;                // Net SF known up front (hatch islands removed), < 0 = from the outline
+        double length;              // LF known up front (tessellated curves), < 0 = from the vertices
+
+        EntityRecord() : handle(0), colorIndex(0), layerId(0),
+                         kind(EntityKind::Line), boundaryId(-1), area(-1.0), length(-1.0) {}
+    };
+
+    // One ring of a multi-loop entity (hatch); loops follow each other in the entity's vertex run
+    struct Loop {
+        std::uint32_t vertexCount;
+        bool isHole;                // Island - its area is subtracted from the outer loops
+
+        Loop() : vertexCount(0), isHole(false) {}
+        Loop(std::uint32_t count, bool hole) : vertexCount(count), isHole(hole) {}
+    };
+
+    using ColorTotalsArray = std::array<QuantityEngine::ColorTotals, 256>;
+
+    EntitySnapshotStore();
+    ~EntitySnapshotStore();
+
+    // Population
+    void Clear();
+    void Reserve(size_t entityCount, size_t vertexCount);
+    std::uint32_t InternLayer(const std::string& layerName);
+    // Without loops the whole vertex run is one outer loop; loops that do not add up to
+    // vertexCount are ignored the same way
+    size_t AddEntity(const EntityRecord& record,
+                     const double* xs, const double* ys, const double* bulges,
+                     size_t vertexCount, const Loop* loops = nullptr, size_t loopCount = 0);
+
+    // Chords per curve that has no vertex/bulge form (splines, ellipses) - its exact LF/SF ride along
+    static const int kCurveSegments = 64;
+
+#ifndef BUILDING_TESTS
+#if HAS_BRX_SDK
+    // Captures every entity DatabaseDeltaReactor measures, so clipped and whole-drawing totals agree
+    size_t CaptureFromDatabase(AcDbDatabase* pDb);
+#endif
+#endif
+
+    // Aggregation - one linear sweep over the columns
+    // Work is split into fixed-size chunks merged in chunk order, so totals are
+    // bit-identical for any thread count (0 = hardware concurrency)
+    static const size_t kAggregationChunkSize = 16384;
+    void AggregateByColor(ColorTotalsArray& totals) const;
+    void AggregateByColorParallel(ColorTotalsArray& totals, unsigned int threadCount = 0) const;
+    EntityDelta::Measure MeasureEntity(size_t index) const;
+
+    // Size and layer table
+    size_t GetEntityCount() const { return m_handle.size(); }
+    size_t GetVertexCount() const { return m_vertexX.size(); }
+    const std::string& GetLayerName(std::uint32_t layerId) const;
+    size_t GetLayerCount() const { return m_layerNames.size(); }
+
+    // Column access for kernels and parallel passes
+    const std::uint64_t* GetHandles() const { return m_handle.data(); }
+    const std::uint8_t* GetColorIndices() const { return m_colorIndex.data(); }
+    const std::uint32_t* GetLayerIds() const { return m_layerId.data(); }
+    const EntityKind* GetKinds() const { return m_kind.data(); }
+    const std::uint32_t* GetVertexOffsets() const { return m_vertexOffset.data(); }
+    const std::uint32_t* GetVertexCounts() const { return m_vertexCount.data(); }
+    const double* GetMinX() const { return m_minX.data(); }
+    const double* GetMinY() const { return m_minY.data(); }
+    const double* GetMaxX() const { return m_maxX.data(); }
+    const double* GetMaxY() const { return m_maxY.data(); }
+    const std::int32_t* GetBoundaryIds() const { return m_boundaryId.data(); }
+    const double* GetAreas() const { return m_area.data(); }       // EntityRecord::area, -1 when unset
+    const double* GetLengths() const { return m_length.data(); }   // EntityRecord::length, -1 when unset
+    const double* GetVertexX() const { return m_vertexX.data(); }
+    const double* GetVertexY() const { return m_vertexY.data(); }
+    const double* GetVertexBulge() const { return m_vertexBulge.data(); }
+
+    // Calls function(xs, ys, bulges, vertexCount, isHole) for every loop of one entity, in order
+    template <typename Function>
+    void ForEachLoop(size_t index, Function function) const {
+        const size_t offset = m_vertexOffset[index];
+        const double* xs = m_vertexX.data() + offset;
+        const double* ys = m_vertexY.data() + offset;
+        const double* bulges = m_vertexBulge.data() + offset;
+        if (m_loopCount[index] == 0) {
+            function(xs, ys, bulges, static_cast<size_t>(m_vertexCount[index]), false);
+            return;
+        }
+        const Loop* loop = m_loops.data() + m_loopOffset[index];
+        for (std::uint32_t l = 0; l < m_loopCount[index]; ++l, ++loop) {
+            function(xs, ys, bulges, static_cast<size_t>(loop->vertexCount), loop->isHole);
+            xs += loop->vertexCount;
+            ys += loop->vertexCount;
+            bulges += loop->vertexCount;
+        }
+    }
+
+    void SetBoundaryId(size_t index, std::int32_t boundaryId);
+
+private:
+    // Entity columns
+    std::vector<std::uint64_t> m_handle;
+    std::vector<std::uint8_t> m_colorIndex;
+    std::vector<std::uint32_t> m_layerId;
+    std::vector<EntityKind> m_kind;
+    std::vector<std::uint32_t> m_vertexOffset;
+    std::vector<std::uint32_t> m_vertexCount;
+    std::vector<double> m_minX, m_minY, m_maxX, m_maxY;
+    std::vector<std::int32_t> m_boundaryId;
+    std::vector<double> m_area;
+    std::vector<double> m_length;
+    std::vector<std::uint32_t> m_loopOffset;    // Into m_loops
+    std::vector<std::uint32_t> m_loopCount;     // 0 = the vertex run is one outer loop
+
+    // Loop table for multi-loop entities
+    std::vector<Loop> m_loops;
+
+    // Vertex columns (shared pool, addressed by offset/count)
+    std::vector<double> m_vertexX;
+    std::vector<double> m_vertexY;
+    std::vector<double> m_vertexBulge;
+
+    // Layer name table
+    std::vector<std::string> m_layerNames;
+    std::map<std::string, std::uint32_t> m_layerLookup;
+
+    void AggregateRange(size_t begin, size_t end, QuantityEngine::ColorTotals* slots) const;
+};
+
+} // namespace EnhancedTakeoff
@@ -0,0 +1,524 @@
+// EntitySpatialIndex.cpp - R-tree of entity bounding boxes keyed by entity handle
+// Enhanced Construction Takeoff - BricsCAD V25 Plugin
+// COPILOT-HINT: Nodes live in one vector and refer to each other by index - never hold a
+// Node& across AllocateNode, the vector may grow
+
+#include "pch.h"
+#include "EntitySpatialIndex.h"
+#include "EntitySnapshotStore.h"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace EnhancedTakeoff {
+
+namespace {
+    double CenterX(const EntitySpatialIndex::Box& box) { return 0.5 * (box.minX + box.maxX); }
+    double CenterY(const EntitySpatialIndex::Box& box) { return 0.5 * (box.minY + box.maxY); }
+
+    double Enlargement(const EntitySpatialIndex::Box& box, const EntitySpatialIndex::Box& add) {
+        EntitySpatialIndex::Box grown = box;
+        grown.Expand(add);
+        return grown.Area() - box.Area();
+    }
+
+    int LowestSetBit(std::uint64_t mask) {
+#if defined(_MSC_VER)
+        unsigned long bit;
+        _BitScanForward64(&bit, mask);
+        return static_cast<int>(bit);
+#else
+        return __builtin_ctzll(mask);
+#endif
+    }
+
+    bool SameBox(const EntitySpatialIndex::Box& a, const EntitySpatialIndex::Box& b) {
+        return a.minX == b.minX && a.minY == b.minY && a.maxX == b.maxX && a.maxY == b.maxY;
+    }
+}
+
+void EntitySpatialIndex::Box::Expand(const Box& other) {
+    minX = std::min(minX, other.minX);
+    minY = std::min(minY, other.minY);
+    maxX = std::max(maxX, other.maxX);
+    maxY = std::max(maxY, other.maxY);
+}
+
+EntitySpatialIndex::Box EntitySpatialIndex::Node::Bounds() const {
+    Box bounds = count > 0 ? boxes[0] : Box();
+    for (int i = 1; i < count; ++i) {
+        bounds.Expand(boxes[i]);
+    }
+    return bounds;
+}
+
+EntitySpatialIndex::EntitySpatialIndex() : m_root(-1) {
+}
+
+EntitySpatialIndex::~EntitySpatialIndex() {
+    Clear();
+}
+
+void EntitySpatialIndex::Clear() {
+    m_nodes.clear();
+    m_freeNodes.clear();
+    m_leafOf.clear();
+    m_root = -1;
+}
+
+// ---------------------------------------------------------------------------
+// Bulk load (Sort-Tile-Recursive)
+// ---------------------------------------------------------------------------
+
+void EntitySpatialIndex::BulkLoad(const std::vector<Entry>& entries) {
+    Clear();
+    if (entries.empty()) return;
+
+    // Last entry wins for duplicate handles, matching Insert semantics
+    std::unordered_map<std::uint64_t, size_t> lastIndex;
+    lastIndex.reserve(entries.size());
+    for (size_t i = 0; i < entries.size(); ++i) {
+        lastIndex[entries[i].handle] = i;
+    }
+
+    std::vector<Entry> items;
+    items.reserve(lastIndex.size());
+    for (size_t i = 0; i < entries.size(); ++i) {
+        if (lastIndex[entries[i].handle] == i) {
+            items.push_back(entries[i]);
+        }
+    }
+
+    m_nodes.reserve(items.size() / (kMaxEntries / 2) + 8);
+    m_leafOf.reserve(items.size());
+
+    bool leafLevel = true;
+    for (;;) {
+        std::vector<std::int32_t> level = PackLevel(items, leafLevel);
+        if (level.size() == 1) {
+            m_root = level[0];
+            break;
+        }
+
+        items.clear();
+        for (std::int32_t nodeIndex : level) {
+            items.push_back(Entry(static_cast<std::uint64_t>(nodeIndex), m_nodes[nodeIndex].Bounds()));
+        }
+        leafLevel = false;
+    }
+}
+
+void EntitySpatialIndex::BuildFromSnapshot(const EntitySnapshotStore& store) {
+    const size_t count = store.GetEntityCount();
+    const std::uint64_t* handles = store.GetHandles();
+    const double* minX = store.GetMinX();
+    const double* minY = store.GetMinY();
+    const double* maxX = store.GetMaxX();
+    const double* maxY = store.GetMaxY();
+
+    std::vector<Entry> entries;
+    entries.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        entries.push_back(Entry(handles[i], Box(minX[i], minY[i], maxX[i], maxY[i])));
+    }
+    BulkLoad(entries);
+}
+
+std::vector<std::int32_t> EntitySpatialIndex::PackLevel(std::vector<Entry>& items, bool leafLevel) {
+    const size_t nodeCount = (items.size() + kMaxEntries - 1) / kMaxEntries;
+    const size_t sliceCount = static_cast<size_t>(std::ceil(std::sqrt(static_cast<double>(nodeCount))));
+    const size_t sliceSize = sliceCount * kMaxEntries;
+
+    std::sort(items.begin(), items.end(), [](const Entry& a, const Entry& b) {
+        return CenterX(a.box) < CenterX(b.box);
+    });
+
+    std::vector<std::int32_t> level;
+    level.reserve(nodeCount);
+    for (size_t sliceStart = 0; sliceStart < items.size(); sliceStart += sliceSize) {
+        const size_t sliceEnd = std::min(items.size(), sliceStart + sliceSize);
+        std::sort(items.begin() + sliceStart, items.begin() + sliceEnd, [](const Entry& a, const Entry& b) {
+            return CenterY(a.box) < CenterY(b.box);
+        });
+
+        for (size_t start = sliceStart; start < sliceEnd; start += kMaxEntries) {
+            const std::int32_t nodeIndex = AllocateNode(leafLevel);
+            Node& node = m_nodes[nodeIndex];
+            const size_t end = std::min(sliceEnd, start + kMaxEntries);
+            for (size_t i = start; i < end; ++i) {
+                node.boxes[node.count] = items[i].box;
+                node.ids[node.count] = items[i].handle;
+                node.count++;
+            }
+
+            if (leafLevel) {
+                for (int i = 0; i < node.count; ++i) {
+                    m_leafOf[node.ids[i]] = nodeIndex;
+                }
+            } else {
+                SetChildParent(node);
+            }
+            level.push_back(nodeIndex);
+        }
+    }
+    return level;
+}
+
+// ---------------------------------------------------------------------------
+// Incremental maintenance
+// ---------------------------------------------------------------------------
+
+void EntitySpatialIndex::Insert(std::uint64_t handle, const Box& box) {
+    if (m_leafOf.count(handle)) {
+        Update(handle, box);
+        return;
+    }
+
+    if (m_root < 0) {
+        m_root = AllocateNode(true);
+    }
+    AddToNode(ChooseLeaf(box), handle, box);
+}
+
+bool EntitySpatialIndex::Update(std::uint64_t handle, const Box& box) {
+    auto it = m_leafOf.find(handle);
+    if (it == m_leafOf.end()) return false;
+
+    // Boxes that stay inside their leaf's current bounds are patched in place
+    Node& leaf = m_nodes[it->second];
+    for (int i = 0; i < leaf.count; ++i) {
+        if (leaf.ids[i] == handle) {
+            Box bounds = leaf.Bounds();
+            if (box.minX >= bounds.minX && box.minY >= bounds.minY &&
+                box.maxX <= bounds.maxX && box.maxY <= bounds.maxY) {
+                leaf.boxes[i] = box;
+                RefreshBoundsUpward(it->second);
+                return true;
+            }
+            break;
+        }
+    }
+
+    Remove(handle);
+    Insert(handle, box);
+    return true;
+}
+
+bool EntitySpatialIndex::Remove(std::uint64_t handle) {
+    auto it = m_leafOf.find(handle);
+    if (it == m_leafOf.end()) return false;
+
+    const std::int32_t leafIndex = it->second;
+    m_leafOf.erase(it);
+
+    Node& leaf = m_nodes[leafIndex];
+    for (int i = 0; i < leaf.count; ++i) {
+        if (leaf.ids[i] == handle) {
+            leaf.count--;
+            leaf.boxes[i] = leaf.boxes[leaf.count];
+            leaf.ids[i] = leaf.ids[leaf.count];
+            break;
+        }
+    }
+
+    if (leaf.count == 0) {
+        RemoveEmptyNode(leafIndex);
+    } else {
+        RefreshBoundsUpward(leafIndex);
+    }
+
+    // Collapse single-child roots so the height tracks the entry count
+    while (m_root >= 0 && !m_nodes[m_root].leaf && m_nodes[m_root].count == 1) {
+        const std::int32_t child = static_cast<std::int32_t>(m_nodes[m_root].ids[0]);
+        FreeNode(m_root);
+        m_root = child;
+        m_nodes[m_root].parent = -1;
+    }
+    return true;
+}
+
+std::int32_t EntitySpatialIndex::AllocateNode(bool leaf) {
+    std::int32_t index;
+    if (!m_freeNodes.empty()) {
+        index = m_freeNodes.back();
+        m_freeNodes.pop_back();
+        m_nodes[index] = Node();
+    } else {
+        index = static_cast<std::int32_t>(m_nodes.size());
+        m_nodes.push_back(Node());
+    }
+    m_nodes[index].leaf = leaf;
+    return index;
+}
+
+void EntitySpatialIndex::FreeNode(std::int32_t index) {
+    m_nodes[index].count = 0;
+    m_nodes[index].parent = -1;
+    m_freeNodes.push_back(index);
+}
+
+std::int32_t EntitySpatialIndex::ChooseLeaf(const Box& box) const {
+    std::int32_t nodeIndex = m_root;
+    while (!m_nodes[nodeIndex].leaf) {
+        const Node& node = m_nodes[nodeIndex];
+        int best = 0;
+        double bestEnlargement = Enlargement(node.boxes[0], box);
+        double bestArea = node.boxes[0].Area();
+        for (int i = 1; i < node.count; ++i) {
+            const double enlargement = Enlargement(node.boxes[i], box);
+            const double area = node.boxes[i].Area();
+            if (enlargement < bestEnlargement || (enlargement == bestEnlargement && area < bestArea)) {
+                best = i;
+                bestEnlargement = enlargement;
+                bestArea = area;
+            }
+        }
+        nodeIndex = static_cast<std::int32_t>(node.ids[best]);
+    }
+    return nodeIndex;
+}
+
+void EntitySpatialIndex::AddToNode(std::int32_t nodeIndex, std::uint64_t id, const Box& box) {
+    Node& node = m_nodes[nodeIndex];
+    if (node.count == kMaxEntries) {
+        SplitNode(nodeIndex, id, box);
+        return;
+    }
+
+    node.boxes[node.count] = box;
+    node.ids[node.count] = id;
+    node.count++;
+    if (node.leaf) {
+        m_leafOf[id] = nodeIndex;
+    } else {
+        m_nodes[static_cast<std::int32_t>(id)].parent = nodeIndex;
+    }
+    RefreshBoundsUpward(nodeIndex);
+}
+
+void EntitySpatialIndex::SplitNode(std::int32_t nodeIndex, std::uint64_t id, const Box& box) {
+    // Gather the full node plus the overflow entry, then cut along the wider axis
+    Entry pending[kMaxEntries + 1];
+    {
+        const Node& node = m_nodes[nodeIndex];
+        for (int i = 0; i < kMaxEntries; ++i) {
+            pending[i] = Entry(node.ids[i], node.boxes[i]);
+        }
+    }
+    pending[kMaxEntries] = Entry(id, box);
+
+    double minCx = CenterX(pending[0].box), maxCx = minCx;
+    double minCy = CenterY(pending[0].box), maxCy = minCy;
+    for (int i = 1; i <= kMaxEntries; ++i) {
+        minCx = std::min(minCx, CenterX(pending[i].box));
+        maxCx = std::max(maxCx, CenterX(pending[i].box));
+        minCy = std::min(minCy, CenterY(pending[i].box));
+        maxCy = std::max(maxCy, CenterY(pending[i].box));
+    }
+    if (maxCx - minCx >= maxCy - minCy) {
+        std::sort(pending, pending + kMaxEntries + 1, [](const Entry& a, const Entry& b) {
+            return CenterX(a.box) < CenterX(b.box);
+        });
+    } else {
+        std::sort(pending, pending + kMaxEntries + 1, [](const Entry& a, const Entry& b) {
+            return CenterY(a.box) < CenterY(b.box);
+        });
+    }
+
+    const bool leaf = m_nodes[nodeIndex].leaf;
+    const std::int32_t siblingIndex = AllocateNode(leaf);
+    Node& node = m_nodes[nodeIndex];
+    Node& sibling = m_nodes[siblingIndex];
+
+    const int keep = (kMaxEntries + 1) / 2;
+    node.count = 0;
+    for (int i = 0; i <= kMaxEntries; ++i) {
+        Node& target = (i < keep) ? node : sibling;
+        target.boxes[target.count] = pending[i].box;
+        target.ids[target.count] = pending[i].handle;
+        target.count++;
+    }
+
+    if (leaf) {
+        for (int i = 0; i < node.count; ++i) m_leafOf[node.ids[i]] = nodeIndex;
+        for (int i = 0; i < sibling.count; ++i) m_leafOf[sibling.ids[i]] = siblingIndex;
+    } else {
+        SetChildParent(node);
+        SetChildParent(sibling);
+    }
+
+    const Box nodeBounds = node.Bounds();
+    const Box siblingBounds = sibling.Bounds();
+    const std::int32_t parentIndex = node.parent;
+
+    if (parentIndex < 0) {
+        // Root split - grow the tree by one level
+        const std::int32_t rootIndex = AllocateNode(false);
+        Node& root = m_nodes[rootIndex];
+        root.boxes[0] = nodeBounds;
+        root.ids[0] = static_cast<std::uint64_t>(nodeIndex);
+        root.boxes[1] = siblingBounds;
+        root.ids[1] = static_cast<std::uint64_t>(siblingIndex);
+        root.count = 2;
+        m_nodes[nodeIndex].parent = rootIndex;
+        m_nodes[siblingIndex].parent = rootIndex;
+        m_root = rootIndex;
+        return;
+    }
+
+    m_nodes[parentIndex].boxes[FindChildSlot(parentIndex, nodeIndex)] = nodeBounds;
+    AddToNode(parentIndex, static_cast<std::uint64_t>(siblingIndex), siblingBounds);
+}
+
+void EntitySpatialIndex::RefreshBoundsUpward(std::int32_t nodeIndex) {
+    while (m_nodes[nodeIndex].parent >= 0) {
+        const std::int32_t parentIndex = m_nodes[nodeIndex].parent;
+        const int slot = FindChildSlot(parentIndex, nodeIndex);
+        const Box bounds = m_nodes[nodeIndex].Bounds();
+        if (SameBox(m_nodes[parentIndex].boxes[slot], bounds)) break;
+        m_nodes[parentIndex].boxes[slot] = bounds;
+        nodeIndex = parentIndex;
+    }
+}
+
+int EntitySpatialIndex::FindChildSlot(std::int32_t parentIndex, std::int32_t childIndex) const {
+    const Node& parent = m_nodes[parentIndex];
+    for (int i = 0; i < parent.count; ++i) {
+        if (parent.ids[i] == static_cast<std::uint64_t>(childIndex)) return i;
+    }
+    return 0;
+}
+
+void EntitySpatialIndex::RemoveEmptyNode(std::int32_t nodeIndex) {
+    const std::int32_t parentIndex = m_nodes[nodeIndex].parent;
+    FreeNode(nodeIndex);
+
+    if (parentIndex < 0) {
+        m_root = -1;
+        return;
+    }
+
+    Node& parent = m_nodes[parentIndex];
+    const int slot = FindChildSlot(parentIndex, nodeIndex);
+    parent.count--;
+    parent.boxes[slot] = parent.boxes[parent.count];
+    parent.ids[slot] = parent.ids[parent.count];
+
+    if (parent.count == 0) {
+        RemoveEmptyNode(parentIndex);
+    } else {
+        RefreshBoundsUpward(parentIndex);
+    }
+}
+
+void EntitySpatialIndex::SetChildParent(const Node& node) {
+    const std::int32_t nodeIndex = static_cast<std::int32_t>(&node - m_nodes.data());
+    for (int i = 0; i < node.count; ++i) {
+        m_nodes[static_cast<std::int32_t>(node.ids[i])].parent = nodeIndex;
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Queries
+// ---------------------------------------------------------------------------
+
+void EntitySpatialIndex::Query(const Box& region, std::vector<std::uint64_t>& handles) const {
+    if (m_root < 0) return;
+
+    std::vector<std::int32_t> stack;
+    stack.push_back(m_root);
+    while (!stack.empty()) {
+        const Node& node = m_nodes[stack.back()];
+        stack.pop_back();
+        for (int i = 0; i < node.count; ++i) {
+            if (!region.Intersects(node.boxes[i])) continue;
+            if (node.leaf) {
+                handles.push_back(node.ids[i]);
+            } else {
+                stack.push_back(static_cast<std::int32_t>(node.ids[i]));
+            }
+        }
+    }
+}
+
+void EntitySpatialIndex::QueryBatch(const std::vector<Box>& regions,
+                                    std::vector<std::vector<std::uint64_t>>& handlesPerRegion) const {
+    handlesPerRegion.assign(regions.size(), std::vector<std::uint64_t>());
+    if (m_root < 0) return;
+
+    // One traversal serves up to 64 regions; each stack item carries the regions still live below it
+    struct Pending {
+        std::int32_t node;
+        std::uint64_t mask;
+    };
+    std::vector<Pending> stack;
+
+    for (size_t base = 0; base < regions.size(); base += 64) {
+        const size_t groupSize = std::min<size_t>(64, regions.size() - base);
+        const std::uint64_t allMask = (groupSize == 64) ? ~0ull : ((1ull << groupSize) - 1);
+
+        stack.clear();
+        stack.push_back(Pending{ m_root, allMask });
+        while (!stack.empty()) {
+            const Pending item = stack.back();
+            stack.pop_back();
+            const Node& node = m_nodes[item.node];
+
+            for (int i = 0; i < node.count; ++i) {
+                std::uint64_t hits = 0;
+                for (std::uint64_t live = item.mask; live != 0; live &= live - 1) {
+                    const int bit = LowestSetBit(live);
+                    if (regions[base + bit].Intersects(node.boxes[i])) {
+                        hits |= 1ull << bit;
+                    }
+                }
+                if (hits == 0) continue;
+
+                if (node.leaf) {
+                    for (std::uint64_t live = hits; live != 0; live &= live - 1) {
+                        const int bit = LowestSetBit(live);
+                        handlesPerRegion[base + bit].push_back(node.ids[i]);
+                    }
+                } else {
+                    stack.push_back(Pending{ static_cast<std::int32_t>(node.ids[i]), hits });
+                }
+            }
+        }
+    }
+}
+
+bool EntitySpatialIndex::GetBox(std::uint64_t handle, Box& box) const {
+    auto it = m_leafOf.find(handle);
+    if (it == m_leafOf.end()) return false;
+
+    const Node& leaf = m_nodes[it->second];
+    for (int i = 0; i < leaf.count; ++i) {
+        if (leaf.ids[i] == handle) {
+            box = leaf.boxes[i];
+            return true;
+        }
+    }
+    return false;
+}
+
+bool EntitySpatialIndex::Contains(std::uint64_t handle) const {
+    return m_leafOf.find(handle) != m_leafOf.end();
+}
+
+int EntitySpatialIndex::GetHeight() const {
+    if (m_root < 0) return 0;
+
+    int height = 1;
+    std::int32_t nodeIndex = m_root;
+    while (!m_nodes[nodeIndex].leaf) {
+        nodeIndex = static_cast<std::int32_t>(m_nodes[nodeIndex].ids[0]);
+        height++;
+    }
+    return height;
+}
+
+} // namespace EnhancedTakeoff
@@ -0,0 +1,100 @@
+// EntitySpatialIndex.h - R-tree of entity bounding boxes keyed by entity handle
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <unordered_map>
+
+namespace EnhancedTakeoff {
+
+class EntitySnapshotStore;
+
+/**
+ * Bulk-loaded, incrementally updatable R-tree over entity bounding boxes
+ * Bulk load uses Sort-Tile-Recursive packing; inserts choose the least-enlargement
+ * subtree and split along the wider axis. Entries are keyed by entity handle
+ * COPILOT-HINT: Boundary queries go through here instead of scanning the drawing per boundary
+ */
+class EntitySpatialIndex {
+public:
+    struct Box {
+        double minX, minY, maxX, maxY;
+
+        Box() : minX(0.0), minY(0.0), maxX(0.0), maxY(0.0) {}
+        Box(double x0, double y0, double x1, double y1) : minX(x0), minY(y0), maxX(x1), maxY(y1) {}
+
+        bool Intersects(const Box& other) const {
+            return minX <= other.maxX && other.minX <= maxX &&
+                   minY <= other.maxY && other.minY <= maxY;
+        }
+        bool Contains(double x, double y) const {
+            return x >= minX && x <= maxX && y >= minY && y <= maxY;
+        }
+        double Area() const { return (maxX - minX) * (maxY - minY); }
+        void Expand(const Box& other);
+    };
+
+    struct Entry {
+        std::uint64_t handle;
+        Box box;
+
+        Entry() : handle(0) {}
+        Entry(std::uint64_t h, const Box& b) : handle(h), box(b) {}
+    };
+
+    static const int kMaxEntries = 16;
+
+    EntitySpatialIndex();
+    ~EntitySpatialIndex();
+
+    // Construction - bulk load replaces the whole tree
+    void BulkLoad(const std::vector<Entry>& entries);
+    void BuildFromSnapshot(const EntitySnapshotStore& store);
+    void Clear();
+
+    // Incremental maintenance (Insert of an existing handle acts as Update)
+    void Insert(std::uint64_t handle, const Box& box);
+    bool Update(std::uint64_t handle, const Box& box);
+    bool Remove(std::uint64_t handle);
+
+    // Queries
+    void Query(const Box& region, std::vector<std::uint64_t>& handles) const;
+    void QueryBatch(const std::vector<Box>& regions,
+                    std::vector<std::vector<std::uint64_t>>& handlesPerRegion) const;
+    bool GetBox(std::uint64_t handle, Box& box) const;
+    bool Contains(std::uint64_t handle) const;
+
+    size_t GetEntryCount() const { return m_leafOf.size(); }
+    int GetHeight() const;
+
+private:
+    struct Node {
+        std::int32_t parent;
+        std::uint16_t count;
+        bool leaf;
+        Box boxes[kMaxEntries];
+        std::uint64_t ids[kMaxEntries];   // Entity handle in leaves, child node index otherwise
+
+        Node() : parent(-1), count(0), leaf(true) {}
+        Box Bounds() const;
+    };
+
+    std::vector<Node> m_nodes;
+    std::vector<std::int32_t> m_freeNodes;
+    std::int32_t m_root;
+    std::unordered_map<std::uint64_t, std::int32_t> m_leafOf;   // Handle -> leaf node
+
+    std::int32_t AllocateNode(bool leaf);
+    void FreeNode(std::int32_t index);
+    std::int32_t ChooseLeaf(const Box& box) const;
+    void AddToNode(std::int32_t nodeIndex, std::uint64_t id, const Box& box);
+    void SplitNode(std::int32_t nodeIndex, std::uint64_t id, const Box& box);
+    void RefreshBoundsUpward(std::int32_t nodeIndex);
+    int FindChildSlot(std::int32_t parentIndex, std::int32_t childIndex) const;
+    void RemoveEmptyNode(std::int32_t nodeIndex);
+    void SetChildParent(const Node& node);
+    std::vector<std::int32_t> PackLevel(std::vector<Entry>& items, bool leafLevel);
+};
+
+} // namespace EnhancedTakeoff
@@ -7,6 +7,8 @@
 #include <memory>
 #include <functional>
 
+#include "NameTable.h"
+
 namespace EnhancedTakeoff {
 
 /**
@@ -17,11 +19,11 @@ class FeederSheetManager {
 public:
     struct CellMapping {
         int colorIndex;
-        std::string materialName;
-        std::string worksheet;         // "Feeder", "Plan_B", etc.
+        InternedName materialName;
+        InternedName worksheet;        // "Feeder", "Plan_B", etc.
         std::string cellReference;     // "B15", "C22:C25", etc.
         std::string formula;           // Optional formula to preserve
-        std::string measurementType;   // "LF", "SF", "EA", etc.
+        InternedName measurementType;  // "LF", "SF", "EA", etc.
         double lastValue;
         bool preserveFormula;
         
@@ -68,7 +68,8 @@ void FlexibilityAdapter::InitializeCommonMaterials(FlexibleColorAssignment* flex
         {"User Defined 2", 0.00, "Custom material 2"}
     };
     
-    // Create default assignments - users can override these
+    // Create default assignments - users can override these; listeners hear about all of them once
+    FlexibleColorAssignment::UpdateBatch batch(*flexSystem);
     for (size_t i = 0; i < materials.size() && i < 16; ++i) {
         FlexibleColorAssignment::ColorAssignment assignment;
         assignment.colorIndex = static_cast<int>(i + 1);
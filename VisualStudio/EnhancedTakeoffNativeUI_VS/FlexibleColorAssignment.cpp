@@ -4,6 +4,9 @@
 
 #include "pch.h"
 #include "FlexibleColorAssignment.h"
+#include "MeasurementTypeKernels.h"
+#include "AciPalette.h"
+#include "MaterialPresetParser.h"
 
 #ifdef HAS_BRX_SDK
 #include "dbcolor.h"
@@ -15,27 +18,146 @@
 #endif
 
 #include <fstream>
-#include <sstream>
 #include <algorithm>
+#include <charconv>
+#include <cstdint>
+#include <cstdio>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
 
 namespace EnhancedTakeoff {
 
-FlexibleColorAssignment::FlexibleColorAssignment() {
+namespace {
+    // RFC 4180 - quote only when the text would otherwise split or lose characters
+    std::string QuoteCsvField(const std::string& text) {
+        if (text.find_first_of(",\"\r\n") == std::string::npos) {
+            return text;
+        }
+        std::string quoted = "\"";
+        for (char c : text) {
+            quoted += c;
+            if (c == '"') quoted += '"';
+        }
+        return quoted + "\"";
+    }
+    
+    bool SameAssignment(const FlexibleColorAssignment::ColorAssignment& a,
+                        const FlexibleColorAssignment::ColorAssignment& b) {
+        return a.colorIndex == b.colorIndex && a.materialName == b.materialName &&
+               a.measurementTypes == b.measurementTypes && a.unitCost == b.unitCost &&
+               a.excelCell == b.excelCell && a.excelFormula == b.excelFormula &&
+               a.description == b.description && a.isActive == b.isActive &&
+               a.red == b.red && a.green == b.green && a.blue == b.blue && a.isTrueColor == b.isTrueColor;
+    }
+}
+
+/**
+ * Background dispatch for async mask listeners - one worker, masks posted while it is busy
+ * are merged so a slow listener sees fewer, wider updates rather than a backlog
+ */
+class FlexibleColorAssignment::AsyncNotifier {
+public:
+    AsyncNotifier() : m_hasPending(false), m_running(false), m_stop(false) {}
+    
+    ~AsyncNotifier() {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stop = true;
+        }
+        m_wake.notify_all();
+        if (m_worker.joinable()) {
+            m_worker.join();
+        }
+    }
+    
+    void Add(ColorMaskCallback callback) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_callbacks.push_back(callback);
+        if (!m_worker.joinable()) {
+            m_worker = std::thread(&AsyncNotifier::Run, this);
+        }
+    }
+    
+    void Post(const ColorMask& changedColors) {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_pending |= changedColors;
+            m_hasPending = true;
+        }
+        m_wake.notify_one();
+    }
+    
+    void Flush() {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_idle.wait(lock, [this] { return !m_hasPending && !m_running; });
+    }
+    
+private:
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::condition_variable m_idle;
+    std::vector<ColorMaskCallback> m_callbacks;
+    ColorMask m_pending;
+    bool m_hasPending;
+    bool m_running;
+    bool m_stop;
+    std::thread m_worker;
+    
+    void Run() {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        for (;;) {
+            m_wake.wait(lock, [this] { return m_stop || m_hasPending; });
+            if (!m_hasPending) {
+                break;  // Stopping with nothing left to deliver
+            }
+            
+            const ColorMask changedColors = m_pending;
+            const std::vector<ColorMaskCallback> callbacks = m_callbacks;
+            m_pending.Clear();
+            m_hasPending = false;
+            m_running = true;
+            
+            lock.unlock();
+            for (const auto& callback : callbacks) {
+                callback(changedColors);
+            }
+            lock.lock();
+            
+            m_running = false;
+            m_idle.notify_all();
+        }
+    }
+};
+
+FlexibleColorAssignment::FlexibleColorAssignment()
+    : m_state(std::make_shared<State>()), m_pinnedPages(0), m_updateDepth(0) {
     // Initialize with NO fixed assignments - everything user-defined
     // COPILOT-HINT: This replaces ColorMaterialMapper fixed patterns
+    static_assert(kPageCount <= 16, "m_pinnedPages holds one bit per page");
     
-    m_materialLibrary = {
+    // Every page starts out as the same empty page - the first write to each copies it
+    const std::shared_ptr<Page> empty = std::make_shared<Page>();
+    for (auto& page : m_state->pages) {
+        page = empty;
+    }
+    m_state->trueColors = std::make_shared<TrueColors>();
+    
+    m_materialLibrary.Assign({
         "Interior Wall", "Exterior Wall", "Framing", "Roofing", 
         "Foundation", "MEP", "Siding", "Trim", "Windows", "Doors",
         "Flooring", "Electrical", "Plumbing", "HVAC", "Insulation",
         "Custom Material", "User Defined"
-    };
+    });
 }
 
 FlexibleColorAssignment::~FlexibleColorAssignment() {
-    // Clean up all callbacks
+    // Clean up all callbacks - async listeners get any pending dispatch before the worker stops
+    m_asyncNotifier.reset();
     m_callbacks.clear();
-    m_assignments.clear();
+    m_maskCallbacks.clear();
+    m_undo.clear();
+    m_redo.clear();
     m_boundaryFilters.clear();
 }
 
@@ -43,8 +165,7 @@ bool FlexibleColorAssignment::AssignColor(int colorIndex, const ColorAssignment&
     if (colorIndex < 1 || colorIndex > 255) return false;
     
     // Store the assignment - completely flexible, no restrictions
-    m_assignments[colorIndex] = assignment;
-    m_assignments[colorIndex].colorIndex = colorIndex; // Ensure consistency
+    StoreSlot(colorIndex, assignment);
     
     NotifyColorChange(colorIndex);
     return true;
@@ -58,30 +179,63 @@ bool FlexibleColorAssignment::AssignTrueColor(int r, int g, int b, const ColorAs
     trueColorAssignment.green = g;
     trueColorAssignment.blue = b;
     trueColorAssignment.isTrueColor = true;
-    trueColorAssignment.colorIndex = GetColorFromRGB(r, g, b);
+    trueColorAssignment.colorIndex = GetColorFromRGB(r, g, b);  // ACI fallback bucket, for display
+    
+    // Stored under the exact RGB - two true colors near the same ACI entry never collide
+    const std::uint32_t rgb = TrueColorTable::Pack(r, g, b);
+    TrueColors& trueColors = EditTrueColors();
+    const std::uint32_t existing = trueColors.slots.Find(rgb);
+    if (existing != TrueColorTable::kNotFound) {
+        trueColors.records[existing] = trueColorAssignment;
+    } else {
+        trueColors.slots.Insert(rgb, static_cast<std::uint32_t>(trueColors.records.size()));
+        trueColors.records.push_back(trueColorAssignment);
+    }
     
-    return AssignColor(trueColorAssignment.colorIndex, trueColorAssignment);
+    NotifyColorChange(trueColorAssignment.colorIndex);
+    return true;
 }
 
 bool FlexibleColorAssignment::RemoveColorAssignment(int colorIndex) {
-    auto it = m_assignments.find(colorIndex);
-    if (it != m_assignments.end()) {
-        m_assignments.erase(it);
+    if (IsOccupied(colorIndex)) {
+        ClearSlot(colorIndex);
         NotifyColorChange(colorIndex);
         return true;
     }
     return false;
 }
 
+bool FlexibleColorAssignment::RemoveTrueColorAssignment(int r, int g, int b) {
+    if (r < 0 || r > 255 || g < 0 || g > 255 || b < 0 || b > 255) return false;
+    
+    const std::uint32_t rgb = TrueColorTable::Pack(r, g, b);
+    const std::uint32_t index = m_state->trueColors->slots.Find(rgb);
+    if (index == TrueColorTable::kNotFound) return false;
+    
+    // Keep the records dense - the last one moves into the freed position
+    TrueColors& trueColors = EditTrueColors();
+    const int colorIndex = trueColors.records[index].colorIndex;
+    const ColorAssignment& last = trueColors.records.back();
+    if (index + 1 != trueColors.records.size()) {
+        trueColors.slots.Insert(TrueColorTable::Pack(last.red, last.green, last.blue), index);
+        trueColors.records[index] = last;
+    }
+    trueColors.records.pop_back();
+    trueColors.slots.Erase(rgb);
+    
+    NotifyColorChange(colorIndex);
+    return true;
+}
+
 void FlexibleColorAssignment::ClearAllAssignments() {
-    m_assignments.clear();
+    ClearAllSlots();
     NotifyColorChange(-1); // -1 indicates all colors changed
 }
 
 bool FlexibleColorAssignment::UpdateMaterial(int colorIndex, const std::string& materialName) {
-    auto it = m_assignments.find(colorIndex);
-    if (it != m_assignments.end()) {
-        it->second.materialName = materialName;
+    if (IsOccupied(colorIndex)) {
+        EditSlot(colorIndex).materialName = materialName;
+        SyncHotSlot(colorIndex);
         NotifyColorChange(colorIndex);
         return true;
     }
@@ -89,9 +243,9 @@ bool FlexibleColorAssignment::UpdateMaterial(int colorIndex, const std::string&
 }
 
 bool FlexibleColorAssignment::UpdateUnitCost(int colorIndex, double unitCost) {
-    auto it = m_assignments.find(colorIndex);
-    if (it != m_assignments.end()) {
-        it->second.unitCost = unitCost;
+    if (IsOccupied(colorIndex)) {
+        EditSlot(colorIndex).unitCost = unitCost;
+        SyncHotSlot(colorIndex);
         NotifyColorChange(colorIndex);
         return true;
     }
@@ -100,10 +254,11 @@ bool FlexibleColorAssignment::UpdateUnitCost(int colorIndex, double unitCost) {
 
 bool FlexibleColorAssignment::UpdateExcelMapping(int colorIndex, const std::string& cell, 
                                                  const std::string& formula) {
-    auto it = m_assignments.find(colorIndex);
-    if (it != m_assignments.end()) {
-        it->second.excelCell = cell;
-        it->second.excelFormula = formula;
+    if (IsOccupied(colorIndex)) {
+        ColorAssignment& assignment = EditSlot(colorIndex);
+        assignment.excelCell = cell;
+        assignment.excelFormula = formula;
+        SyncHotSlot(colorIndex);
         NotifyColorChange(colorIndex);
         return true;
     }
@@ -111,11 +266,11 @@ bool FlexibleColorAssignment::UpdateExcelMapping(int colorIndex, const std::stri
 }
 
 bool FlexibleColorAssignment::AddMeasurementType(int colorIndex, MeasurementType type) {
-    auto it = m_assignments.find(colorIndex);
-    if (it != m_assignments.end()) {
-        auto& types = it->second.measurementTypes;
+    if (IsOccupied(colorIndex)) {
+        const auto& types = Cold(colorIndex).measurementTypes;
         if (std::find(types.begin(), types.end(), type) == types.end()) {
-            types.push_back(type);
+            EditSlot(colorIndex).measurementTypes.push_back(type);
+            SyncHotSlot(colorIndex);
             NotifyColorChange(colorIndex);
             return true;
         }
@@ -124,12 +279,12 @@ bool FlexibleColorAssignment::AddMeasurementType(int colorIndex, MeasurementType
 }
 
 bool FlexibleColorAssignment::RemoveMeasurementType(int colorIndex, MeasurementType type) {
-    auto it = m_assignments.find(colorIndex);
-    if (it != m_assignments.end()) {
-        auto& types = it->second.measurementTypes;
-        auto typeIt = std::find(types.begin(), types.end(), type);
-        if (typeIt != types.end()) {
-            types.erase(typeIt);
+    if (IsOccupied(colorIndex)) {
+        const auto& current = Cold(colorIndex).measurementTypes;
+        if (std::find(current.begin(), current.end(), type) != current.end()) {
+            auto& types = EditSlot(colorIndex).measurementTypes;
+            types.erase(std::find(types.begin(), types.end(), type));
+            SyncHotSlot(colorIndex);
             NotifyColorChange(colorIndex);
             return true;
         }
@@ -139,75 +294,96 @@ bool FlexibleColorAssignment::RemoveMeasurementType(int colorIndex, MeasurementT
 
 std::vector<FlexibleColorAssignment::MeasurementType> 
 FlexibleColorAssignment::GetMeasurementTypes(int colorIndex) const {
-    auto it = m_assignments.find(colorIndex);
-    if (it != m_assignments.end()) {
-        return it->second.measurementTypes;
+    if (IsOccupied(colorIndex)) {
+        return Cold(colorIndex).measurementTypes;
     }
     return {};
 }
 
 FlexibleColorAssignment::ColorAssignment* FlexibleColorAssignment::GetAssignment(int colorIndex) {
-    auto it = m_assignments.find(colorIndex);
-    return (it != m_assignments.end()) ? &it->second : nullptr;
+    if (!IsOccupied(colorIndex)) {
+        return nullptr;
+    }
+    
+    // The caller may edit the record - read it directly until the next update re-syncs the hot slot
+    // Its page is pinned until the next committed change: versions taken meanwhile get their own copy,
+    // so in-place edits never reach a snapshot or an undo step
+    const int page = colorIndex >> kPageBits;
+    ColorAssignment& assignment = DetachPage(page).cold[colorIndex & (kPageSize - 1)];
+    m_pinnedPages |= static_cast<std::uint16_t>(1u << page);
+    m_handedOut.Set(colorIndex);
+    return &assignment;
+}
+
+const FlexibleColorAssignment::ColorAssignment* FlexibleColorAssignment::FindAssignment(int colorIndex) const {
+    return FindSlot(*m_state, colorIndex);
 }
 
 std::vector<FlexibleColorAssignment::ColorAssignment> FlexibleColorAssignment::GetAllAssignments() const {
     std::vector<ColorAssignment> result;
-    result.reserve(m_assignments.size());
+    result.reserve(m_state->occupied.Count());
     
-    for (const auto& pair : m_assignments) {
-        result.push_back(pair.second);
-    }
+    m_state->occupied.ForEach([&](int colorIndex) { result.push_back(Cold(colorIndex)); });
     return result;
 }
 
 std::vector<int> FlexibleColorAssignment::GetAssignedColors() const {
-    std::vector<int> result;
-    result.reserve(m_assignments.size());
+    return m_state->occupied.ToVector();
+}
+
+bool FlexibleColorAssignment::IsColorAssigned(int colorIndex) const {
+    return IsOccupied(colorIndex);
+}
+
+const FlexibleColorAssignment::ColorAssignment* FlexibleColorAssignment::GetTrueColorAssignment(int r, int g, int b) const {
+    if (r < 0 || r > 255 || g < 0 || g > 255 || b < 0 || b > 255) return nullptr;
     
-    for (const auto& pair : m_assignments) {
-        result.push_back(pair.first);
-    }
+    const TrueColors& trueColors = *m_state->trueColors;
+    const std::uint32_t index = trueColors.slots.Find(TrueColorTable::Pack(r, g, b));
+    return (index != TrueColorTable::kNotFound) ? &trueColors.records[index] : nullptr;
+}
+
+std::vector<FlexibleColorAssignment::ColorAssignment> FlexibleColorAssignment::GetAllTrueColorAssignments() const {
+    std::vector<ColorAssignment> result(m_state->trueColors->records);
+    std::sort(result.begin(), result.end(), [](const ColorAssignment& a, const ColorAssignment& b) {
+        return TrueColorTable::Pack(a.red, a.green, a.blue) < TrueColorTable::Pack(b.red, b.green, b.blue);
+    });
     return result;
 }
 
-bool FlexibleColorAssignment::IsColorAssigned(int colorIndex) const {
-    return m_assignments.find(colorIndex) != m_assignments.end();
+bool FlexibleColorAssignment::IsTrueColorAssigned(int r, int g, int b) const {
+    return GetTrueColorAssignment(r, g, b) != nullptr;
+}
+
+const FlexibleColorAssignment::ColorAssignment* FlexibleColorAssignment::ClassifyColor(int colorIndex,
+                                                                                      std::uint32_t rgb) const {
+    return Classify(*m_state, colorIndex, rgb);
 }
 
 std::vector<std::string> FlexibleColorAssignment::GetAvailableMaterials() const {
-    return m_materialLibrary;
+    const MaterialLibrary::View names = m_materialLibrary.GetAll();
+    return std::vector<std::string>(names.begin(), names.end());
 }
 
 bool FlexibleColorAssignment::ImportMaterialLibrary(const std::string& libraryPath) {
-    std::ifstream file(libraryPath);
-    if (!file.is_open()) return false;
-    
-    m_materialLibrary.clear();
-    std::string line;
-    while (std::getline(file, line)) {
-        if (!line.empty()) {
-            m_materialLibrary.push_back(line);
-        }
-    }
-    return true;
+    // One name per line; the library is left as it was when the file cannot be opened
+    return m_materialLibrary.LoadFile(libraryPath);
 }
 
 std::map<std::string, int> FlexibleColorAssignment::GetExcelMappings() const {
     std::map<std::string, int> mappings;
-    for (const auto& pair : m_assignments) {
-        if (!pair.second.excelCell.empty()) {
-            mappings[pair.second.excelCell] = pair.first;
+    m_state->occupied.ForEach([&](int colorIndex) {
+        if (!Cold(colorIndex).excelCell.empty()) {
+            mappings[Cold(colorIndex).excelCell] = colorIndex;
         }
-    }
+    });
     return mappings;
 }
 
 std::string FlexibleColorAssignment::GenerateExcelFormula(int colorIndex, MeasurementType type) const {
-    auto it = m_assignments.find(colorIndex);
-    if (it == m_assignments.end()) return "";
+    if (!IsOccupied(colorIndex)) return "";
     
-    const auto& assignment = it->second;
+    const auto& assignment = Cold(colorIndex);
     if (!assignment.excelFormula.empty()) {
         return assignment.excelFormula;
     }
@@ -242,7 +418,7 @@ bool FlexibleColorAssignment::ShowColorPicker(ColorAssignment& assignment) {
         ACHAR materialName[256] = {0};
         int result = acedGetString(0, _T("\nEnter material name: "), materialName);
         if (result == RTNORM && materialName[0] != 0) {
-            assignment.materialName = CW2A(materialName);
+            assignment.materialName = std::string(CW2A(materialName));
             
             // Get unit cost
             double unitCost = 0.0;
@@ -291,97 +467,139 @@ bool FlexibleColorAssignment::MatchColorFromEntity(const AcDbObjectId& entityId,
 
 double FlexibleColorAssignment::CalculateQuantity(int colorIndex, double rawValue, 
                                                   MeasurementType type, double pitchFactor) const {
-    auto it = m_assignments.find(colorIndex);
-    if (it == m_assignments.end()) return rawValue;
+    if (!IsOccupied(colorIndex)) return rawValue;
     
-    double quantity = rawValue;
+    // Mathematical precision - the per-type kernel applies the pitch/hip factor
+    return GetMeasurementValueKernel(type)(rawValue, pitchFactor);
+}
+
+double FlexibleColorAssignment::CalculateCost(int colorIndex, double quantity) const {
+    if (IsOccupied(colorIndex)) {
+        return quantity * GetUnitCost(colorIndex);
+    }
+    return 0.0;
+}
+
+void FlexibleColorAssignment::CalculateQuantities(const QuantityBatch& batch, double* quantities) const {
+    if (batch.count == 0) return;
     
-    // Apply mathematical precision calculations (not lookup tables)
-    switch (type) {
-        case MeasurementType::LF_PITCH:
-        case MeasurementType::SF_PITCH:
-            quantity *= pitchFactor;
-            break;
-        case MeasurementType::LF_HIP:
-            quantity *= 1.414213562; // sqrt(2) for 45-degree hip
-            break;
-        case MeasurementType::SF:
-        case MeasurementType::LF:
-        case MeasurementType::EA:
-        case MeasurementType::CUSTOM:
-        default:
-            // No modification for standard measurements
-            break;
+    // Group value indices by measurement type (stable counting sort)
+    size_t typeCounts[kMeasurementTypeCount] = {};
+    std::vector<std::uint32_t> order;
+    if (batch.types) {
+        for (size_t i = 0; i < batch.count; ++i) {
+            typeCounts[static_cast<int>(batch.types[i])]++;
+        }
+        size_t typeStart[kMeasurementTypeCount] = {};
+        for (int t = 1; t < kMeasurementTypeCount; ++t) {
+            typeStart[t] = typeStart[t - 1] + typeCounts[t - 1];
+        }
+        order.resize(batch.count);
+        for (size_t i = 0; i < batch.count; ++i) {
+            order[typeStart[static_cast<int>(batch.types[i])]++] = static_cast<std::uint32_t>(i);
+        }
+    } else {
+        typeCounts[static_cast<int>(batch.uniformType)] = batch.count;
     }
     
-    return quantity;
+    // One specialized kernel per type bucket - no per-value switch
+    MeasurementBucket bucket;
+    bucket.colorIndices = batch.colorIndices;
+    bucket.rawValues = batch.rawValues;
+    bucket.pitchFactors = batch.pitchFactors;
+    bucket.assigned = &m_state->occupied;   // Unassigned colors pass raw values through
+    bucket.out = quantities;
+    
+    size_t begin = 0;
+    for (int t = 0; t < kMeasurementTypeCount; ++t) {
+        if (typeCounts[t] == 0) continue;
+        bucket.indices = batch.types ? order.data() + begin : nullptr;
+        bucket.count = typeCounts[t];
+        GetMeasurementBucketKernel(static_cast<MeasurementType>(t))(bucket);
+        begin += typeCounts[t];
+    }
 }
 
-double FlexibleColorAssignment::CalculateCost(int colorIndex, double quantity) const {
-    auto it = m_assignments.find(colorIndex);
-    if (it != m_assignments.end()) {
-        return quantity * it->second.unitCost;
+void FlexibleColorAssignment::CalculateCosts(const int* colorIndices, const double* quantities,
+                                             size_t count, double* costs) const {
+    // Straight gather from the hot slots; unassigned colors cost nothing
+    for (size_t i = 0; i < count; ++i) {
+        const int colorIndex = colorIndices[i];
+        costs[i] = IsOccupied(colorIndex) ? quantities[i] * GetUnitCost(colorIndex) : 0.0;
     }
-    return 0.0;
 }
 
 bool FlexibleColorAssignment::SavePreset(const std::string& presetName, const std::string& filePath) const {
-    std::ofstream file(filePath);
+    std::ofstream file(filePath, std::ios::binary);
     if (!file.is_open()) return false;
     
-    // Save as simple CSV format
+    // Save as simple CSV format - MaterialPresetParser reads it back
     file << "ColorIndex,MaterialName,UnitCost,ExcelCell,ExcelFormula,MeasurementType,Description\n";
     
-    for (const auto& pair : m_assignments) {
-        const auto& assignment = pair.second;
-        file << assignment.colorIndex << ","
-             << assignment.materialName << ","
-             << assignment.unitCost << ","
-             << assignment.excelCell << ","
-             << assignment.excelFormula << ",";
-             
-        // Save first measurement type
-        if (!assignment.measurementTypes.empty()) {
-            file << GetMeasurementTypeString(assignment.measurementTypes[0]);
+    auto writeRow = [&](const std::string& color, const ColorAssignment& assignment) {
+        // Shortest text that parses back to the same cost
+        char cost[32];
+        const auto result = std::to_chars(cost, cost + sizeof(cost), assignment.unitCost);
+        
+        file << color << ","
+             << QuoteCsvField(assignment.materialName) << ","
+             << std::string(cost, result.ptr) << ","
+             << QuoteCsvField(assignment.excelCell) << ","
+             << QuoteCsvField(assignment.excelFormula) << ",";
+        
+        // Every measurement type, '|' separated
+        for (size_t t = 0; t < assignment.measurementTypes.size(); ++t) {
+            file << (t ? "|" : "") << MaterialPresetParser::GetMeasurementTypeName(assignment.measurementTypes[t]);
         }
-        file << "," << assignment.description << "\n";
+        file << "," << QuoteCsvField(assignment.description) << "\n";
+    };
+    
+    m_state->occupied.ForEach([&](int colorIndex) { writeRow(std::to_string(colorIndex), Cold(colorIndex)); });
+    
+    // True colors follow as #RRGGBB rows
+    for (const auto& assignment : GetAllTrueColorAssignments()) {
+        char rgb[8];
+        std::snprintf(rgb, sizeof(rgb), "#%06X", TrueColorTable::Pack(assignment.red, assignment.green, assignment.blue));
+        writeRow(rgb, assignment);
     }
     
-    return true;
+    return file.good();
 }
 
-bool FlexibleColorAssignment::LoadPreset(const std::string& filePath) {
-    std::ifstream file(filePath);
-    if (!file.is_open()) return false;
-    
-    m_assignments.clear();
+bool FlexibleColorAssignment::LoadPreset(const std::string& filePath, std::vector<PresetError>* errors) {
+    // Parse and validate everything before the live table is touched
+    std::vector<ColorAssignment> rows;
+    std::vector<PresetError> parseErrors;
+    const bool parsed = MaterialPresetParser::ParseFile(filePath, rows, parseErrors);
+    if (errors) {
+        errors->swap(parseErrors);
+    }
+    if (!parsed) {
+        return false;
+    }
     
-    std::string line;
-    std::getline(file, line); // Skip header
+    // Listeners hear about the load once
+    UpdateBatch batch(*this);
+    ClearAllSlots();
+    NotifyColorChange(-1);
     
-    while (std::getline(file, line)) {
-        std::istringstream ss(line);
-        std::string token;
-        ColorAssignment assignment;
-        
-        // Parse CSV line
-        if (std::getline(ss, token, ',')) assignment.colorIndex = std::stoi(token);
-        if (std::getline(ss, token, ',')) assignment.materialName = token;
-        if (std::getline(ss, token, ',')) assignment.unitCost = std::stod(token);
-        if (std::getline(ss, token, ',')) assignment.excelCell = token;
-        if (std::getline(ss, token, ',')) assignment.excelFormula = token;
-        if (std::getline(ss, token, ',')) {
-            // Parse measurement type
-            assignment.measurementTypes.clear();
-            assignment.measurementTypes.push_back(MeasurementType::LF); // Default
+    // Later rows for the same color replace earlier ones
+    TrueColors& trueColors = EditTrueColors();
+    for (auto& row : rows) {
+        if (row.isTrueColor) {
+            row.colorIndex = GetColorFromRGB(row.red, row.green, row.blue);
+            const std::uint32_t rgb = TrueColorTable::Pack(row.red, row.green, row.blue);
+            const std::uint32_t existing = trueColors.slots.Find(rgb);
+            if (existing != TrueColorTable::kNotFound) {
+                trueColors.records[existing] = std::move(row);
+            } else {
+                trueColors.slots.Insert(rgb, static_cast<std::uint32_t>(trueColors.records.size()));
+                trueColors.records.push_back(std::move(row));
+            }
+        } else {
+            StoreSlot(row.colorIndex, row);
         }
-        if (std::getline(ss, token, ',')) assignment.description = token;
-        
-        assignment.isActive = true;
-        m_assignments[assignment.colorIndex] = assignment;
     }
-    
-    NotifyColorChange(-1); // Notify all colors changed
     return true;
 }
 
@@ -391,13 +609,13 @@ std::vector<std::string> FlexibleColorAssignment::GetAvailablePresets() const {
 }
 
 std::vector<int> FlexibleColorAssignment::GetColorsInBoundary(const std::string& boundaryName) const {
-    auto it = m_boundaryFilters.find(boundaryName);
+    auto it = m_boundaryFilters.find(InternedName::Find(boundaryName));
     return (it != m_boundaryFilters.end()) ? it->second : std::vector<int>();
 }
 
 void FlexibleColorAssignment::SetBoundaryFilter(const std::string& boundaryName, 
                                                const std::vector<int>& colorIndices) {
-    m_boundaryFilters[boundaryName] = colorIndices;
+    m_boundaryFilters[InternedName(boundaryName)] = colorIndices;
 }
 
 void FlexibleColorAssignment::RegisterColorChangeCallback(ColorChangeCallback callback) {
@@ -406,27 +624,359 @@ void FlexibleColorAssignment::RegisterColorChangeCallback(ColorChangeCallback ca
     }
 }
 
+void FlexibleColorAssignment::RegisterColorMaskCallback(ColorMaskCallback callback, DispatchMode mode) {
+    if (!callback) {
+        return;
+    }
+    if (mode == DispatchMode::Async) {
+        if (!m_asyncNotifier) {
+            m_asyncNotifier.reset(new AsyncNotifier());
+        }
+        m_asyncNotifier->Add(callback);
+    } else {
+        m_maskCallbacks.push_back(callback);
+    }
+}
+
+void FlexibleColorAssignment::FlushAsyncNotifications() {
+    if (m_asyncNotifier) {
+        m_asyncNotifier->Flush();
+    }
+}
+
+void FlexibleColorAssignment::BeginUpdate() {
+    ++m_updateDepth;
+}
+
+void FlexibleColorAssignment::EndUpdate() {
+    if (m_updateDepth > 0 && --m_updateDepth == 0) {
+        CommitChanges();
+    }
+}
+
+FlexibleColorAssignment::Snapshot FlexibleColorAssignment::TakeSnapshot() const {
+    Snapshot snapshot;
+    snapshot.m_state = CaptureState();
+    return snapshot;
+}
+
+void FlexibleColorAssignment::RestoreSnapshot(const Snapshot& snapshot) {
+    if (!snapshot.IsValid()) {
+        return;
+    }
+    BeginEdit();
+    InstallState(snapshot.m_state);
+}
+
+ColorMask FlexibleColorAssignment::GetChangedColors(const Snapshot& from, const Snapshot& to) {
+    if (!from.IsValid() || !to.IsValid()) {
+        return ColorMask::All();
+    }
+    return DiffStates(*from.m_state, *to.m_state);
+}
+
+bool FlexibleColorAssignment::Undo() {
+    if (m_undo.empty() || m_updateDepth > 0) {
+        return false;
+    }
+    const std::shared_ptr<const State> previous = m_undo.back();
+    m_undo.pop_back();
+    m_redo.push_back(CaptureState());
+    InstallState(previous);
+    return true;
+}
+
+bool FlexibleColorAssignment::Redo() {
+    if (m_redo.empty() || m_updateDepth > 0) {
+        return false;
+    }
+    const std::shared_ptr<const State> next = m_redo.back();
+    m_redo.pop_back();
+    m_undo.push_back(CaptureState());
+    InstallState(next);
+    return true;
+}
+
+void FlexibleColorAssignment::ClearHistory() {
+    m_undo.clear();
+    m_redo.clear();
+}
+
 void FlexibleColorAssignment::NotifyColorChange(int colorIndex) {
+    if (colorIndex < 0) {
+        NotifyColorChanges(ColorMask::All());
+        return;
+    }
+    ColorMask changedColors;
+    changedColors.Set(colorIndex);
+    NotifyColorChanges(changedColors);
+}
+
+void FlexibleColorAssignment::NotifyColorChanges(const ColorMask& changedColors) {
+    // Coalesce into the pending mask; outside a batch it is dispatched straight away
+    m_pendingColors |= changedColors;
+    if (m_updateDepth == 0) {
+        CommitChanges();
+    }
+}
+
+void FlexibleColorAssignment::CommitChanges() {
+    // The outermost change is complete - the table it started from becomes one undo step
+    std::shared_ptr<const State> base;
+    base.swap(m_editBase);
+    if (m_pendingColors.IsEmpty()) {
+        return;
+    }
+    if (base) {
+        m_undo.push_back(base);
+        if (m_undo.size() > kMaxUndoSteps) {
+            m_undo.pop_front();
+        }
+        m_redo.clear();
+    }
+    
+    // Before dispatch, so records a listener asks for stay pinned until the change after this one
+    ReleaseHandedOut();
+    
+    const ColorMask changedColors = m_pendingColors;
+    m_pendingColors.Clear();
+    DispatchColorChanges(changedColors);
+}
+
+void FlexibleColorAssignment::ReleaseHandedOut() {
+    // Handed-out records expire with the change - fold their edits into the hot slots and let
+    // their pages be shared again
+    m_handedOut.ForEach([this](int colorIndex) {
+        SyncHot(*m_state->pages[colorIndex >> kPageBits], colorIndex & (kPageSize - 1));
+    });
+    m_handedOut.Clear();
+    m_pinnedPages = 0;
+}
+
+void FlexibleColorAssignment::DispatchColorChanges(const ColorMask& changedColors) {
+    // Single-color listeners keep their old contract: the index for one change, -1 for several
+    int colorIndex = -1;
+    if (changedColors.Count() == 1) {
+        changedColors.ForEach([&colorIndex](int changed) { colorIndex = changed; });
+    }
     for (auto& callback : m_callbacks) {
         if (callback) {
             callback(colorIndex);
         }
     }
+    for (auto& callback : m_maskCallbacks) {
+        callback(changedColors);
+    }
+    if (m_asyncNotifier) {
+        m_asyncNotifier->Post(changedColors);
+    }
+}
+
+void FlexibleColorAssignment::BeginEdit() {
+    if (!m_editBase) {
+        m_editBase = CaptureState();
+    }
+}
+
+FlexibleColorAssignment::State& FlexibleColorAssignment::DetachState() {
+    if (m_state.use_count() > 1) {
+        m_state = std::make_shared<State>(*m_state);
+    }
+    return *m_state;
+}
+
+FlexibleColorAssignment::Page& FlexibleColorAssignment::DetachPage(int page) {
+    // Pinned pages are never shared, so they are always written in place
+    State& state = DetachState();
+    if (state.pages[page].use_count() > 1) {
+        state.pages[page] = std::make_shared<Page>(*state.pages[page]);
+    }
+    return *state.pages[page];
+}
+
+FlexibleColorAssignment::ColorAssignment& FlexibleColorAssignment::EditSlot(int colorIndex) {
+    BeginEdit();
+    return DetachPage(colorIndex >> kPageBits).cold[colorIndex & (kPageSize - 1)];
+}
+
+FlexibleColorAssignment::TrueColors& FlexibleColorAssignment::EditTrueColors() {
+    BeginEdit();
+    State& state = DetachState();
+    if (state.trueColors.use_count() > 1) {
+        state.trueColors = std::make_shared<TrueColors>(*state.trueColors);
+    }
+    return *state.trueColors;
+}
+
+std::shared_ptr<const FlexibleColorAssignment::State> FlexibleColorAssignment::CaptureState() const {
+    if (m_pinnedPages == 0) {
+        return m_state;     // Shared - the next write copies the root and the page it touches
+    }
+    
+    // Callers hold pointers into pinned pages, so the captured version gets copies, with hot slots in sync
+    std::shared_ptr<State> captured = std::make_shared<State>(*m_state);
+    for (int page = 0; page < kPageCount; ++page) {
+        if (m_pinnedPages & (1u << page)) {
+            captured->pages[page] = std::make_shared<Page>(*m_state->pages[page]);
+            for (int slot = 0; slot < kPageSize; ++slot) {
+                if (m_handedOut.Test(page * kPageSize + slot)) {
+                    SyncHot(*captured->pages[page], slot);
+                }
+            }
+        }
+    }
+    return captured;
+}
+
+void FlexibleColorAssignment::InstallState(const std::shared_ptr<const State>& state) {
+    const ColorMask changedColors = DiffStates(*m_state, *state);
+    
+    if (m_pinnedPages == 0) {
+        // Shared, not copied - DetachState/DetachPage copy it before any write
+        m_state = std::const_pointer_cast<State>(state);
+    } else {
+        // Pinned pages stay where they are and take the installed contents
+        std::shared_ptr<State> installed = std::make_shared<State>(*state);
+        for (int page = 0; page < kPageCount; ++page) {
+            if (m_pinnedPages & (1u << page)) {
+                *m_state->pages[page] = *state->pages[page];
+                installed->pages[page] = m_state->pages[page];
+            }
+        }
+        m_state = installed;
+    }
+    m_handedOut.Clear();
+    
+    NotifyColorChanges(changedColors);
+}
+
+ColorMask FlexibleColorAssignment::DiffStates(const State& from, const State& to) {
+    // Pages still shared between the two versions cannot differ
+    ColorMask changedColors;
+    for (int page = 0; page < kPageCount; ++page) {
+        if (from.pages[page] == to.pages[page]) {
+            continue;
+        }
+        for (int slot = 0; slot < kPageSize; ++slot) {
+            const int colorIndex = page * kPageSize + slot;
+            const bool wasAssigned = from.occupied.Test(colorIndex);
+            if (wasAssigned != to.occupied.Test(colorIndex) ||
+                (wasAssigned && !SameAssignment(from.pages[page]->cold[slot], to.pages[page]->cold[slot]))) {
+                changedColors.Set(colorIndex);
+            }
+        }
+    }
+    
+    // True colors report through their ACI fallback bucket, as AssignTrueColor notifies
+    if (from.trueColors != to.trueColors) {
+        for (const auto& assignment : from.trueColors->records) {
+            const std::uint32_t index = to.trueColors->slots.Find(TrueColorTable::Pack(assignment.red, assignment.green, assignment.blue));
+            if (index == TrueColorTable::kNotFound || !SameAssignment(assignment, to.trueColors->records[index])) {
+                changedColors.Set(assignment.colorIndex);
+            }
+        }
+        for (const auto& assignment : to.trueColors->records) {
+            if (!from.trueColors->slots.Contains(TrueColorTable::Pack(assignment.red, assignment.green, assignment.blue))) {
+                changedColors.Set(assignment.colorIndex);
+            }
+        }
+    }
+    return changedColors;
+}
+
+const FlexibleColorAssignment::ColorAssignment* FlexibleColorAssignment::FindSlot(const State& state, int colorIndex) {
+    if (!state.occupied.Test(colorIndex)) {
+        return nullptr;
+    }
+    return &state.pages[colorIndex >> kPageBits]->cold[colorIndex & (kPageSize - 1)];
+}
+
+const FlexibleColorAssignment::ColorAssignment* FlexibleColorAssignment::Classify(const State& state, int colorIndex,
+                                                                                 std::uint32_t rgb) {
+    const std::uint32_t index = state.trueColors->slots.Find(rgb);
+    if (index != TrueColorTable::kNotFound) {
+        return &state.trueColors->records[index];
+    }
+    return FindSlot(state, colorIndex);
+}
+
+void FlexibleColorAssignment::StoreSlot(int colorIndex, const ColorAssignment& assignment) {
+    ColorAssignment& stored = EditSlot(colorIndex);
+    stored = assignment;
+    stored.colorIndex = colorIndex; // Ensure consistency
+    DetachState().occupied.Set(colorIndex);
+    SyncHotSlot(colorIndex);
+}
+
+void FlexibleColorAssignment::ClearSlot(int colorIndex) {
+    EditSlot(colorIndex) = ColorAssignment();
+    DetachState().occupied.Reset(colorIndex);
+    m_handedOut.Reset(colorIndex);
+    DetachPage(colorIndex >> kPageBits).hot[colorIndex & (kPageSize - 1)] = HotSlot();
+}
+
+void FlexibleColorAssignment::ClearAllSlots() {
+    BeginEdit();
+    State& state = DetachState();
+    
+    // Unpinned pages all drop to one fresh empty page rather than being cleared slot by slot
+    const std::shared_ptr<Page> empty = std::make_shared<Page>();
+    for (int page = 0; page < kPageCount; ++page) {
+        if (m_pinnedPages & (1u << page)) {
+            *state.pages[page] = Page();
+        } else {
+            state.pages[page] = empty;
+        }
+    }
+    state.occupied.Clear();
+    state.trueColors = std::make_shared<TrueColors>();
+    m_handedOut.Clear();
+}
+
+void FlexibleColorAssignment::SyncHotSlot(int colorIndex) {
+    SyncHot(DetachPage(colorIndex >> kPageBits), colorIndex & (kPageSize - 1));
+    m_handedOut.Reset(colorIndex);
+}
+
+void FlexibleColorAssignment::SyncHot(Page& page, int slot) {
+    page.hot[slot].unitCost = page.cold[slot].unitCost;
+}
+
+const FlexibleColorAssignment::ColorAssignment* FlexibleColorAssignment::Snapshot::GetAssignment(int colorIndex) const {
+    return m_state ? FindSlot(*m_state, colorIndex) : nullptr;
+}
+
+std::vector<int> FlexibleColorAssignment::Snapshot::GetAssignedColors() const {
+    return m_state ? m_state->occupied.ToVector() : std::vector<int>();
+}
+
+const FlexibleColorAssignment::ColorAssignment* FlexibleColorAssignment::Snapshot::ClassifyColor(int colorIndex,
+                                                                                                std::uint32_t rgb) const {
+    return m_state ? Classify(*m_state, colorIndex, rgb) : nullptr;
+}
+
+double FlexibleColorAssignment::Snapshot::CalculateCost(int colorIndex, double quantity) const {
+    if (!m_state || !m_state->occupied.Test(colorIndex)) {
+        return 0.0;
+    }
+    return quantity * m_state->pages[colorIndex >> kPageBits]->hot[colorIndex & (kPageSize - 1)].unitCost;
+}
+
+void FlexibleColorAssignment::Snapshot::CalculateCosts(const int* colorIndices, const double* quantities,
+                                                       size_t count, double* costs) const {
+    // Captured hot slots are always in sync - no handed-out check needed
+    for (size_t i = 0; i < count; ++i) {
+        const int colorIndex = colorIndices[i];
+        const bool assigned = m_state && m_state->occupied.Test(colorIndex);
+        costs[i] = assigned
+            ? quantities[i] * m_state->pages[colorIndex >> kPageBits]->hot[colorIndex & (kPageSize - 1)].unitCost
+            : 0.0;
+    }
 }
 
 int FlexibleColorAssignment::GetColorFromRGB(int r, int g, int b) const {
-    // Convert RGB to nearest AutoCAD color index
-    // This is a simplified mapping - could be enhanced with color distance calculation
-    if (r == 255 && g == 0 && b == 0) return 1;     // Red
-    if (r == 255 && g == 255 && b == 0) return 2;   // Yellow
-    if (r == 0 && g == 255 && b == 0) return 3;     // Green
-    if (r == 0 && g == 255 && b == 255) return 4;   // Cyan
-    if (r == 0 && g == 0 && b == 255) return 5;     // Blue
-    if (r == 255 && g == 0 && b == 255) return 6;   // Magenta
-    if (r == 255 && g == 255 && b == 255) return 7; // White
-    
-    // For other colors, return a computed index
-    return ((r & 0xE0) >> 5) | ((g & 0xE0) >> 2) | ((b & 0xC0) << 1);
+    // Perceptually nearest entry of the ACI palette (CIELAB distance, precomputed LUT)
+    return AciPalette::Nearest(r, g, b);
 }
 
 std::string FlexibleColorAssignment::GetMeasurementTypeString(MeasurementType type) const {
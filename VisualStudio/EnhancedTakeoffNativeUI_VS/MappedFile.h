@@ -0,0 +1,39 @@
+// MappedFile.h - Read-only memory mapping of a whole file
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+namespace EnhancedTakeoff {
+
+/**
+ * Maps a file read-only for the lifetime of the object (CreateFileMapping on Windows, mmap elsewhere)
+ * An empty file opens successfully with a null data pointer and size 0
+ * COPILOT-HINT: Readers parse straight out of GetData() - nothing is copied
+ */
+class MappedFile {
+public:
+    MappedFile();
+    ~MappedFile();
+
+    bool Open(const std::string& filePath);
+    void Close();
+    bool IsOpen() const { return m_open; }
+
+    const void* GetData() const { return m_data; }
+    size_t GetSize() const { return m_size; }
+
+private:
+    MappedFile(const MappedFile&);
+    MappedFile& operator=(const MappedFile&);
+
+    const void* m_data;
+    size_t m_size;
+    bool m_open;
+#ifdef _WIN32
+    void* m_fileHandle;
+    void* m_mappingHandle;
+#endif
+};
+
+} // namespace EnhancedTakeoff
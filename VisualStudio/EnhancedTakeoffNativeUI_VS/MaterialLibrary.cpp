@@ -0,0 +1,384 @@
+// MaterialLibrary.cpp - Searchable material/SKU name library
+// Enhanced Construction Takeoff - BricsCAD V25 Plugin
+// COPILOT-HINT: Fuzzy lookup runs against the distinct words, not the names - a 20k-SKU library repeats a few
+// thousand words, so the edit-distance work stays small and the word -> name postings do the rest
+
+#include "pch.h"
+#include "MaterialLibrary.h"
+#include "MappedFile.h"
+
+#include <algorithm>
+
+namespace EnhancedTakeoff {
+
+namespace {
+    const size_t kBigramCount = 65536;
+    const int kPairsPerEdit = 3;            // One edit (a swap included) breaks at most three byte pairs
+    const std::uint8_t kNoMatch = 0xFF;     // Per-word edits never reach this - words are at most 64 characters
+
+    std::string_view Trim(std::string_view text) {
+        while (!text.empty() && (text.front() == ' ' || text.front() == '\t')) text.remove_prefix(1);
+        while (!text.empty() && (text.back() == ' ' || text.back() == '\t' || text.back() == '\r')) {
+            text.remove_suffix(1);
+        }
+        return text;
+    }
+
+    char FoldChar(char c) {
+        return (c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c;
+    }
+
+    void Fold(std::string_view text, std::string& folded) {
+        folded.resize(text.size());
+        std::transform(text.begin(), text.end(), folded.begin(), FoldChar);
+    }
+
+    // Folded text only - letters, digits and anything outside ASCII
+    bool IsWordChar(char c) {
+        const unsigned char byte = static_cast<unsigned char>(c);
+        return byte >= 0x80 || (c >= 'a' && c <= 'z') || (c >= '0' && c <= '9');
+    }
+
+    template <typename Visitor>
+    void ForEachWord(std::string_view text, Visitor&& visit) {
+        size_t i = 0;
+        while (i < text.size()) {
+            while (i < text.size() && !IsWordChar(text[i])) ++i;
+            const size_t start = i;
+            while (i < text.size() && IsWordChar(text[i])) ++i;
+            if (i > start) visit(text.substr(start, i - start));
+        }
+    }
+
+    // Distinct byte pairs of text, ascending
+    void CollectBigrams(std::string_view text, std::vector<std::uint16_t>& pairs) {
+        pairs.clear();
+        for (size_t i = 1; i < text.size(); ++i) {
+            pairs.push_back(static_cast<std::uint16_t>(static_cast<unsigned char>(text[i - 1]) << 8 |
+                                                       static_cast<unsigned char>(text[i])));
+        }
+        std::sort(pairs.begin(), pairs.end());
+        pairs.erase(std::unique(pairs.begin(), pairs.end()), pairs.end());
+    }
+
+    // First index in [first, last) for which before() is false; before must be true-then-false
+    template <typename Predicate>
+    size_t PartitionPoint(size_t first, size_t last, Predicate&& before) {
+        size_t count = last - first;
+        while (count > 0) {
+            const size_t step = count / 2;
+            if (before(first + step)) {
+                first += step + 1;
+                count -= step + 1;
+            } else {
+                count = step;
+            }
+        }
+        return first;
+    }
+
+    // Restricted Damerau-Levenshtein distance from pattern to text - or, asPrefix, to the closest start of text
+    // Anything above maxEdits comes back as maxEdits + 1; pattern is at most kMaxQueryLength
+    int EditDistance(std::string_view pattern, std::string_view text, bool asPrefix, int maxEdits) {
+        const size_t m = pattern.size();
+        int columns[3][MaterialLibrary::kMaxQueryLength + 1];
+        int* before = columns[0];     // After text[j - 2]
+        int* previous = columns[1];   // After text[j - 1]
+        int* current = columns[2];
+
+        for (size_t i = 0; i <= m; ++i) {
+            previous[i] = static_cast<int>(i);
+        }
+        int best = previous[m];
+        for (size_t j = 0; j < text.size(); ++j) {
+            current[0] = static_cast<int>(j + 1);
+            int lowest = current[0];
+            for (size_t i = 1; i <= m; ++i) {
+                int value = previous[i - 1] + (pattern[i - 1] == text[j] ? 0 : 1);
+                value = std::min(value, previous[i] + 1);       // Extra character in text
+                value = std::min(value, current[i - 1] + 1);    // Pattern character missing
+                if (i > 1 && j > 0 && pattern[i - 1] == text[j - 1] && pattern[i - 2] == text[j]) {
+                    value = std::min(value, before[i - 2] + 1); // Neighbours swapped
+                }
+                current[i] = value;
+                lowest = std::min(lowest, value);
+            }
+            if (lowest > maxEdits) {
+                // Columns never get cheaper - only a start already matched can still count
+                return asPrefix ? std::min(best, maxEdits + 1) : maxEdits + 1;
+            }
+            best = std::min(best, current[m]);
+            int* recycled = before;
+            before = previous;
+            previous = current;
+            current = recycled;
+        }
+        return std::min(asPrefix ? best : previous[m], maxEdits + 1);
+    }
+
+    struct Ranked {
+        int distance;
+        bool notPrefix;
+        std::uint32_t length;
+        std::uint32_t entry;        // Alphabetical rank
+
+        bool operator<(const Ranked& other) const {
+            if (distance != other.distance) return distance < other.distance;
+            if (notPrefix != other.notPrefix) return !notPrefix;
+            if (length != other.length) return length < other.length;
+            return entry < other.entry;
+        }
+    };
+}
+
+void MaterialLibrary::Assign(const std::vector<std::string_view>& names) {
+    struct Entry {
+        std::string folded;
+        std::string_view text;
+    };
+    std::vector<Entry> entries;
+    entries.reserve(names.size());
+    for (std::string_view name : names) {
+        name = Trim(name);
+        if (name.empty()) continue;
+        entries.push_back(Entry{ std::string(), name });
+        Fold(name, entries.back().folded);
+    }
+    // Same text folds the same, so exact duplicates end up adjacent
+    std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) {
+        return (a.folded != b.folded) ? a.folded < b.folded : a.text < b.text;
+    });
+    entries.erase(std::unique(entries.begin(), entries.end(),
+                              [](const Entry& a, const Entry& b) { return a.text == b.text; }),
+                  entries.end());
+
+    m_names.clear();
+    m_names.reserve(entries.size());
+    m_folded.clear();
+    m_foldedOffsets.clear();
+    m_foldedOffsets.reserve(entries.size() + 1);
+    for (const Entry& entry : entries) {
+        m_names.push_back(InternedName(entry.text));
+        m_foldedOffsets.push_back(static_cast<std::uint32_t>(m_folded.size()));
+        m_folded += entry.folded;
+    }
+    m_foldedOffsets.push_back(static_cast<std::uint32_t>(m_folded.size()));
+    BuildWordIndex();
+}
+
+bool MaterialLibrary::LoadFile(const std::string& filePath) {
+    MappedFile file;
+    if (!file.Open(filePath)) {
+        return false;
+    }
+    std::string_view text(static_cast<const char*>(file.GetData()), file.GetSize());
+    if (text.size() >= 3 && text.compare(0, 3, "\xEF\xBB\xBF") == 0) {
+        text.remove_prefix(3);      // UTF-8 byte order mark
+    }
+
+    // Views into the mapping - Assign interns them before it closes
+    std::vector<std::string_view> lines;
+    while (!text.empty()) {
+        const size_t end = text.find('\n');
+        lines.push_back(text.substr(0, end));
+        text.remove_prefix((end == std::string_view::npos) ? text.size() : end + 1);
+    }
+    Assign(lines);
+    return true;
+}
+
+void MaterialLibrary::BuildWordIndex() {
+    // Every (word, name) once, grouped by word - names arrive in ascending order, so a stable sort
+    // leaves each word's postings ascending
+    struct Use {
+        std::string_view word;      // Into m_folded
+        std::uint32_t entry;
+    };
+    std::vector<Use> uses;
+    for (size_t entry = 0; entry < m_names.size(); ++entry) {
+        ForEachWord(Folded(entry), [&](std::string_view word) {
+            uses.push_back(Use{ word, static_cast<std::uint32_t>(entry) });
+        });
+    }
+    std::stable_sort(uses.begin(), uses.end(), [](const Use& a, const Use& b) { return a.word < b.word; });
+
+    m_words.clear();
+    m_wordOffsets.assign(1, 0);
+    m_wordEntryOffsets.assign(1, 0);
+    m_wordEntries.clear();
+    for (size_t i = 0; i < uses.size(); ++i) {
+        const bool newWord = (i == 0 || uses[i].word != uses[i - 1].word);
+        if (newWord) {
+            if (i > 0) {
+                m_wordEntryOffsets.push_back(static_cast<std::uint32_t>(m_wordEntries.size()));
+            }
+            m_words += uses[i].word;
+            m_wordOffsets.push_back(static_cast<std::uint32_t>(m_words.size()));
+        }
+        if (newWord || uses[i].entry != uses[i - 1].entry) {
+            m_wordEntries.push_back(uses[i].entry);     // A word repeated within a name counts once
+        }
+    }
+    if (!uses.empty()) {
+        m_wordEntryOffsets.push_back(static_cast<std::uint32_t>(m_wordEntries.size()));
+    }
+
+    // Counting sort: size every pair's word list, then fill them in word order so each stays ascending
+    const size_t wordCount = m_wordOffsets.size() - 1;
+    m_bigramOffsets.assign(kBigramCount + 1, 0);
+    std::vector<std::uint16_t> pairs;
+    for (size_t word = 0; word < wordCount; ++word) {
+        CollectBigrams(Word(word), pairs);
+        for (const std::uint16_t pair : pairs) {
+            ++m_bigramOffsets[pair + 1];
+        }
+    }
+    for (size_t pair = 0; pair < kBigramCount; ++pair) {
+        m_bigramOffsets[pair + 1] += m_bigramOffsets[pair];
+    }
+    m_bigramWords.resize(m_bigramOffsets[kBigramCount]);
+    std::vector<std::uint32_t> cursor(m_bigramOffsets.begin(), m_bigramOffsets.end() - 1);
+    for (size_t word = 0; word < wordCount; ++word) {
+        CollectBigrams(Word(word), pairs);
+        for (const std::uint16_t pair : pairs) {
+            m_bigramWords[cursor[pair]++] = static_cast<std::uint32_t>(word);
+        }
+    }
+}
+
+MaterialLibrary::View MaterialLibrary::FindPrefix(std::string_view prefix) const {
+    std::string key;
+    Fold(Trim(prefix), key);
+
+    // Names sharing the prefix are one run in folded order
+    const size_t first = PartitionPoint(0, m_names.size(), [&](size_t entry) { return Folded(entry) < key; });
+    const size_t last = PartitionPoint(first, m_names.size(), [&](size_t entry) {
+        return Folded(entry).compare(0, key.size(), key) == 0;
+    });
+    return View(m_names.data() + first, last - first);
+}
+
+void MaterialLibrary::MatchWord(std::string_view word, bool asPrefix, int maxEdits,
+                                std::vector<std::uint8_t>& best, std::vector<std::uint32_t>& touched) const {
+    auto mark = [&](size_t matched, int edits) {
+        for (std::uint32_t p = m_wordEntryOffsets[matched]; p < m_wordEntryOffsets[matched + 1]; ++p) {
+            const std::uint32_t entry = m_wordEntries[p];
+            if (best[entry] == kNoMatch) {
+                touched.push_back(entry);
+            }
+            best[entry] = std::min(best[entry], static_cast<std::uint8_t>(edits));
+        }
+    };
+    const size_t wordCount = m_wordOffsets.size() - 1;
+
+    if (maxEdits == 0) {
+        // Exact - a binary search over the sorted words
+        const size_t first = PartitionPoint(0, wordCount, [&](size_t w) { return Word(w) < word; });
+        if (!asPrefix) {
+            if (first < wordCount && Word(first) == word) mark(first, 0);
+            return;
+        }
+        for (size_t w = first; w < wordCount && Word(w).compare(0, word.size(), word) == 0; ++w) {
+            mark(w, 0);
+        }
+        return;
+    }
+
+    const int length = static_cast<int>(word.size());
+    auto consider = [&](size_t w) {
+        const std::string_view candidate = Word(w);
+        const int candidateLength = static_cast<int>(candidate.size());
+        if (candidateLength < length - maxEdits || (!asPrefix && candidateLength > length + maxEdits)) {
+            return;
+        }
+        const int edits = EditDistance(word, candidate, asPrefix, maxEdits);
+        if (edits <= maxEdits) mark(w, edits);
+    };
+
+    // A word within maxEdits edits still shares this many of the query word's distinct byte pairs
+    std::vector<std::uint16_t> pairs;
+    CollectBigrams(word, pairs);
+    const int required = static_cast<int>(pairs.size()) - kPairsPerEdit * maxEdits;
+    if (required > 0) {
+        std::vector<std::uint8_t> shared(wordCount, 0);
+        for (const std::uint16_t pair : pairs) {
+            for (std::uint32_t p = m_bigramOffsets[pair]; p < m_bigramOffsets[pair + 1]; ++p) {
+                const std::uint32_t candidate = m_bigramWords[p];
+                if (++shared[candidate] == required) {
+                    consider(candidate);
+                }
+            }
+        }
+    } else {
+        // Too short to filter on - the vocabulary is small enough to check outright
+        for (size_t w = 0; w < wordCount; ++w) {
+            consider(w);
+        }
+    }
+}
+
+size_t MaterialLibrary::FindFuzzy(std::string_view query, size_t maxResults, std::vector<Match>& matches,
+                                  int maxEditsPerWord) const {
+    matches.clear();
+    std::string pattern;
+    Fold(Trim(query), pattern);
+    if (pattern.size() > kMaxQueryLength) {
+        pattern.resize(kMaxQueryLength);
+    }
+    std::vector<std::string_view> words;
+    ForEachWord(pattern, [&](std::string_view word) { words.push_back(word); });
+    if (maxResults == 0 || words.empty() || m_names.empty()) {
+        return 0;
+    }
+    // A trailing separator means the last word is finished
+    const bool lastIsPrefix = IsWordChar(pattern.back());
+
+    // Work follows the postings each word touches, never the whole library
+    std::vector<std::uint8_t> best(m_names.size(), kNoMatch);  // This word's edits per name
+    std::vector<std::uint32_t> touched;                         // Names best[] holds a value for
+    std::vector<Ranked> ranked;                                 // Names matching every word so far
+    for (size_t w = 0; w < words.size(); ++w) {
+        const int length = static_cast<int>(words[w].size());
+        int maxEdits = (maxEditsPerWord >= 0) ? maxEditsPerWord : (length <= 2) ? 0 : (length <= 5) ? 1 : 2;
+        maxEdits = std::min(maxEdits, length - 1);     // Otherwise any short word would do
+
+        MatchWord(words[w], lastIsPrefix && w + 1 == words.size(), maxEdits, best, touched);
+        if (w == 0) {
+            for (const std::uint32_t entry : touched) {
+                ranked.push_back(Ranked{ best[entry], false, 0, entry });
+            }
+        } else {
+            size_t kept = 0;
+            for (const Ranked& candidate : ranked) {
+                if (best[candidate.entry] != kNoMatch) {
+                    ranked[kept] = candidate;
+                    ranked[kept++].distance += best[candidate.entry];
+                }
+            }
+            ranked.resize(kept);
+        }
+        for (const std::uint32_t entry : touched) {
+            best[entry] = kNoMatch;
+        }
+        touched.clear();
+        if (ranked.empty()) {
+            return 0;
+        }
+    }
+
+    for (Ranked& candidate : ranked) {
+        const std::string_view name = Folded(candidate.entry);
+        candidate.notPrefix = name.compare(0, pattern.size(), pattern) != 0;
+        candidate.length = static_cast<std::uint32_t>(name.size());
+    }
+
+    const size_t found = std::min(maxResults, ranked.size());
+    std::partial_sort(ranked.begin(), ranked.begin() + found, ranked.end());
+    matches.reserve(found);
+    for (size_t i = 0; i < found; ++i) {
+        matches.push_back(Match{ m_names[ranked[i].entry], ranked[i].distance });
+    }
+    return found;
+}
+
+} // namespace EnhancedTakeoff
@@ -0,0 +1,302 @@
+// MaterialPresetParser.cpp - Streaming parser for material preset CSV files
+// Enhanced Construction Takeoff - BricsCAD V25 Plugin
+// COPILOT-HINT: Fields are string_views into the buffer; a std::string is only built for values that
+// end up in a ColorAssignment, and only quoted fields containing "" need an unescape copy
+
+#include "pch.h"
+#include "MaterialPresetParser.h"
+#include "MappedFile.h"
+
+#include <charconv>
+#include <cmath>
+
+namespace EnhancedTakeoff {
+
+namespace {
+    const char* const kTypeNames[] = { "LF", "SF", "EA", "LF_PITCH", "SF_PITCH", "LF_HIP", "CUSTOM" };
+    static_assert(sizeof(kTypeNames) / sizeof(kTypeNames[0]) == FlexibleColorAssignment::kMeasurementTypeCount,
+                  "Measurement type names out of sync with MeasurementType");
+
+    const size_t kColumnCount = 7;
+
+    struct Field {
+        std::string_view text;      // Quotes stripped, "" escapes still doubled
+        bool hasEscapes;
+    };
+
+    std::string_view Trim(std::string_view text) {
+        while (!text.empty() && (text.front() == ' ' || text.front() == '\t')) text.remove_prefix(1);
+        while (!text.empty() && (text.back() == ' ' || text.back() == '\t')) text.remove_suffix(1);
+        return text;
+    }
+
+    std::string ToString(const Field& field) {
+        if (!field.hasEscapes) {
+            return std::string(field.text);
+        }
+        std::string value;
+        value.reserve(field.text.size());
+        for (size_t i = 0; i < field.text.size(); ++i) {
+            value.push_back(field.text[i]);
+            if (field.text[i] == '"') ++i;   // Skip the second quote of ""
+        }
+        return value;
+    }
+
+    // Names go straight from the buffer into the pool unless "" escapes need undoing first
+    InternedName ToName(const Field& field) {
+        return field.hasEscapes ? InternedName(ToString(field)) : InternedName(field.text);
+    }
+
+    std::string Quote(std::string_view text) {
+        return "'" + std::string(text.substr(0, 40)) + (text.size() > 40 ? "...'" : "'");
+    }
+
+    /**
+     * Splits the buffer into records; Next() fills up to kColumnCount + 1 fields so an
+     * over-long row is still detected
+     */
+    class RecordReader {
+    public:
+        RecordReader(const char* data, size_t size) : m_cursor(data), m_end(data + size), m_line(1) {
+            // UTF-8 byte order mark (Excel "CSV UTF-8")
+            if (size >= 3 && static_cast<unsigned char>(data[0]) == 0xEF &&
+                static_cast<unsigned char>(data[1]) == 0xBB && static_cast<unsigned char>(data[2]) == 0xBF) {
+                m_cursor += 3;
+            }
+        }
+
+        bool AtEnd() const { return m_cursor >= m_end; }
+
+        // False on an unrecoverable quoting error; 'line' is where the record starts
+        bool Next(Field* fields, size_t& fieldCount, size_t& line, std::string& error) {
+            line = m_line;
+            fieldCount = 0;
+            for (;;) {
+                Field field = { std::string_view(), false };
+                if (m_cursor < m_end && *m_cursor == '"') {
+                    const char* start = ++m_cursor;
+                    for (;;) {
+                        if (m_cursor >= m_end) {
+                            error = "unterminated quoted field";
+                            return false;
+                        }
+                        if (*m_cursor == '"') {
+                            if (m_cursor + 1 < m_end && m_cursor[1] == '"') {
+                                field.hasEscapes = true;
+                                m_cursor += 2;
+                                continue;
+                            }
+                            break;
+                        }
+                        if (*m_cursor == '\n') ++m_line;
+                        ++m_cursor;
+                    }
+                    field.text = std::string_view(start, static_cast<size_t>(m_cursor - start));
+                    ++m_cursor;     // Closing quote
+                    if (m_cursor < m_end && *m_cursor != ',' && *m_cursor != '\r' && *m_cursor != '\n') {
+                        error = "unexpected text after a closing quote";
+                        return false;
+                    }
+                } else {
+                    const char* start = m_cursor;
+                    while (m_cursor < m_end && *m_cursor != ',' && *m_cursor != '\r' && *m_cursor != '\n') {
+                        ++m_cursor;
+                    }
+                    field.text = std::string_view(start, static_cast<size_t>(m_cursor - start));
+                }
+
+                if (fieldCount <= kColumnCount) {
+                    fields[fieldCount] = field;
+                }
+                ++fieldCount;
+
+                if (m_cursor < m_end && *m_cursor == ',') {
+                    ++m_cursor;
+                    continue;
+                }
+                // End of record: \n, \r\n, lone \r or end of buffer
+                if (m_cursor < m_end && *m_cursor == '\r') ++m_cursor;
+                if (m_cursor < m_end && *m_cursor == '\n') ++m_cursor;
+                ++m_line;
+                return true;
+            }
+        }
+
+    private:
+        const char* m_cursor;
+        const char* m_end;
+        size_t m_line;
+    };
+
+    bool ParseColorColumn(std::string_view text, MaterialPresetParser::ColorAssignment& row, std::string& error) {
+        text = Trim(text);
+        if (!text.empty() && text.front() == '#') {
+            std::uint32_t rgb = 0;
+            const char* last = text.data() + text.size();
+            const auto result = std::from_chars(text.data() + 1, last, rgb, 16);
+            if (text.size() != 7 || result.ec != std::errc() || result.ptr != last) {
+                error = "true color " + Quote(text) + " is not #RRGGBB";
+                return false;
+            }
+            row.isTrueColor = true;
+            row.red = TrueColorTable::Red(rgb);
+            row.green = TrueColorTable::Green(rgb);
+            row.blue = TrueColorTable::Blue(rgb);
+            row.colorIndex = 0;
+            return true;
+        }
+
+        int colorIndex = 0;
+        const char* last = text.data() + text.size();
+        const auto result = std::from_chars(text.data(), last, colorIndex);
+        if (text.empty() || result.ec != std::errc() || result.ptr != last) {
+            error = "color index " + Quote(text) + " is not a number";
+            return false;
+        }
+        if (colorIndex < 0 || colorIndex > 255) {
+            error = "color index " + std::to_string(colorIndex) + " is outside 0-255";
+            return false;
+        }
+        row.colorIndex = colorIndex;
+        return true;
+    }
+
+    bool ParseCostColumn(std::string_view text, double& unitCost, std::string& error) {
+        text = Trim(text);
+        if (text.empty()) {
+            unitCost = 0.0;
+            return true;
+        }
+        std::string_view digits = (text.front() == '+') ? text.substr(1) : text;
+        const char* last = digits.data() + digits.size();
+        const auto result = std::from_chars(digits.data(), last, unitCost);
+        if (result.ec != std::errc() || result.ptr != last || !std::isfinite(unitCost)) {
+            error = "unit cost " + Quote(text) + " is not a number";
+            return false;
+        }
+        return true;
+    }
+
+    bool ParseTypeColumn(std::string_view text, std::vector<MaterialPresetParser::MeasurementType>& types,
+                         std::string& error) {
+        types.clear();
+        text = Trim(text);
+        if (text.empty()) {
+            types.push_back(MaterialPresetParser::MeasurementType::LF);   // Default, as before
+            return true;
+        }
+        for (;;) {
+            const size_t bar = text.find('|');
+            const std::string_view name = Trim(text.substr(0, bar));
+            MaterialPresetParser::MeasurementType type;
+            if (!MaterialPresetParser::ParseMeasurementType(name, type)) {
+                error = "unknown measurement type " + Quote(name);
+                return false;
+            }
+            bool seen = false;
+            for (const auto existing : types) seen = seen || existing == type;
+            if (!seen) types.push_back(type);
+            if (bar == std::string_view::npos) return true;
+            text = text.substr(bar + 1);
+        }
+    }
+}
+
+bool MaterialPresetParser::Parse(const char* data, size_t size, std::vector<ColorAssignment>& rows,
+                                 std::vector<PresetError>& errors) {
+    rows.clear();
+    errors.clear();
+
+    RecordReader reader(data, size);
+    Field fields[kColumnCount + 1];
+    size_t skippedErrors = 0;
+    bool header = true;
+    std::string error;
+
+    auto report = [&](size_t line, const std::string& message) {
+        if (errors.size() < kMaxErrors) {
+            errors.push_back(PresetError{ line, message });
+        } else {
+            ++skippedErrors;
+        }
+    };
+
+    while (!reader.AtEnd()) {
+        size_t fieldCount = 0;
+        size_t line = 0;
+        if (!reader.Next(fields, fieldCount, line, error)) {
+            report(line, error);
+            break;      // Quoting is lost - nothing after this point can be trusted
+        }
+        if (header) {
+            header = false;
+            continue;
+        }
+        if (fieldCount == 1 && Trim(fields[0].text).empty()) {
+            continue;   // Blank line
+        }
+        if (fieldCount > kColumnCount) {
+            report(line, std::to_string(fieldCount) + " fields, expected at most " + std::to_string(kColumnCount) +
+                         " (quote text containing commas)");
+            continue;
+        }
+
+        // Missing trailing columns keep their defaults
+        ColorAssignment row;
+        row.isActive = true;
+        bool valid = ParseColorColumn(fields[0].text, row, error);
+        if (valid && fieldCount > 2) valid = ParseCostColumn(fields[2].text, row.unitCost, error);
+        if (valid && fieldCount > 5) valid = ParseTypeColumn(fields[5].text, row.measurementTypes, error);
+        if (!valid) {
+            report(line, error);
+            continue;
+        }
+        if (!errors.empty()) {
+            continue;   // Keep scanning for errors, but the rows are not going to be used
+        }
+
+        if (fieldCount > 1) row.materialName = ToName(fields[1]);
+        if (fieldCount > 3) row.excelCell = ToString(fields[3]);
+        if (fieldCount > 4) row.excelFormula = ToString(fields[4]);
+        if (fieldCount > 6) row.description = ToString(fields[6]);
+        rows.push_back(std::move(row));
+    }
+
+    if (skippedErrors > 0) {
+        errors.push_back(PresetError{ 0, std::to_string(skippedErrors) + " more errors not listed" });
+    }
+    if (!errors.empty()) {
+        rows.clear();
+        return false;
+    }
+    return true;
+}
+
+bool MaterialPresetParser::ParseFile(const std::string& filePath, std::vector<ColorAssignment>& rows,
+                                     std::vector<PresetError>& errors) {
+    MappedFile file;
+    if (!file.Open(filePath)) {
+        rows.clear();
+        errors.assign(1, PresetError{ 0, "cannot open " + filePath });
+        return false;
+    }
+    return Parse(static_cast<const char*>(file.GetData()), file.GetSize(), rows, errors);
+}
+
+bool MaterialPresetParser::ParseMeasurementType(std::string_view text, MeasurementType& type) {
+    for (int t = 0; t < FlexibleColorAssignment::kMeasurementTypeCount; ++t) {
+        if (text == kTypeNames[t]) {
+            type = static_cast<MeasurementType>(t);
+            return true;
+        }
+    }
+    return false;
+}
+
+const char* MaterialPresetParser::GetMeasurementTypeName(MeasurementType type) {
+    const int index = static_cast<int>(type);
+    return (index >= 0 && index < FlexibleColorAssignment::kMeasurementTypeCount) ? kTypeNames[index] : kTypeNames[0];
+}
+
+} // namespace EnhancedTakeoff
@@ -0,0 +1,40 @@
+// MaterialPresetParser.h - Streaming parser for material preset CSV files
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "FlexibleColorAssignment.h"
+
+namespace EnhancedTakeoff {
+
+/**
+ * Single-pass parser for the SavePreset CSV format over an in-memory (typically mapped) buffer
+ * Fields may be quoted RFC 4180 style (commas, "" and line breaks inside quotes); numbers go through
+ * std::from_chars; the type column takes any MeasurementType name, several separated by '|'
+ * Rows: ColorIndex (0-255 or #RRGGBB), MaterialName, UnitCost, ExcelCell, ExcelFormula, MeasurementType, Description
+ * COPILOT-HINT: Parsing never touches a FlexibleColorAssignment - LoadPreset applies rows only when no errors came back
+ */
+class MaterialPresetParser {
+public:
+    using ColorAssignment = FlexibleColorAssignment::ColorAssignment;
+    using MeasurementType = FlexibleColorAssignment::MeasurementType;
+    using PresetError = FlexibleColorAssignment::PresetError;
+
+    static const size_t kMaxErrors = 100;   // Further errors are summarized in one final entry
+
+    // Rows in file order (the first record is the header and is skipped)
+    // True-color rows come back with isTrueColor set, red/green/blue filled and colorIndex 0
+    static bool Parse(const char* data, size_t size, std::vector<ColorAssignment>& rows,
+                      std::vector<PresetError>& errors);
+    static bool ParseFile(const std::string& filePath, std::vector<ColorAssignment>& rows,
+                          std::vector<PresetError>& errors);
+
+    // Names as SavePreset writes them ("LF", "SF_PITCH", ...)
+    static bool ParseMeasurementType(std::string_view text, MeasurementType& type);
+    static const char* GetMeasurementTypeName(MeasurementType type);
+};
+
+} // namespace EnhancedTakeoff
@@ -0,0 +1,173 @@
+// MaterialPresetParserTests.cpp - Behavior tests for material preset CSV parsing
+// Enhanced Construction Takeoff - BricsCAD V25 Plugin
+// COPILOT-HINT: Parse runs over string literals; only the save/load round trip touches a temp file
+
+#include "pch.h"
+#include "TakeoffTests.h"
+#include "MaterialPresetParser.h"
+
+#include <cstdio>
+#include <filesystem>
+
+#ifdef BUILDING_TESTS
+
+namespace EnhancedTakeoff {
+
+namespace {
+    typedef MaterialPresetParser::ColorAssignment ColorAssignment;
+    typedef MaterialPresetParser::MeasurementType MeasurementType;
+    typedef MaterialPresetParser::PresetError PresetError;
+
+    const std::string kHeader = "ColorIndex,MaterialName,UnitCost,ExcelCell,ExcelFormula,MeasurementType,Description\n";
+
+    bool Parse(const std::string& text, std::vector<ColorAssignment>& rows, std::vector<PresetError>& errors) {
+        return MaterialPresetParser::Parse(text.data(), text.size(), rows, errors);
+    }
+
+    void TestQuotedFieldsKeepSeparators(TakeoffTests::Result& result) {
+        std::vector<ColorAssignment> rows;
+        std::vector<PresetError> errors;
+        const bool parsed = Parse(kHeader +
+                                  "1,\"Block, 8\"\"\",12.5,B4,,SF,\"first line\nsecond line\"\n"
+                                  "2,Rebar,3,,,,\n", rows, errors);
+
+        if (!TakeoffTests::Expect(result, parsed && rows.size() == 2, "both rows parse")) return;
+        TakeoffTests::Expect(result, rows[0].materialName == "Block, 8\"", "comma and \"\" survive in quotes");
+        TakeoffTests::Expect(result, rows[0].description == "first line\nsecond line", "line break inside quotes");
+        TakeoffTests::Expect(result, rows[0].unitCost == 12.5 && rows[0].excelCell == "B4", "plain columns");
+        TakeoffTests::Expect(result, rows[1].colorIndex == 2 && rows[1].materialName == "Rebar",
+                             "the record after a quoted line break");
+    }
+
+    void TestByteOrderMarkAndCrLfAreAccepted(TakeoffTests::Result& result) {
+        std::vector<ColorAssignment> rows;
+        std::vector<PresetError> errors;
+        const bool parsed = Parse("\xEF\xBB\xBF" "ColorIndex,MaterialName\r\n7,Drywall,2.25\r\n\r\n", rows, errors);
+
+        if (!TakeoffTests::Expect(result, parsed && rows.size() == 1, "one row, blank line skipped")) return;
+        TakeoffTests::Expect(result, rows[0].colorIndex == 7 && rows[0].materialName == "Drywall",
+                             "no stray BOM or \\r in the fields");
+    }
+
+    void TestMissingColumnsTakeDefaults(TakeoffTests::Result& result) {
+        std::vector<ColorAssignment> rows;
+        std::vector<PresetError> errors;
+        const bool parsed = Parse(kHeader + "9,Paint\n10,Stain,,,,,\n", rows, errors);
+
+        if (!TakeoffTests::Expect(result, parsed && rows.size() == 2, "short and empty rows are accepted")) return;
+        TakeoffTests::Expect(result, rows[0].unitCost == 0.0 && rows[1].unitCost == 0.0, "cost defaults to 0");
+        TakeoffTests::Expect(result, rows[0].measurementTypes.empty(), "a missing type column keeps no types");
+        TakeoffTests::Expect(result, rows[1].measurementTypes == std::vector<MeasurementType>({ MeasurementType::LF }),
+                             "an empty type column defaults to LF");
+        TakeoffTests::Expect(result, rows[0].isActive && rows[1].isActive, "rows are active");
+    }
+
+    void TestTrueColorAndTypeList(TakeoffTests::Result& result) {
+        std::vector<ColorAssignment> rows;
+        std::vector<PresetError> errors;
+        const bool parsed = Parse(kHeader + "#C80A0A,Roofing,4,,,SF_PITCH|LF_HIP|SF_PITCH,\n", rows, errors);
+
+        if (!TakeoffTests::Expect(result, parsed && rows.size() == 1, "the row parses")) return;
+        TakeoffTests::Expect(result, rows[0].isTrueColor && rows[0].colorIndex == 0, "true color row");
+        TakeoffTests::Expect(result, rows[0].red == 200 && rows[0].green == 10 && rows[0].blue == 10, "RGB channels");
+        TakeoffTests::Expect(result,
+                             rows[0].measurementTypes == std::vector<MeasurementType>({ MeasurementType::SF_PITCH,
+                                                                                        MeasurementType::LF_HIP }),
+                             "every listed type, duplicates dropped");
+    }
+
+    void TestBadRowsReportTheirLines(TakeoffTests::Result& result) {
+        std::vector<ColorAssignment> rows;
+        std::vector<PresetError> errors;
+        const bool parsed = Parse(kHeader +
+                                  "1,Concrete,5,,,SF,\n"
+                                  "300,Block,5,,,SF,\n"
+                                  "2,Rebar,abc,,,LF,\n"
+                                  "3,Trim,1,,,YARDS,\n"
+                                  "4,Paint,1,,,SF,note,extra\n", rows, errors);
+
+        TakeoffTests::Expect(result, !parsed && rows.empty(), "no rows come back when any row is bad");
+        if (!TakeoffTests::Expect(result, errors.size() == 4, "every bad row is reported")) return;
+        TakeoffTests::Expect(result, errors[0].line == 3 && errors[0].message.find("0-255") != std::string::npos,
+                             "color out of range on line 3");
+        TakeoffTests::Expect(result, errors[1].line == 4 && errors[1].message.find("'abc'") != std::string::npos,
+                             "bad cost on line 4 quotes the text");
+        TakeoffTests::Expect(result, errors[2].line == 5 && errors[2].message.find("'YARDS'") != std::string::npos,
+                             "unknown type on line 5");
+        TakeoffTests::Expect(result, errors[3].line == 6 && errors[3].message.find("8 fields") != std::string::npos,
+                             "too many fields on line 6");
+    }
+
+    void TestUnterminatedQuoteStopsParsing(TakeoffTests::Result& result) {
+        std::vector<ColorAssignment> rows;
+        std::vector<PresetError> errors;
+        const bool parsed = Parse(kHeader + "1,Concrete,5\n2,\"Block,5\n3,Rebar,1\n", rows, errors);
+
+        TakeoffTests::Expect(result, !parsed && rows.empty(), "the file is rejected");
+        TakeoffTests::Expect(result, errors.size() == 1 && errors[0].line == 3, "one error at the opening line");
+    }
+
+    void TestErrorListIsCapped(TakeoffTests::Result& result) {
+        std::string text = kHeader;
+        for (size_t i = 0; i < MaterialPresetParser::kMaxErrors + 25; ++i) text += "x,Bad\n";
+
+        std::vector<ColorAssignment> rows;
+        std::vector<PresetError> errors;
+        Parse(text, rows, errors);
+
+        if (!TakeoffTests::Expect(result, errors.size() == MaterialPresetParser::kMaxErrors + 1,
+                                  "capped list plus one summary entry")) return;
+        TakeoffTests::Expect(result, errors.back().line == 0 && errors.back().message == "25 more errors not listed",
+                             "the summary counts the rest");
+    }
+
+    void TestSavedPresetLoadsBack(TakeoffTests::Result& result) {
+        const std::string path = (std::filesystem::temp_directory_path() / "takeoff_preset_test.csv").string();
+
+        FlexibleColorAssignment saved;
+        ColorAssignment concrete;
+        concrete.materialName = "Concrete, \"4000 psi\"";
+        concrete.unitCost = 0.1;
+        concrete.measurementTypes = { MeasurementType::SF, MeasurementType::EA };
+        concrete.description = "slab\non grade";
+        saved.AssignColor(3, concrete);
+        ColorAssignment roofing;
+        roofing.materialName = "Roofing";
+        roofing.unitCost = 4.75;
+        roofing.measurementTypes = { MeasurementType::SF_PITCH };
+        saved.AssignTrueColor(200, 10, 10, roofing);
+
+        FlexibleColorAssignment loaded;
+        std::vector<PresetError> errors;
+        const bool roundTrip = saved.SavePreset("test", path) && loaded.LoadPreset(path, &errors);
+        std::remove(path.c_str());
+
+        if (!TakeoffTests::Expect(result, roundTrip && errors.empty(), "the saved file loads cleanly")) return;
+        const ColorAssignment* color = loaded.FindAssignment(3);
+        if (!TakeoffTests::Expect(result, color != nullptr, "the ACI row comes back")) return;
+        TakeoffTests::Expect(result, color->materialName == concrete.materialName, "quoted name round trips");
+        TakeoffTests::Expect(result, color->unitCost == 0.1, "cost round trips exactly");
+        TakeoffTests::Expect(result, color->measurementTypes == concrete.measurementTypes, "type list round trips");
+        TakeoffTests::Expect(result, color->description == concrete.description, "multi-line description");
+        const ColorAssignment* trueColor = loaded.GetTrueColorAssignment(200, 10, 10);
+        TakeoffTests::Expect(result, trueColor != nullptr && trueColor->materialName == "Roofing",
+                             "the true color row comes back");
+    }
+}
+
+std::vector<TakeoffTests::Result> TakeoffTests::RunMaterialPresetParserTests() {
+    return Run({
+        { "MaterialPresetParser.QuotedFieldsKeepSeparators", TestQuotedFieldsKeepSeparators },
+        { "MaterialPresetParser.ByteOrderMarkAndCrLfAreAccepted", TestByteOrderMarkAndCrLfAreAccepted },
+        { "MaterialPresetParser.MissingColumnsTakeDefaults", TestMissingColumnsTakeDefaults },
+        { "MaterialPresetParser.TrueColorAndTypeList", TestTrueColorAndTypeList },
+        { "MaterialPresetParser.BadRowsReportTheirLines", TestBadRowsReportTheirLines },
+        { "MaterialPresetParser.UnterminatedQuoteStopsParsing", TestUnterminatedQuoteStopsParsing },
+        { "MaterialPresetParser.ErrorListIsCapped", TestErrorListIsCapped },
+        { "MaterialPresetParser.SavedPresetLoadsBack", TestSavedPresetLoadsBack },
+    });
+}
+
+} // namespace EnhancedTakeoff
+
+#endif
@@ -0,0 +1,323 @@
+// MeasurementKernels.cpp - Vectorized polyline length and shoelace-area kernels
+// Enhanced Construction Takeoff - BricsCAD V25 Plugin
+// COPILOT-HINT: AVX2 code is compiled with a target attribute and only entered after a CPUID check
+
+#include "pch.h"
+#include "MeasurementKernels.h"
+
+#include <atomic>
+#include <cmath>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define ET_KERNELS_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#else
+#define ET_KERNELS_X86 0
+#endif
+
+// MSVC accepts AVX2 intrinsics in any function; GCC/Clang need a per-function target
+#if ET_KERNELS_X86 && (defined(__GNUC__) || defined(__clang__))
+#define ET_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define ET_TARGET_AVX2
+#endif
+
+namespace EnhancedTakeoff {
+
+namespace {
+    // Arc length from chord and included angle (theta = 4 * atan(bulge))
+    inline double ArcLength(double chord, double bulge) {
+        const double theta = 4.0 * std::atan(std::fabs(bulge));
+        return chord * theta / (2.0 * std::sin(theta * 0.5));
+    }
+
+    // Signed circular segment between the chord and the arc
+    inline double ArcSegmentArea(double chord, double bulge) {
+        const double theta = 4.0 * std::atan(std::fabs(bulge));
+        const double radius = chord / (2.0 * std::sin(theta * 0.5));
+        const double segment = 0.5 * radius * radius * (theta - std::sin(theta));
+        return (bulge > 0.0) ? segment : -segment;
+    }
+
+    // Running sums shared by every instruction set - the vector loops fill the
+    // chord and cross sums, arc corrections are added lane by lane
+    struct SegmentSums {
+        double chordLength;
+        double arcLengthCorrection;
+        double twiceArea;
+        double arcArea;
+
+        SegmentSums() : chordLength(0.0), arcLengthCorrection(0.0), twiceArea(0.0), arcArea(0.0) {}
+
+        void AddSegment(double x0, double y0, double x1, double y1, double bulge, bool countLength) {
+            const double chord = std::hypot(x1 - x0, y1 - y0);
+            twiceArea += x0 * y1 - x1 * y0;
+            if (countLength) chordLength += chord;
+            if (bulge != 0.0) {
+                if (countLength) arcLengthCorrection += ArcLength(chord, bulge) - chord;
+                arcArea += ArcSegmentArea(chord, bulge);
+            }
+        }
+
+        void AddArcLanes(const double* chords, const double* bulges, int laneMask) {
+            for (int lane = 0; laneMask != 0; ++lane, laneMask >>= 1) {
+                if (laneMask & 1) {
+                    arcLengthCorrection += ArcLength(chords[lane], bulges[lane]) - chords[lane];
+                    arcArea += ArcSegmentArea(chords[lane], bulges[lane]);
+                }
+            }
+        }
+    };
+
+    // Closing segment (last -> first): always part of the area, part of the length when closed
+    inline void AddClosingSegment(SegmentSums& sums, const double* xs, const double* ys,
+                                  const double* bulges, size_t count, bool closed) {
+        const size_t last = count - 1;
+        sums.AddSegment(xs[last], ys[last], xs[0], ys[0], bulges ? bulges[last] : 0.0, closed);
+    }
+
+    void MeasureScalar(const double* xs, const double* ys, const double* bulges,
+                       size_t count, bool closed, SegmentSums& sums) {
+        for (size_t i = 0; i + 1 < count; ++i) {
+            sums.AddSegment(xs[i], ys[i], xs[i + 1], ys[i + 1], bulges ? bulges[i] : 0.0, true);
+        }
+        AddClosingSegment(sums, xs, ys, bulges, count, closed);
+    }
+
+#if ET_KERNELS_X86
+    void MeasureSSE2(const double* xs, const double* ys, const double* bulges,
+                     size_t count, bool closed, SegmentSums& sums) {
+        const size_t segments = count - 1;
+        const __m128d zero = _mm_setzero_pd();
+        __m128d lengthAcc = zero;
+        __m128d crossAcc = zero;
+
+        size_t i = 0;
+        for (; i + 2 <= segments; i += 2) {
+            const __m128d x0 = _mm_loadu_pd(xs + i);
+            const __m128d x1 = _mm_loadu_pd(xs + i + 1);
+            const __m128d y0 = _mm_loadu_pd(ys + i);
+            const __m128d y1 = _mm_loadu_pd(ys + i + 1);
+            const __m128d dx = _mm_sub_pd(x1, x0);
+            const __m128d dy = _mm_sub_pd(y1, y0);
+            const __m128d chord = _mm_sqrt_pd(_mm_add_pd(_mm_mul_pd(dx, dx), _mm_mul_pd(dy, dy)));
+            lengthAcc = _mm_add_pd(lengthAcc, chord);
+            crossAcc = _mm_add_pd(crossAcc, _mm_sub_pd(_mm_mul_pd(x0, y1), _mm_mul_pd(x1, y0)));
+
+            if (bulges) {
+                const int arcMask = _mm_movemask_pd(_mm_cmpneq_pd(_mm_loadu_pd(bulges + i), zero));
+                if (arcMask) {
+                    double chords[2];
+                    _mm_storeu_pd(chords, chord);
+                    sums.AddArcLanes(chords, bulges + i, arcMask);
+                }
+            }
+        }
+
+        double lanes[2];
+        _mm_storeu_pd(lanes, lengthAcc);
+        sums.chordLength += lanes[0] + lanes[1];
+        _mm_storeu_pd(lanes, crossAcc);
+        sums.twiceArea += lanes[0] + lanes[1];
+
+        for (; i < segments; ++i) {
+            sums.AddSegment(xs[i], ys[i], xs[i + 1], ys[i + 1], bulges ? bulges[i] : 0.0, true);
+        }
+        AddClosingSegment(sums, xs, ys, bulges, count, closed);
+    }
+
+    ET_TARGET_AVX2
+    void MeasureAVX2(const double* xs, const double* ys, const double* bulges,
+                     size_t count, bool closed, SegmentSums& sums) {
+        const size_t segments = count - 1;
+        const __m256d zero = _mm256_setzero_pd();
+        __m256d lengthAcc = zero;
+        __m256d crossAcc = zero;
+
+        size_t i = 0;
+        for (; i + 4 <= segments; i += 4) {
+            const __m256d x0 = _mm256_loadu_pd(xs + i);
+            const __m256d x1 = _mm256_loadu_pd(xs + i + 1);
+            const __m256d y0 = _mm256_loadu_pd(ys + i);
+            const __m256d y1 = _mm256_loadu_pd(ys + i + 1);
+            const __m256d dx = _mm256_sub_pd(x1, x0);
+            const __m256d dy = _mm256_sub_pd(y1, y0);
+            const __m256d chord = _mm256_sqrt_pd(
+                _mm256_add_pd(_mm256_mul_pd(dx, dx), _mm256_mul_pd(dy, dy)));
+            lengthAcc = _mm256_add_pd(lengthAcc, chord);
+            crossAcc = _mm256_add_pd(crossAcc,
+                _mm256_sub_pd(_mm256_mul_pd(x0, y1), _mm256_mul_pd(x1, y0)));
+
+            if (bulges) {
+                const int arcMask = _mm256_movemask_pd(
+                    _mm256_cmp_pd(_mm256_loadu_pd(bulges + i), zero, _CMP_NEQ_UQ));
+                if (arcMask) {
+                    double chords[4];
+                    _mm256_storeu_pd(chords, chord);
+                    sums.AddArcLanes(chords, bulges + i, arcMask);
+                }
+            }
+        }
+
+        double lanes[4];
+        _mm256_storeu_pd(lanes, lengthAcc);
+        sums.chordLength += (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+        _mm256_storeu_pd(lanes, crossAcc);
+        sums.twiceArea += (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+
+        for (; i < segments; ++i) {
+            sums.AddSegment(xs[i], ys[i], xs[i + 1], ys[i + 1], bulges ? bulges[i] : 0.0, true);
+        }
+        AddClosingSegment(sums, xs, ys, bulges, count, closed);
+    }
+
+    bool CpuSupportsAVX2() {
+#if defined(_MSC_VER)
+        int info[4];
+        __cpuid(info, 0);
+        if (info[0] < 7) return false;
+
+        // AVX needs OS support for saving YMM state (OSXSAVE + XCR0 bits 1 and 2)
+        __cpuid(info, 1);
+        const bool osxsave = (info[2] & (1 << 27)) != 0;
+        const bool avx = (info[2] & (1 << 28)) != 0;
+        if (!osxsave || !avx || (_xgetbv(0) & 0x6) != 0x6) return false;
+
+        __cpuidex(info, 7, 0);
+        return (info[1] & (1 << 5)) != 0;
+#else
+        return __builtin_cpu_supports("avx2") != 0;
+#endif
+    }
+#endif // ET_KERNELS_X86
+
+    std::atomic<int>& ActiveInstructionSet() {
+        static std::atomic<int> active(
+            static_cast<int>(MeasurementKernels::GetBestSupportedInstructionSet()));
+        return active;
+    }
+
+    void MeasureDispatch(const double* xs, const double* ys, const double* bulges,
+                         size_t count, bool closed, SegmentSums& sums) {
+#if ET_KERNELS_X86
+        switch (static_cast<MeasurementKernels::InstructionSet>(ActiveInstructionSet().load())) {
+            case MeasurementKernels::InstructionSet::AVX2:
+                MeasureAVX2(xs, ys, bulges, count, closed, sums);
+                return;
+            case MeasurementKernels::InstructionSet::SSE2:
+                MeasureSSE2(xs, ys, bulges, count, closed, sums);
+                return;
+            case MeasurementKernels::InstructionSet::Scalar:
+            default:
+                break;
+        }
+#endif
+        MeasureScalar(xs, ys, bulges, count, closed, sums);
+    }
+}
+
+double MeasurementKernels::PolylineLength(const double* xs, const double* ys, const double* bulges,
+                                          size_t count, bool closed) {
+    if (count < 2) return 0.0;
+
+    SegmentSums sums;
+    MeasureDispatch(xs, ys, bulges, count, closed, sums);
+    return sums.chordLength + sums.arcLengthCorrection;
+}
+
+double MeasurementKernels::PolylineSignedArea(const double* xs, const double* ys, const double* bulges,
+                                              size_t count) {
+    if (count < 2) return 0.0;
+
+    SegmentSums sums;
+    MeasureDispatch(xs, ys, bulges, count, true, sums);
+    return 0.5 * sums.twiceArea + sums.arcArea;
+}
+
+void MeasurementKernels::MeasurePolylineBatch(const double* xs, const double* ys, const double* bulges,
+                                              const std::uint32_t* offsets, const std::uint32_t* counts,
+                                              const std::uint8_t* closedFlags, size_t polylineCount,
+                                              double* lengths, double* signedAreas) {
+    for (size_t p = 0; p < polylineCount; ++p) {
+        const size_t offset = offsets[p];
+        const size_t count = counts[p];
+        const bool closed = closedFlags ? closedFlags[p] != 0 : false;
+
+        // One pass yields both the length and the area of each polyline
+        SegmentSums sums;
+        if (count >= 2) {
+            MeasureDispatch(xs + offset, ys + offset, bulges ? bulges + offset : nullptr,
+                            count, closed, sums);
+        }
+        if (lengths) lengths[p] = sums.chordLength + sums.arcLengthCorrection;
+        if (signedAreas) signedAreas[p] = 0.5 * sums.twiceArea + sums.arcArea;
+    }
+}
+
+double MeasurementKernels::PolylineLengthScalar(const double* xs, const double* ys, const double* bulges,
+                                                size_t count, bool closed) {
+    if (count < 2) return 0.0;
+
+    const size_t segments = closed ? count : count - 1;
+    double length = 0.0;
+    for (size_t i = 0; i < segments; ++i) {
+        const size_t next = (i + 1 == count) ? 0 : i + 1;
+        const double chord = std::hypot(xs[next] - xs[i], ys[next] - ys[i]);
+        const double bulge = bulges ? bulges[i] : 0.0;
+        length += (bulge == 0.0) ? chord : ArcLength(chord, bulge);
+    }
+    return length;
+}
+
+double MeasurementKernels::PolylineSignedAreaScalar(const double* xs, const double* ys, const double* bulges,
+                                                    size_t count) {
+    if (count < 2) return 0.0;
+
+    // Shoelace over the chords plus the signed circular segment of every arc
+    double twiceArea = 0.0;
+    double arcArea = 0.0;
+    for (size_t i = 0; i < count; ++i) {
+        const size_t next = (i + 1 == count) ? 0 : i + 1;
+        twiceArea += xs[i] * ys[next] - xs[next] * ys[i];
+
+        const double bulge = bulges ? bulges[i] : 0.0;
+        if (bulge != 0.0) {
+            arcArea += ArcSegmentArea(std::hypot(xs[next] - xs[i], ys[next] - ys[i]), bulge);
+        }
+    }
+    return 0.5 * twiceArea + arcArea;
+}
+
+MeasurementKernels::InstructionSet MeasurementKernels::GetActiveInstructionSet() {
+    return static_cast<InstructionSet>(ActiveInstructionSet().load());
+}
+
+MeasurementKernels::InstructionSet MeasurementKernels::GetBestSupportedInstructionSet() {
+#if ET_KERNELS_X86
+    static const InstructionSet best = CpuSupportsAVX2() ? InstructionSet::AVX2 : InstructionSet::SSE2;
+    return best;
+#else
+    return InstructionSet::Scalar;
+#endif
+}
+
+void MeasurementKernels::SetInstructionSet(InstructionSet set) {
+    if (static_cast<int>(set) > static_cast<int>(GetBestSupportedInstructionSet())) {
+        set = GetBestSupportedInstructionSet();
+    }
+    ActiveInstructionSet().store(static_cast<int>(set));
+}
+
+const char* MeasurementKernels::GetInstructionSetName(InstructionSet set) {
+    switch (set) {
+        case InstructionSet::AVX2: return "AVX2";
+        case InstructionSet::SSE2: return "SSE2";
+        case InstructionSet::Scalar:
+        default: return "Scalar";
+    }
+}
+
+} // namespace EnhancedTakeoff
@@ -0,0 +1,49 @@
+// MeasurementKernels.h - Vectorized polyline length and shoelace-area kernels
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace EnhancedTakeoff {
+
+/**
+ * LF/SF measurement kernels over packed 2D vertex arrays (separate X, Y, bulge columns)
+ * Chord lengths and shoelace terms run 4-wide (AVX2) or 2-wide (SSE2); arc segments
+ * (non-zero bulge) are corrected with the scalar formula for just those lanes
+ * COPILOT-HINT: The instruction set is picked once at runtime - results match the scalar reference to rounding
+ */
+class MeasurementKernels {
+public:
+    enum class InstructionSet {
+        Scalar,
+        SSE2,
+        AVX2
+    };
+
+    // Single polyline - bulges may be null for straight segments only
+    static double PolylineLength(const double* xs, const double* ys, const double* bulges,
+                                 size_t count, bool closed);
+    static double PolylineSignedArea(const double* xs, const double* ys, const double* bulges,
+                                     size_t count);
+
+    // Batch over a shared vertex pool addressed by offset/count (EntitySnapshotStore layout)
+    // closedFlags, lengths and signedAreas may each be null
+    static void MeasurePolylineBatch(const double* xs, const double* ys, const double* bulges,
+                                     const std::uint32_t* offsets, const std::uint32_t* counts,
+                                     const std::uint8_t* closedFlags, size_t polylineCount,
+                                     double* lengths, double* signedAreas);
+
+    // Scalar reference - always available, used for verification and benchmarks
+    static double PolylineLengthScalar(const double* xs, const double* ys, const double* bulges,
+                                       size_t count, bool closed);
+    static double PolylineSignedAreaScalar(const double* xs, const double* ys, const double* bulges,
+                                           size_t count);
+
+    // Dispatch control
+    static InstructionSet GetActiveInstructionSet();
+    static InstructionSet GetBestSupportedInstructionSet();
+    static void SetInstructionSet(InstructionSet set);   // Clamped to what the CPU supports
+    static const char* GetInstructionSetName(InstructionSet set);
+};
+
+} // namespace EnhancedTakeoff
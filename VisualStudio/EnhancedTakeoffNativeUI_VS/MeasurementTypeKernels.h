@@ -0,0 +1,136 @@
+// MeasurementTypeKernels.h - Compile-time measurement math per MeasurementType
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "FlexibleColorAssignment.h"
+
+namespace EnhancedTakeoff {
+
+/**
+ * Roof geometry factors as constexpr functions
+ * When the pitch is known at compile time the factor folds to a constant,
+ * e.g. constexpr double k6in12 = RoofPitchFactor(6);  // 1.1180...
+ */
+namespace MeasurementMath {
+    constexpr double ConstexprSqrt(double x) {
+        if (x <= 0.0) return 0.0;
+        double guess = x < 1.0 ? 1.0 : x;
+        for (int i = 0; i < 64; ++i) {
+            const double next = 0.5 * (guess + x / guess);
+            if (next == guess) break;
+            guess = next;
+        }
+        return guess;
+    }
+
+    // Slope length per unit of horizontal run for a Rise:Run roof
+    constexpr double RoofPitchFactor(double rise, double run = 12.0) {
+        return ConstexprSqrt(1.0 + (rise / run) * (rise / run));
+    }
+
+    // Hip/valley length per unit of common run, equal pitch on both sides
+    // (0:12 gives sqrt(2), the plan-view 45-degree hip)
+    constexpr double HipValleyFactor(double rise, double run = 12.0) {
+        return ConstexprSqrt(2.0 + (rise / run) * (rise / run));
+    }
+
+    constexpr double kPlanHipFactor = HipValleyFactor(0.0);
+}
+
+/**
+ * Measurement kernel per MeasurementType - the primary template passes values through
+ * COPILOT-HINT: To add a measurement type, add the enum value and specialize this template;
+ * the kernel tables below refuse to compile until every type has an entry
+ */
+template <FlexibleColorAssignment::MeasurementType Type>
+struct MeasurementKernel {
+    static double Apply(double rawValue, double /*pitchFactor*/) { return rawValue; }
+};
+
+template <>
+struct MeasurementKernel<FlexibleColorAssignment::MeasurementType::LF_PITCH> {
+    static double Apply(double rawValue, double pitchFactor) { return rawValue * pitchFactor; }
+};
+
+template <>
+struct MeasurementKernel<FlexibleColorAssignment::MeasurementType::SF_PITCH> {
+    static double Apply(double rawValue, double pitchFactor) { return rawValue * pitchFactor; }
+};
+
+template <>
+struct MeasurementKernel<FlexibleColorAssignment::MeasurementType::LF_HIP> {
+    static double Apply(double rawValue, double /*pitchFactor*/) {
+        return rawValue * MeasurementMath::kPlanHipFactor;
+    }
+};
+
+/**
+ * A bucket of values that share one measurement type
+ * 'indices' selects values from the columns (nullptr = the first 'count' values in order)
+ */
+struct MeasurementBucket {
+    const std::uint32_t* indices;
+    size_t count;
+    const int* colorIndices;
+    const double* rawValues;
+    const double* pitchFactors;  // nullptr = 1.0
+    const ColorMask* assigned;   // Unassigned colors pass raw values through
+    double* out;
+};
+
+// Branch-free loop for one bucket; the type is fixed at compile time
+template <FlexibleColorAssignment::MeasurementType Type>
+void RunMeasurementBucket(const MeasurementBucket& bucket) {
+    for (size_t k = 0; k < bucket.count; ++k) {
+        const size_t i = bucket.indices ? bucket.indices[k] : k;
+        const int colorIndex = bucket.colorIndices[i];
+        const bool isAssigned = bucket.assigned->Test(colorIndex);
+        const double pitchFactor = bucket.pitchFactors ? bucket.pitchFactors[i] : 1.0;
+        const double rawValue = bucket.rawValues[i];
+        bucket.out[i] = isAssigned ? MeasurementKernel<Type>::Apply(rawValue, pitchFactor) : rawValue;
+    }
+}
+
+typedef double (*MeasurementValueFn)(double rawValue, double pitchFactor);
+typedef void (*MeasurementBucketFn)(const MeasurementBucket& bucket);
+
+// Kernel lookup - resolved once per value (scalar API) or once per bucket (batch API)
+inline MeasurementValueFn GetMeasurementValueKernel(FlexibleColorAssignment::MeasurementType type) {
+    typedef FlexibleColorAssignment::MeasurementType T;
+    static const MeasurementValueFn kKernels[] = {
+        &MeasurementKernel<T::LF>::Apply,
+        &MeasurementKernel<T::SF>::Apply,
+        &MeasurementKernel<T::EA>::Apply,
+        &MeasurementKernel<T::LF_PITCH>::Apply,
+        &MeasurementKernel<T::SF_PITCH>::Apply,
+        &MeasurementKernel<T::LF_HIP>::Apply,
+        &MeasurementKernel<T::CUSTOM>::Apply
+    };
+    static_assert(sizeof(kKernels) / sizeof(kKernels[0]) == FlexibleColorAssignment::kMeasurementTypeCount,
+                  "Every MeasurementType needs a value kernel");
+
+    const int slot = static_cast<int>(type);
+    return (slot >= 0 && slot < FlexibleColorAssignment::kMeasurementTypeCount) ? kKernels[slot] : kKernels[0];
+}
+
+inline MeasurementBucketFn GetMeasurementBucketKernel(FlexibleColorAssignment::MeasurementType type) {
+    typedef FlexibleColorAssignment::MeasurementType T;
+    static const MeasurementBucketFn kKernels[] = {
+        &RunMeasurementBucket<T::LF>,
+        &RunMeasurementBucket<T::SF>,
+        &RunMeasurementBucket<T::EA>,
+        &RunMeasurementBucket<T::LF_PITCH>,
+        &RunMeasurementBucket<T::SF_PITCH>,
+        &RunMeasurementBucket<T::LF_HIP>,
+        &RunMeasurementBucket<T::CUSTOM>
+    };
+    static_assert(sizeof(kKernels) / sizeof(kKernels[0]) == FlexibleColorAssignment::kMeasurementTypeCount,
+                  "Every MeasurementType needs a bucket kernel");
+
+    const int slot = static_cast<int>(type);
+    return (slot >= 0 && slot < FlexibleColorAssignment::kMeasurementTypeCount) ? kKernels[slot] : kKernels[0];
+}
+
+} // namespace EnhancedTakeoff
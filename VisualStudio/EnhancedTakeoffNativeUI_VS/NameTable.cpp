@@ -0,0 +1,148 @@
+// NameTable.cpp - Process-wide interned string pool
+// Enhanced Construction Takeoff - BricsCAD V25 Plugin
+// COPILOT-HINT: Strings live in fixed-size chunks that are never reallocated, so GetText can hand out
+// references without a lock; only the text -> id index is guarded
+
+#include "pch.h"
+#include "NameTable.h"
+
+#include <atomic>
+#include <mutex>
+#include <ostream>
+#include <vector>
+
+namespace EnhancedTakeoff {
+
+namespace {
+    const size_t kChunkBits = 12;
+    const size_t kChunkSize = size_t(1) << kChunkBits;     // Names per chunk
+    const size_t kMaxChunks = 4096;                         // 16M names
+
+    // Open-addressing index over the chunks - a probe touches one 8-byte slot and, on a hash
+    // match, the stored text; no per-name node allocation
+    struct IndexSlot {
+        std::uint32_t hash;
+        NameId id;                                          // kNotInterned = empty
+    };
+
+    struct NamePool {
+        std::mutex mutex;
+        std::atomic<std::string*> chunks[kMaxChunks];       // Published once, never freed
+        std::atomic<NameId> count;
+        std::vector<IndexSlot> index;                       // Power of two, at most half full
+
+        NamePool() : count(0) {
+            for (auto& chunk : chunks) {
+                chunk.store(nullptr, std::memory_order_relaxed);
+            }
+            index.assign(1024, IndexSlot{ 0, NameTable::kNotInterned });
+            Add(std::string_view(), Hash(std::string_view()), 0);   // kEmptyName
+        }
+
+        static std::uint32_t Hash(std::string_view text) {
+            // FNV-1a
+            std::uint32_t hash = 2166136261u;
+            for (char c : text) {
+                hash = (hash ^ static_cast<unsigned char>(c)) * 16777619u;
+            }
+            return hash;
+        }
+
+        const std::string& Text(NameId id) const {
+            return chunks[id >> kChunkBits].load(std::memory_order_relaxed)[id & (kChunkSize - 1)];
+        }
+
+        // Caller holds the mutex; returns the slot holding text, or the empty slot it would go in
+        size_t Probe(std::string_view text, std::uint32_t hash) const {
+            const size_t mask = index.size() - 1;
+            for (size_t slot = hash & mask;; slot = (slot + 1) & mask) {
+                const IndexSlot& entry = index[slot];
+                if (entry.id == NameTable::kNotInterned ||
+                    (entry.hash == hash && Text(entry.id) == text)) {
+                    return slot;
+                }
+            }
+        }
+
+        // Caller holds the mutex
+        NameId Add(std::string_view text, std::uint32_t hash, size_t slot) {
+            const NameId id = count.load(std::memory_order_relaxed);
+            const size_t chunkIndex = id >> kChunkBits;
+            if (chunkIndex >= kMaxChunks) {
+                return NameTable::kNotInterned;
+            }
+            std::string* chunk = chunks[chunkIndex].load(std::memory_order_relaxed);
+            if (!chunk) {
+                chunk = new std::string[kChunkSize];
+                chunks[chunkIndex].store(chunk, std::memory_order_release);
+            }
+            chunk[id & (kChunkSize - 1)].assign(text.data(), text.size());
+            index[slot] = IndexSlot{ hash, id };
+            count.store(id + 1, std::memory_order_release);
+
+            if (2 * (static_cast<size_t>(id) + 1) > index.size()) {
+                Grow();
+            }
+            return id;
+        }
+
+        void Grow() {
+            std::vector<IndexSlot> old(2 * index.size(), IndexSlot{ 0, NameTable::kNotInterned });
+            old.swap(index);
+            const size_t mask = index.size() - 1;
+            for (const IndexSlot& entry : old) {
+                if (entry.id == NameTable::kNotInterned) continue;
+                size_t slot = entry.hash & mask;
+                while (index[slot].id != NameTable::kNotInterned) {
+                    slot = (slot + 1) & mask;
+                }
+                index[slot] = entry;
+            }
+        }
+    };
+
+    NamePool& GetPool() {
+        // Deliberately leaked - names stay readable during static destruction
+        static NamePool* pool = new NamePool();
+        return *pool;
+    }
+
+    const std::string& GetEmptyText() {
+        static const std::string* empty = new std::string();
+        return *empty;
+    }
+}
+
+NameId NameTable::Intern(std::string_view text) {
+    NamePool& pool = GetPool();
+    const std::uint32_t hash = NamePool::Hash(text);    // Outside the lock
+    std::lock_guard<std::mutex> lock(pool.mutex);
+    const size_t slot = pool.Probe(text, hash);
+    const NameId id = pool.index[slot].id;
+    return (id != kNotInterned) ? id : pool.Add(text, hash, slot);
+}
+
+NameId NameTable::Find(std::string_view text) {
+    NamePool& pool = GetPool();
+    const std::uint32_t hash = NamePool::Hash(text);
+    std::lock_guard<std::mutex> lock(pool.mutex);
+    return pool.index[pool.Probe(text, hash)].id;
+}
+
+const std::string& NameTable::GetText(NameId id) {
+    NamePool& pool = GetPool();
+    if (id >= pool.count.load(std::memory_order_acquire)) {
+        return GetEmptyText();
+    }
+    return pool.chunks[id >> kChunkBits].load(std::memory_order_acquire)[id & (kChunkSize - 1)];
+}
+
+size_t NameTable::GetCount() {
+    return GetPool().count.load(std::memory_order_acquire);
+}
+
+std::ostream& operator<<(std::ostream& stream, const InternedName& name) {
+    return stream << name.str();
+}
+
+} // namespace EnhancedTakeoff
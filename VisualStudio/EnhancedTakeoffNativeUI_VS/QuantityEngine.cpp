@@ -0,0 +1,444 @@
+// QuantityEngine.cpp - Incremental quantity engine implementation
+// Enhanced Construction Takeoff - BricsCAD V25 Plugin
+// COPILOT-HINT: Totals are updated from deltas only - never rescan the whole drawing here
+
+#include "pch.h"
+#include "QuantityEngine.h"
+#include "AciPalette.h"
+
+#ifndef BUILDING_TESTS
+#if HAS_BRX_SDK
+#include "dbapserv.h"
+#include "dbsymtb.h"
+#include "dbhatch.h"
+#include "dbcurve.h"
+#endif
+#endif
+
+namespace EnhancedTakeoff {
+
+// ---------------------------------------------------------------------------
+// InMemoryDeltaFeed
+// ---------------------------------------------------------------------------
+
+void InMemoryDeltaFeed::Push(const EntityDelta& delta) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_pending.push_back(delta);
+}
+
+void InMemoryDeltaFeed::PushAdded(std::uint64_t handle, const EntityDelta::Measure& measure) {
+    Push(EntityDelta(EntityDelta::Kind::Added, handle, measure));
+}
+
+void InMemoryDeltaFeed::PushModified(std::uint64_t handle, const EntityDelta::Measure& measure) {
+    Push(EntityDelta(EntityDelta::Kind::Modified, handle, measure));
+}
+
+void InMemoryDeltaFeed::PushErased(std::uint64_t handle) {
+    Push(EntityDelta(EntityDelta::Kind::Erased, handle));
+}
+
+size_t InMemoryDeltaFeed::Drain(std::vector<EntityDelta>& out) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    size_t count = m_pending.size();
+    out.insert(out.end(), m_pending.begin(), m_pending.end());
+    m_pending.clear();
+    return count;
+}
+
+size_t InMemoryDeltaFeed::GetPendingCount() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_pending.size();
+}
+
+// ---------------------------------------------------------------------------
+// QuantityEngine
+// ---------------------------------------------------------------------------
+
+QuantityEngine::QuantityEngine() : m_revision(0) {
+}
+
+QuantityEngine::~QuantityEngine() {
+    m_entities.clear();
+}
+
+void QuantityEngine::ApplyDelta(const EntityDelta& delta) {
+    auto it = m_entities.find(delta.handle);
+
+    switch (delta.kind) {
+        case EntityDelta::Kind::Added:
+        case EntityDelta::Kind::Modified:
+            // Back out the previous contribution before applying the new one,
+            // so a modify that also changes color moves the quantity between buckets
+            if (it != m_entities.end()) {
+                RemoveContribution(it->second);
+                it->second = delta.measure;
+            } else {
+                m_entities.emplace(delta.handle, delta.measure);
+            }
+            AddContribution(delta.measure);
+            break;
+
+        case EntityDelta::Kind::Erased:
+            if (it != m_entities.end()) {
+                RemoveContribution(it->second);
+                m_entities.erase(it);
+            }
+            break;
+    }
+
+    m_revision++;
+}
+
+size_t QuantityEngine::ApplyDeltas(const std::vector<EntityDelta>& deltas) {
+    for (const auto& delta : deltas) {
+        ApplyDelta(delta);
+    }
+    return deltas.size();
+}
+
+size_t QuantityEngine::Pump(EntityDeltaFeed& feed) {
+    m_scratch.clear();
+    feed.Drain(m_scratch);
+    return ApplyDeltas(m_scratch);
+}
+
+void QuantityEngine::Reset() {
+    m_entities.clear();
+    for (int i = 0; i < 256; ++i) {
+        m_totals[i] = ColorAccumulator();
+    }
+    m_trueColorSlots.Clear();
+    m_trueColorTotals.clear();
+    m_dirtyColors.set();
+    m_revision++;
+}
+
+QuantityEngine::ColorTotals QuantityEngine::GetTotals(int colorIndex) const {
+    return IsValidColor(colorIndex) ? ToTotals(m_totals[colorIndex]) : ColorTotals();
+}
+
+QuantityEngine::ColorTotals QuantityEngine::GetTrueColorTotals(std::uint32_t rgb) const {
+    const std::uint32_t slot = m_trueColorSlots.Find(rgb);
+    return (slot != TrueColorTable::kNotFound) ? ToTotals(m_trueColorTotals[slot]) : ColorTotals();
+}
+
+double QuantityEngine::GetQuantity(int colorIndex, FlexibleColorAssignment::MeasurementType type) const {
+    if (!IsValidColor(colorIndex)) return 0.0;
+
+    return SelectQuantity(ToTotals(m_totals[colorIndex]), type);
+}
+
+double QuantityEngine::SelectQuantity(const ColorTotals& totals, FlexibleColorAssignment::MeasurementType type) {
+    switch (type) {
+        case FlexibleColorAssignment::MeasurementType::SF:
+        case FlexibleColorAssignment::MeasurementType::SF_PITCH:
+            return totals.squareFeet;
+        case FlexibleColorAssignment::MeasurementType::EA:
+            return totals.each;
+        case FlexibleColorAssignment::MeasurementType::LF:
+        case FlexibleColorAssignment::MeasurementType::LF_PITCH:
+        case FlexibleColorAssignment::MeasurementType::LF_HIP:
+        case FlexibleColorAssignment::MeasurementType::CUSTOM:
+        default:
+            return totals.linearFeet;
+    }
+}
+
+size_t QuantityEngine::GetTrackedEntityCount() const {
+    return m_entities.size();
+}
+
+bool QuantityEngine::HasChanges() const {
+    return m_dirtyColors.any();
+}
+
+std::vector<int> QuantityEngine::TakeDirtyColors() {
+    std::vector<int> colors;
+    for (int i = 1; i < 256; ++i) {
+        if (m_dirtyColors.test(i)) {
+            colors.push_back(i);
+        }
+    }
+    m_dirtyColors.reset();
+    return colors;
+}
+
+std::uint64_t QuantityEngine::GetRevision() const {
+    return m_revision;
+}
+
+void QuantityEngine::AddContribution(const EntityDelta::Measure& measure) {
+    if (!IsValidColor(measure.colorIndex)) return;
+
+    ColorAccumulator& totals = m_totals[measure.colorIndex];
+    totals.linearFeet.Add(measure.length);
+    totals.squareFeet.Add(measure.area);
+    totals.each.Add(measure.count);
+    totals.entityCount++;
+    m_dirtyColors.set(measure.colorIndex);
+
+    if (measure.trueColor != TrueColorTable::kNoColor) {
+        // First entity of a new true color opens its accumulator
+        std::uint32_t slot = m_trueColorSlots.Find(measure.trueColor);
+        if (slot == TrueColorTable::kNotFound) {
+            slot = static_cast<std::uint32_t>(m_trueColorTotals.size());
+            if (!m_trueColorSlots.Insert(measure.trueColor, slot)) return;
+            m_trueColorTotals.emplace_back();
+        }
+        ColorAccumulator& exact = m_trueColorTotals[slot];
+        exact.linearFeet.Add(measure.length);
+        exact.squareFeet.Add(measure.area);
+        exact.each.Add(measure.count);
+        exact.entityCount++;
+    }
+}
+
+void QuantityEngine::RemoveContribution(const EntityDelta::Measure& measure) {
+    if (!IsValidColor(measure.colorIndex)) return;
+
+    // Fixed-point subtraction exactly undoes the earlier Add - no residue is left behind
+    ColorAccumulator& totals = m_totals[measure.colorIndex];
+    totals.linearFeet.Subtract(measure.length);
+    totals.squareFeet.Subtract(measure.area);
+    totals.each.Subtract(measure.count);
+    totals.entityCount--;
+    m_dirtyColors.set(measure.colorIndex);
+
+    const std::uint32_t slot = m_trueColorSlots.Find(measure.trueColor);
+    if (slot != TrueColorTable::kNotFound) {
+        ColorAccumulator& exact = m_trueColorTotals[slot];
+        exact.linearFeet.Subtract(measure.length);
+        exact.squareFeet.Subtract(measure.area);
+        exact.each.Subtract(measure.count);
+        exact.entityCount--;
+    }
+}
+
+bool QuantityEngine::IsValidColor(int colorIndex) {
+    return colorIndex >= 1 && colorIndex <= 255;
+}
+
+QuantityEngine::ColorTotals QuantityEngine::ToTotals(const ColorAccumulator& accumulator) {
+    ColorTotals totals;
+    totals.linearFeet = accumulator.linearFeet.GetValue();
+    totals.squareFeet = accumulator.squareFeet.GetValue();
+    totals.each = accumulator.each.GetValue();
+    totals.entityCount = accumulator.entityCount;
+    return totals;
+}
+
+// ---------------------------------------------------------------------------
+// DatabaseDeltaReactor (BricsCAD only)
+// ---------------------------------------------------------------------------
+
+#ifndef BUILDING_TESTS
+#if HAS_BRX_SDK
+DatabaseDeltaReactor::DatabaseDeltaReactor(AcDbDatabase* pDb) : m_pDb(pDb) {
+    if (m_pDb) {
+        AcDbBlockTable* pBlockTable = nullptr;
+        if (m_pDb->getBlockTable(pBlockTable, AcDb::kForRead) == Acad::eOk) {
+            pBlockTable->getAt(ACDB_MODEL_SPACE, m_modelSpaceId);
+            pBlockTable->close();
+        }
+        m_pDb->addReactor(this);
+    }
+}
+
+DatabaseDeltaReactor::~DatabaseDeltaReactor() {
+    if (m_pDb) {
+        m_pDb->removeReactor(this);
+    }
+}
+
+size_t DatabaseDeltaReactor::SeedFromDatabase() {
+    if (!m_pDb) return 0;
+
+    AcDbBlockTable* pBlockTable = nullptr;
+    if (m_pDb->getBlockTable(pBlockTable, AcDb::kForRead) != Acad::eOk) return 0;
+
+    AcDbBlockTableRecord* pModelSpace = nullptr;
+    Acad::ErrorStatus es = pBlockTable->getAt(ACDB_MODEL_SPACE, pModelSpace, AcDb::kForRead);
+    pBlockTable->close();
+    if (es != Acad::eOk) return 0;
+    RecordLayerColors();
+
+    AcDbBlockTableRecordIterator* pIter = nullptr;
+    size_t seeded = 0;
+    if (pModelSpace->newIterator(pIter) == Acad::eOk) {
+        for (; !pIter->done(); pIter->step()) {
+            AcDbEntity* pEnt = nullptr;
+            if (pIter->getEntity(pEnt, AcDb::kForRead) == Acad::eOk) {
+                EntityDelta::Measure measure;
+                if (MeasureEntity(pEnt, measure)) {
+                    m_queue.PushAdded(GetHandleValue(pEnt), measure);
+                    seeded++;
+                }
+                pEnt->close();
+            }
+        }
+        delete pIter;
+    }
+    pModelSpace->close();
+    return seeded;
+}
+
+void DatabaseDeltaReactor::objectAppended(const AcDbDatabase* pDb, const AcDbObject* pObj) {
+    const AcDbEntity* pEnt = AcDbEntity::cast(pObj);
+    EntityDelta::Measure measure;
+    if (pEnt && IsModelSpaceEntity(pEnt) && MeasureEntity(pEnt, measure)) {
+        m_queue.PushAdded(GetHandleValue(pObj), measure);
+    }
+}
+
+void DatabaseDeltaReactor::objectModified(const AcDbDatabase* pDb, const AcDbObject* pObj) {
+    if (const AcDbLayerTableRecord* pLayer = AcDbLayerTableRecord::cast(pObj)) {
+        OnLayerModified(pLayer);
+        return;
+    }
+    const AcDbEntity* pEnt = AcDbEntity::cast(pObj);
+    if (pEnt && IsModelSpaceEntity(pEnt)) {
+        QueueMeasured(pEnt);
+    }
+}
+
+void DatabaseDeltaReactor::objectErased(const AcDbDatabase* pDb, const AcDbObject* pObj,
+                                        Adesk::Boolean bErased) {
+    if (!IsModelSpaceEntity(pObj)) return;
+    if (bErased) {
+        m_queue.PushErased(GetHandleValue(pObj));
+    } else {
+        objectAppended(pDb, pObj); // Unerase (e.g. UNDO) restores the contribution
+    }
+}
+
+bool DatabaseDeltaReactor::IsModelSpaceEntity(const AcDbObject* pObj) const {
+    // Block definition and layout contents are not part of the takeoff (SeedFromDatabase skips them too)
+    return AcDbEntity::cast(pObj) && !m_modelSpaceId.isNull() && pObj->ownerId() == m_modelSpaceId;
+}
+
+void DatabaseDeltaReactor::QueueMeasured(const AcDbEntity* pEnt) {
+    // An entity that stopped being takeoff-relevant is reported as erased
+    EntityDelta::Measure measure;
+    if (MeasureEntity(pEnt, measure)) {
+        m_queue.PushModified(GetHandleValue(pEnt), measure);
+    } else {
+        m_queue.PushErased(GetHandleValue(pEnt));
+    }
+}
+
+void DatabaseDeltaReactor::OnLayerModified(const AcDbLayerTableRecord* pLayer) {
+    // Layer records change for many reasons (on/off, freeze, lock) - only a new color moves quantities
+    const Adesk::UInt32 color = pLayer->color().color();
+    const auto known = m_layerColors.find(GetHandleValue(pLayer));
+    if (known != m_layerColors.end() && known->second == color) return;
+    m_layerColors[GetHandleValue(pLayer)] = color;
+
+    // Walk model space once for the ByLayer entities on this layer - rare, so no per-layer index is kept
+    AcDbBlockTableRecord* pModelSpace = nullptr;
+    if (acdbOpenObject(pModelSpace, m_modelSpaceId, AcDb::kForRead) != Acad::eOk) return;
+    AcDbBlockTableRecordIterator* pIter = nullptr;
+    if (pModelSpace->newIterator(pIter) == Acad::eOk) {
+        for (; !pIter->done(); pIter->step()) {
+            AcDbEntity* pEnt = nullptr;
+            if (pIter->getEntity(pEnt, AcDb::kForRead) == Acad::eOk) {
+                if (pEnt->layerId() == pLayer->objectId() && pEnt->color().isByLayer()) {
+                    QueueMeasured(pEnt);
+                }
+                pEnt->close();
+            }
+        }
+        delete pIter;
+    }
+    pModelSpace->close();
+}
+
+void DatabaseDeltaReactor::RecordLayerColors() {
+    m_layerColors.clear();
+    AcDbLayerTable* pLayerTable = nullptr;
+    if (m_pDb->getLayerTable(pLayerTable, AcDb::kForRead) != Acad::eOk) return;
+    AcDbLayerTableIterator* pIter = nullptr;
+    if (pLayerTable->newIterator(pIter) == Acad::eOk) {
+        for (; !pIter->done(); pIter->step()) {
+            AcDbLayerTableRecord* pLayer = nullptr;
+            if (pIter->getRecord(pLayer, AcDb::kForRead) == Acad::eOk) {
+                m_layerColors[GetHandleValue(pLayer)] = pLayer->color().color();
+                pLayer->close();
+            }
+        }
+        delete pIter;
+    }
+    pLayerTable->close();
+}
+
+size_t DatabaseDeltaReactor::Drain(std::vector<EntityDelta>& out) {
+    return m_queue.Drain(out);
+}
+
+bool DatabaseDeltaReactor::MeasureEntity(const AcDbEntity* pEnt, EntityDelta::Measure& measure) {
+    if (!pEnt) return false;
+
+    int colorIndex = ResolveColorIndex(pEnt, &measure.trueColor);
+    if (colorIndex < 1 || colorIndex > 255) return false;
+
+    measure.colorIndex = colorIndex;
+
+    if (const AcDbHatch* pHatch = AcDbHatch::cast(pEnt)) {
+        double area = 0.0;
+        if (pHatch->getArea(area) == Acad::eOk) {
+            measure.area = area;
+        }
+        return true;
+    }
+
+    if (const AcDbCurve* pCurve = AcDbCurve::cast(pEnt)) {
+        double endParam = 0.0;
+        double length = 0.0;
+        if (pCurve->getEndParam(endParam) == Acad::eOk &&
+            pCurve->getDistAtParam(endParam, length) == Acad::eOk) {
+            measure.length = length;
+        }
+        if (pCurve->isClosed()) {
+            double area = 0.0;
+            if (pCurve->getArea(area) == Acad::eOk) {
+                measure.area = area;
+            }
+        }
+        return true;
+    }
+
+    if (AcDbBlockReference::cast(pEnt) || AcDbPoint::cast(pEnt)) {
+        measure.count = 1.0;
+        return true;
+    }
+
+    return false;
+}
+
+int DatabaseDeltaReactor::ResolveColorIndex(const AcDbEntity* pEnt, std::uint32_t* trueColor) {
+    AcCmColor color = pEnt->color();
+    if (color.isByLayer()) {
+        // ByLayer - resolve through the entity's layer
+        AcDbLayerTableRecord* pLayer = nullptr;
+        if (acdbOpenObject(pLayer, pEnt->layerId(), AcDb::kForRead) == Acad::eOk) {
+            color = pLayer->color();
+            pLayer->close();
+        }
+    }
+    if (color.isByColor()) {
+        // True color - bucket under the perceptually nearest ACI index, keep the exact RGB alongside
+        if (trueColor) *trueColor = TrueColorTable::Pack(color.red(), color.green(), color.blue());
+        return AciPalette::Nearest(color.red(), color.green(), color.blue());
+    }
+    return color.colorIndex();
+}
+
+std::uint64_t DatabaseDeltaReactor::GetHandleValue(const AcDbObject* pObj) {
+    AcDbHandle handle;
+    pObj->getAcDbHandle(handle);
+    return (static_cast<std::uint64_t>(handle.high()) << 32) | handle.low();
+}
+#endif
+#endif
+
+} // namespace EnhancedTakeoff
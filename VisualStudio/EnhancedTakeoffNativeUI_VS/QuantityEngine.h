@@ -0,0 +1,190 @@
+// QuantityEngine.h - Incremental per-color quantity engine driven by drawing deltas
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <bitset>
+#include <mutex>
+#include <unordered_map>
+
+#include "FlexibleColorAssignment.h"
+#include "DeterministicSum.h"
+#include "TrueColorTable.h"
+
+#ifndef BUILDING_TESTS
+#if HAS_BRX_SDK
+#include "dbmain.h"
+#include "dbents.h"
+#endif
+#endif
+
+namespace EnhancedTakeoff {
+
+/**
+ * A single entity change reported by the drawing (or by a test feed)
+ * Measures are pre-computed by the producer so the engine never touches AcDb objects
+ */
+struct EntityDelta {
+    enum class Kind {
+        Added,
+        Modified,
+        Erased
+    };
+
+    struct Measure {
+        int colorIndex;      // BricsCAD color index (1-255), 0 = not takeoff-relevant
+        std::uint32_t trueColor;  // Packed 0xRRGGBB, TrueColorTable::kNoColor for ACI entities
+        double length;       // Contribution to LF totals
+        double area;         // Contribution to SF totals
+        double count;        // Contribution to EA totals
+
+        Measure() : colorIndex(0), trueColor(TrueColorTable::kNoColor), length(0.0), area(0.0), count(0.0) {}
+    };
+
+    Kind kind;
+    std::uint64_t handle;    // Stable entity handle
+    Measure measure;         // New measure (ignored for Erased)
+
+    EntityDelta() : kind(Kind::Added), handle(0) {}
+    EntityDelta(Kind k, std::uint64_t h, const Measure& m = Measure())
+        : kind(k), handle(h), measure(m) {}
+};
+
+/**
+ * Source of entity deltas - the database reactor in BricsCAD, an in-memory queue in tests
+ */
+class EntityDeltaFeed {
+public:
+    virtual ~EntityDeltaFeed() = default;
+
+    // Move all pending deltas into 'out' (appending) and return how many were added
+    virtual size_t Drain(std::vector<EntityDelta>& out) = 0;
+};
+
+/**
+ * Thread-safe in-memory delta queue
+ * COPILOT-HINT: Used by the headless BUILDING_TESTS path and as the reactor's backing store
+ */
+class InMemoryDeltaFeed : public EntityDeltaFeed {
+public:
+    void Push(const EntityDelta& delta);
+    void PushAdded(std::uint64_t handle, const EntityDelta::Measure& measure);
+    void PushModified(std::uint64_t handle, const EntityDelta::Measure& measure);
+    void PushErased(std::uint64_t handle);
+
+    size_t Drain(std::vector<EntityDelta>& out) override;
+    size_t GetPendingCount() const;
+
+private:
+    mutable std::mutex m_mutex;
+    std::vector<EntityDelta> m_pending;
+};
+
+/**
+ * Incremental quantity engine - keeps running per-color LF/SF/EA totals
+ * A refresh costs O(changed entities) instead of a full drawing rescan
+ * COPILOT-HINT: Per-entity contributions are remembered so modify/erase can be backed out
+ * Totals are fixed-point, so any sequence of deltas reaching the same drawing gives the same totals
+ */
+class QuantityEngine {
+public:
+    struct ColorTotals {
+        double linearFeet;
+        double squareFeet;
+        double each;
+        int entityCount;
+
+        ColorTotals() : linearFeet(0.0), squareFeet(0.0), each(0.0), entityCount(0) {}
+    };
+
+    QuantityEngine();
+    ~QuantityEngine();
+
+    // Delta consumption
+    void ApplyDelta(const EntityDelta& delta);
+    size_t ApplyDeltas(const std::vector<EntityDelta>& deltas);
+    size_t Pump(EntityDeltaFeed& feed);
+    void Reset();
+
+    // Query methods
+    ColorTotals GetTotals(int colorIndex) const;
+    // True-color entities also count under their nearest ACI index; this is the exact-RGB share
+    ColorTotals GetTrueColorTotals(std::uint32_t rgb) const;
+    double GetQuantity(int colorIndex, FlexibleColorAssignment::MeasurementType type) const;
+    // The total a measurement type reads - also applied to boundary-clipped totals
+    static double SelectQuantity(const ColorTotals& totals, FlexibleColorAssignment::MeasurementType type);
+    size_t GetTrackedEntityCount() const;
+
+    // Change tracking - lets the UI skip refreshes when nothing changed
+    bool HasChanges() const;
+    std::vector<int> TakeDirtyColors();
+    std::uint64_t GetRevision() const;
+
+private:
+    struct ColorAccumulator {
+        DeterministicSum linearFeet;
+        DeterministicSum squareFeet;
+        DeterministicSum each;
+        int entityCount;
+
+        ColorAccumulator() : entityCount(0) {}
+    };
+
+    std::unordered_map<std::uint64_t, EntityDelta::Measure> m_entities;
+    ColorAccumulator m_totals[256];
+    TrueColorTable m_trueColorSlots;                    // Packed RGB -> index into m_trueColorTotals
+    std::vector<ColorAccumulator> m_trueColorTotals;
+    std::bitset<256> m_dirtyColors;
+    std::vector<EntityDelta> m_scratch;
+    std::uint64_t m_revision;
+
+    void AddContribution(const EntityDelta::Measure& measure);
+    void RemoveContribution(const EntityDelta::Measure& measure);
+    static bool IsValidColor(int colorIndex);
+    static ColorTotals ToTotals(const ColorAccumulator& accumulator);
+};
+
+#ifndef BUILDING_TESTS
+#if HAS_BRX_SDK
+/**
+ * Database reactor that measures appended/modified/erased model space entities and queues deltas
+ * A layer color change re-measures the ByLayer entities on that layer
+ * COPILOT-HINT: Attach to the working database; the dialog pumps it on its refresh timer. Block definitions
+ * and paper space layouts are ignored, matching SeedFromDatabase
+ */
+class DatabaseDeltaReactor : public AcDbDatabaseReactor, public EntityDeltaFeed {
+public:
+    explicit DatabaseDeltaReactor(AcDbDatabase* pDb);
+    virtual ~DatabaseDeltaReactor();
+
+    // Queue an Added delta for every model space entity (initial population)
+    size_t SeedFromDatabase();
+
+    void objectAppended(const AcDbDatabase* pDb, const AcDbObject* pObj) override;
+    void objectModified(const AcDbDatabase* pDb, const AcDbObject* pObj) override;
+    void objectErased(const AcDbDatabase* pDb, const AcDbObject* pObj,
+                      Adesk::Boolean bErased) override;
+
+    size_t Drain(std::vector<EntityDelta>& out) override;
+
+    static bool MeasureEntity(const AcDbEntity* pEnt, EntityDelta::Measure& measure);
+    // trueColor (optional) receives the packed RGB of a true-color entity, else is left unchanged
+    static int ResolveColorIndex(const AcDbEntity* pEnt, std::uint32_t* trueColor = nullptr);
+    static std::uint64_t GetHandleValue(const AcDbObject* pObj);
+
+private:
+    AcDbDatabase* m_pDb;
+    AcDbObjectId m_modelSpaceId;
+    std::unordered_map<std::uint64_t, Adesk::UInt32> m_layerColors;    // Layer handle -> last seen color
+    InMemoryDeltaFeed m_queue;
+
+    bool IsModelSpaceEntity(const AcDbObject* pObj) const;
+    void QueueMeasured(const AcDbEntity* pEnt);
+    void OnLayerModified(const AcDbLayerTableRecord* pLayer);
+    void RecordLayerColors();
+};
+#endif
+#endif
+
+} // namespace EnhancedTakeoff
@@ -0,0 +1,164 @@
+// QuantityEngineTests.cpp - Behavior tests for the incremental quantity engine
+// Enhanced Construction Takeoff - BricsCAD V25 Plugin
+// COPILOT-HINT: Deltas are fed directly or through InMemoryDeltaFeed - the reactor is not involved
+
+#include "pch.h"
+#include "TakeoffTests.h"
+#include "QuantityEngine.h"
+
+#ifdef BUILDING_TESTS
+
+namespace EnhancedTakeoff {
+
+namespace {
+    EntityDelta::Measure MakeMeasure(int colorIndex, double length, double area, double count,
+                                     std::uint32_t trueColor = TrueColorTable::kNoColor) {
+        EntityDelta::Measure measure;
+        measure.colorIndex = colorIndex;
+        measure.trueColor = trueColor;
+        measure.length = length;
+        measure.area = area;
+        measure.count = count;
+        return measure;
+    }
+
+    bool SameTotals(const QuantityEngine::ColorTotals& a, const QuantityEngine::ColorTotals& b) {
+        return a.linearFeet == b.linearFeet && a.squareFeet == b.squareFeet &&
+               a.each == b.each && a.entityCount == b.entityCount;
+    }
+
+    void TestAddedDeltasAccumulate(TakeoffTests::Result& result) {
+        QuantityEngine engine;
+        engine.ApplyDelta(EntityDelta(EntityDelta::Kind::Added, 1, MakeMeasure(5, 10.0, 0.0, 0.0)));
+        engine.ApplyDelta(EntityDelta(EntityDelta::Kind::Added, 2, MakeMeasure(5, 2.5, 40.0, 1.0)));
+
+        const QuantityEngine::ColorTotals totals = engine.GetTotals(5);
+        TakeoffTests::Expect(result, totals.linearFeet == 12.5, "LF is the sum of both entities");
+        TakeoffTests::Expect(result, totals.squareFeet == 40.0, "SF is the sum of both entities");
+        TakeoffTests::Expect(result, totals.each == 1.0 && totals.entityCount == 2, "EA and entity count");
+        TakeoffTests::Expect(result, engine.GetTotals(6).entityCount == 0, "other colors stay empty");
+        TakeoffTests::Expect(result, engine.GetTrackedEntityCount() == 2, "both handles tracked");
+    }
+
+    void TestModifiedDeltaReplacesContribution(TakeoffTests::Result& result) {
+        QuantityEngine engine;
+        engine.ApplyDelta(EntityDelta(EntityDelta::Kind::Added, 1, MakeMeasure(5, 10.0, 0.0, 0.0)));
+        engine.ApplyDelta(EntityDelta(EntityDelta::Kind::Modified, 1, MakeMeasure(5, 4.0, 0.0, 0.0)));
+
+        const QuantityEngine::ColorTotals totals = engine.GetTotals(5);
+        TakeoffTests::Expect(result, totals.linearFeet == 4.0, "the old length is backed out");
+        TakeoffTests::Expect(result, totals.entityCount == 1, "the entity is counted once");
+    }
+
+    void TestModifiedDeltaMovesBetweenColors(TakeoffTests::Result& result) {
+        QuantityEngine engine;
+        engine.ApplyDelta(EntityDelta(EntityDelta::Kind::Added, 1, MakeMeasure(5, 10.0, 0.0, 0.0)));
+        engine.ApplyDelta(EntityDelta(EntityDelta::Kind::Modified, 1, MakeMeasure(7, 10.0, 0.0, 0.0)));
+
+        TakeoffTests::Expect(result, engine.GetTotals(5).entityCount == 0 && engine.GetTotals(5).linearFeet == 0.0,
+                             "the old color is emptied");
+        TakeoffTests::Expect(result, engine.GetTotals(7).linearFeet == 10.0, "the new color receives the length");
+    }
+
+    void TestErasedDeltaRemovesContribution(TakeoffTests::Result& result) {
+        QuantityEngine engine;
+        engine.ApplyDelta(EntityDelta(EntityDelta::Kind::Added, 1, MakeMeasure(5, 10.0, 0.0, 0.0)));
+        engine.ApplyDelta(EntityDelta(EntityDelta::Kind::Added, 2, MakeMeasure(5, 3.0, 0.0, 0.0)));
+        engine.ApplyDelta(EntityDelta(EntityDelta::Kind::Erased, 1));
+        engine.ApplyDelta(EntityDelta(EntityDelta::Kind::Erased, 99));   // Never added
+
+        TakeoffTests::Expect(result, engine.GetTotals(5).linearFeet == 3.0, "only the erased entity is removed");
+        TakeoffTests::Expect(result, engine.GetTotals(5).entityCount == 1, "entity count drops by one");
+        TakeoffTests::Expect(result, engine.GetTrackedEntityCount() == 1, "an unknown erase is ignored");
+    }
+
+    void TestDeltaOrderDoesNotChangeTotals(TakeoffTests::Result& result) {
+        // Values that do not add exactly in binary floating point
+        const double lengths[] = { 0.1, 0.2, 0.3, 1e-7, 12345.678, 0.7 };
+
+        QuantityEngine forward;
+        for (int i = 0; i < 6; ++i) {
+            forward.ApplyDelta(EntityDelta(EntityDelta::Kind::Added, i + 1, MakeMeasure(3, lengths[i], 0.0, 0.0)));
+        }
+
+        // Reverse order with a detour through another value and an add/erase pair
+        QuantityEngine reverse;
+        reverse.ApplyDelta(EntityDelta(EntityDelta::Kind::Added, 100, MakeMeasure(3, 9.9, 0.0, 0.0)));
+        for (int i = 5; i >= 0; --i) {
+            reverse.ApplyDelta(EntityDelta(EntityDelta::Kind::Added, i + 1, MakeMeasure(3, 1.5, 0.0, 0.0)));
+            reverse.ApplyDelta(EntityDelta(EntityDelta::Kind::Modified, i + 1, MakeMeasure(3, lengths[i], 0.0, 0.0)));
+        }
+        reverse.ApplyDelta(EntityDelta(EntityDelta::Kind::Erased, 100));
+
+        TakeoffTests::Expect(result, SameTotals(forward.GetTotals(3), reverse.GetTotals(3)),
+                             "totals are bit-identical whatever the delta order");
+    }
+
+    void TestPumpDrainsFeed(TakeoffTests::Result& result) {
+        InMemoryDeltaFeed feed;
+        feed.PushAdded(1, MakeMeasure(5, 10.0, 0.0, 0.0));
+        feed.PushModified(1, MakeMeasure(5, 6.0, 0.0, 0.0));
+        feed.PushAdded(2, MakeMeasure(8, 0.0, 0.0, 1.0));
+        feed.PushErased(2);
+
+        QuantityEngine engine;
+        TakeoffTests::Expect(result, engine.Pump(feed) == 4, "every queued delta is applied");
+        TakeoffTests::Expect(result, feed.GetPendingCount() == 0, "the feed is empty afterwards");
+        TakeoffTests::Expect(result, engine.GetTotals(5).linearFeet == 6.0, "deltas apply in queue order");
+        TakeoffTests::Expect(result, engine.GetTotals(8).entityCount == 0, "the erase follows the add");
+        TakeoffTests::Expect(result, engine.Pump(feed) == 0, "a second pump has nothing to do");
+    }
+
+    void TestDirtyColorsTrackChanges(TakeoffTests::Result& result) {
+        QuantityEngine engine;
+        const std::uint64_t startRevision = engine.GetRevision();
+        engine.ApplyDelta(EntityDelta(EntityDelta::Kind::Added, 1, MakeMeasure(5, 1.0, 0.0, 0.0)));
+        engine.ApplyDelta(EntityDelta(EntityDelta::Kind::Modified, 1, MakeMeasure(9, 1.0, 0.0, 0.0)));
+
+        TakeoffTests::Expect(result, engine.HasChanges(), "changes are reported");
+        TakeoffTests::Expect(result, engine.GetRevision() == startRevision + 2, "one revision per delta");
+        TakeoffTests::Expect(result, engine.TakeDirtyColors() == std::vector<int>({ 5, 9 }),
+                             "both the old and the new color are dirty");
+        TakeoffTests::Expect(result, !engine.HasChanges() && engine.TakeDirtyColors().empty(),
+                             "taking the dirty colors clears them");
+    }
+
+    void TestTrueColorTotalsKeepExactShare(TakeoffTests::Result& result) {
+        const std::uint32_t rgb = TrueColorTable::Pack(200, 10, 10);
+        QuantityEngine engine;
+        engine.ApplyDelta(EntityDelta(EntityDelta::Kind::Added, 1, MakeMeasure(1, 0.0, 50.0, 0.0, rgb)));
+        engine.ApplyDelta(EntityDelta(EntityDelta::Kind::Added, 2, MakeMeasure(1, 0.0, 20.0, 0.0)));
+
+        TakeoffTests::Expect(result, engine.GetTotals(1).squareFeet == 70.0, "true color counts under its ACI index");
+        TakeoffTests::Expect(result, engine.GetTrueColorTotals(rgb).squareFeet == 50.0, "exact-RGB share");
+
+        engine.ApplyDelta(EntityDelta(EntityDelta::Kind::Erased, 1));
+        TakeoffTests::Expect(result, engine.GetTrueColorTotals(rgb).entityCount == 0, "erase backs out the RGB share");
+    }
+
+    void TestUntrackedColorIsIgnored(TakeoffTests::Result& result) {
+        QuantityEngine engine;
+        engine.ApplyDelta(EntityDelta(EntityDelta::Kind::Added, 1, MakeMeasure(0, 10.0, 0.0, 0.0)));
+
+        TakeoffTests::Expect(result, engine.GetTotals(0).entityCount == 0, "color 0 has no totals");
+        TakeoffTests::Expect(result, !engine.HasChanges(), "color 0 marks nothing dirty");
+    }
+}
+
+std::vector<TakeoffTests::Result> TakeoffTests::RunQuantityEngineTests() {
+    return Run({
+        { "QuantityEngine.AddedDeltasAccumulate", TestAddedDeltasAccumulate },
+        { "QuantityEngine.ModifiedDeltaReplacesContribution", TestModifiedDeltaReplacesContribution },
+        { "QuantityEngine.ModifiedDeltaMovesBetweenColors", TestModifiedDeltaMovesBetweenColors },
+        { "QuantityEngine.ErasedDeltaRemovesContribution", TestErasedDeltaRemovesContribution },
+        { "QuantityEngine.DeltaOrderDoesNotChangeTotals", TestDeltaOrderDoesNotChangeTotals },
+        { "QuantityEngine.PumpDrainsFeed", TestPumpDrainsFeed },
+        { "QuantityEngine.DirtyColorsTrackChanges", TestDirtyColorsTrackChanges },
+        { "QuantityEngine.TrueColorTotalsKeepExactShare", TestTrueColorTotalsKeepExactShare },
+        { "QuantityEngine.UntrackedColorIsIgnored", TestUntrackedColorIsIgnored },
+    });
+}
+
+} // namespace EnhancedTakeoff
+
+#endif
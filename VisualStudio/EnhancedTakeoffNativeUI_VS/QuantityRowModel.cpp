@@ -0,0 +1,84 @@
+// QuantityRowModel.cpp - Dirty-row diffing for the quantity list
+// Enhanced Construction Takeoff - BricsCAD V25 Plugin
+// COPILOT-HINT: Positions in the returned changes account for earlier inserts/removes
+
+#include "pch.h"
+#include "QuantityRowModel.h"
+
+#include <cmath>
+
+namespace EnhancedTakeoff {
+
+QuantityRowModel::QuantityRowModel() {
+}
+
+QuantityRowModel::~QuantityRowModel() {
+    m_rows.clear();
+}
+
+std::vector<QuantityRowModel::Change> QuantityRowModel::Diff(const std::vector<Row>& rows) {
+    std::vector<Change> changes;
+
+    // Merge walk over both color-ordered lists; 'position' tracks the live list
+    size_t oldIndex = 0;
+    size_t newIndex = 0;
+    int position = 0;
+    while (oldIndex < m_rows.size() || newIndex < rows.size()) {
+        const bool hasOld = oldIndex < m_rows.size();
+        const bool hasNew = newIndex < rows.size();
+
+        Change change;
+        change.position = position;
+
+        if (hasOld && (!hasNew || m_rows[oldIndex].colorIndex < rows[newIndex].colorIndex)) {
+            // Color no longer shown - the next row slides up into this position
+            change.op = Change::Op::Remove;
+            change.row = m_rows[oldIndex];
+            changes.push_back(change);
+            oldIndex++;
+        } else if (hasNew && (!hasOld || rows[newIndex].colorIndex < m_rows[oldIndex].colorIndex)) {
+            change.op = Change::Op::Insert;
+            change.columnMask = (1u << ColumnCount) - 1;
+            change.row = rows[newIndex];
+            changes.push_back(change);
+            newIndex++;
+            position++;
+        } else {
+            unsigned int mask = CompareRows(m_rows[oldIndex], rows[newIndex]);
+            if (mask != 0) {
+                change.op = Change::Op::Update;
+                change.columnMask = mask;
+                change.row = rows[newIndex];
+                changes.push_back(change);
+            }
+            oldIndex++;
+            newIndex++;
+            position++;
+        }
+    }
+
+    m_rows = rows;
+    return changes;
+}
+
+unsigned int QuantityRowModel::CompareRows(const Row& before, const Row& after) {
+    unsigned int mask = 0;
+    if (before.colorIndex != after.colorIndex) mask |= 1u << ColumnColor;
+    if (before.materialName != after.materialName) mask |= 1u << ColumnMaterial;
+    if (ToCents(before.quantity) != ToCents(after.quantity)) mask |= 1u << ColumnQuantity;
+    if (before.measurementType != after.measurementType) mask |= 1u << ColumnUnit;
+    if (ToCents(before.unitCost) != ToCents(after.unitCost)) mask |= 1u << ColumnUnitCost;
+    if (ToCents(before.totalCost) != ToCents(after.totalCost)) mask |= 1u << ColumnTotalCost;
+    return mask;
+}
+
+void QuantityRowModel::Clear() {
+    m_rows.clear();
+}
+
+long long QuantityRowModel::ToCents(double value) {
+    // Matches the "%.2f" formatting used by the list
+    return std::llround(value * 100.0);
+}
+
+} // namespace EnhancedTakeoff
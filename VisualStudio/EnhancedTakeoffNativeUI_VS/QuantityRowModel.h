@@ -0,0 +1,77 @@
+// QuantityRowModel.h - Last-displayed quantity rows with dirty-row diffing
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "NameTable.h"
+
+namespace EnhancedTakeoff {
+
+/**
+ * Model of the rows currently shown in the quantity list
+ * Diff() compares a fresh set of rows against what is displayed and returns the
+ * minimal insert/update/remove operations, so the dialog only touches changed cells
+ * COPILOT-HINT: No MFC here - the dialog applies the changes to its CListCtrl
+ */
+class QuantityRowModel {
+public:
+    // List columns, in display order
+    enum Column {
+        ColumnColor = 0,
+        ColumnMaterial,
+        ColumnQuantity,
+        ColumnUnit,
+        ColumnUnitCost,
+        ColumnTotalCost,
+        ColumnCount
+    };
+
+    struct Row {
+        int colorIndex;
+        InternedName materialName;
+        double quantity;
+        int measurementType;     // FlexibleColorAssignment::MeasurementType, -1 = none
+        double unitCost;
+        double totalCost;
+
+        Row() : colorIndex(0), quantity(0.0), measurementType(-1),
+                unitCost(0.0), totalCost(0.0) {}
+    };
+
+    struct Change {
+        enum class Op {
+            Insert,   // Insert 'row' at 'position' and fill every column
+            Update,   // Rewrite the columns set in 'columnMask' at 'position'
+            Remove    // Delete the item at 'position'
+        };
+
+        Op op;
+        int position;            // List position at the time the change is applied
+        unsigned int columnMask; // Bit per Column
+        Row row;
+
+        Change() : op(Op::Update), position(0), columnMask(0) {}
+    };
+
+    QuantityRowModel();
+    ~QuantityRowModel();
+
+    // Rows must be ordered by ascending color index (GetAllAssignments order).
+    // Returns the changes in the order they must be applied and adopts 'rows'
+    std::vector<Change> Diff(const std::vector<Row>& rows);
+
+    // Column mask of the cells that differ between two rows of the same color
+    static unsigned int CompareRows(const Row& before, const Row& after);
+
+    void Clear();
+    const std::vector<Row>& GetRows() const { return m_rows; }
+
+private:
+    std::vector<Row> m_rows;
+
+    // Values are compared at display precision so sub-cent drift does not repaint
+    static long long ToCents(double value);
+};
+
+} // namespace EnhancedTakeoff
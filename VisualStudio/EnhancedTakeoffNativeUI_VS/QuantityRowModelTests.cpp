@@ -0,0 +1,142 @@
+// QuantityRowModelTests.cpp - Behavior tests for quantity list row diffing
+// Enhanced Construction Takeoff - BricsCAD V25 Plugin
+// COPILOT-HINT: A plain vector stands in for the CListCtrl the dialog applies the changes to
+
+#include "pch.h"
+#include "TakeoffTests.h"
+#include "QuantityRowModel.h"
+
+#ifdef BUILDING_TESTS
+
+namespace EnhancedTakeoff {
+
+namespace {
+    typedef QuantityRowModel::Row Row;
+    typedef QuantityRowModel::Change Change;
+
+    Row MakeRow(int colorIndex, const char* material, double quantity, double unitCost) {
+        Row row;
+        row.colorIndex = colorIndex;
+        row.materialName = material;
+        row.quantity = quantity;
+        row.measurementType = 0;
+        row.unitCost = unitCost;
+        row.totalCost = quantity * unitCost;
+        return row;
+    }
+
+    unsigned int Bit(QuantityRowModel::Column column) {
+        return 1u << column;
+    }
+
+    // Replays the changes the way the dialog does and returns the resulting colors
+    std::vector<int> ApplyChanges(std::vector<Row> list, const std::vector<Change>& changes) {
+        for (const Change& change : changes) {
+            switch (change.op) {
+                case Change::Op::Insert:
+                    list.insert(list.begin() + change.position, change.row);
+                    break;
+                case Change::Op::Update:
+                    list[change.position] = change.row;
+                    break;
+                case Change::Op::Remove:
+                    list.erase(list.begin() + change.position);
+                    break;
+            }
+        }
+
+        std::vector<int> colors;
+        for (const Row& row : list) colors.push_back(row.colorIndex);
+        return colors;
+    }
+
+    void TestFirstDiffInsertsEveryRow(TakeoffTests::Result& result) {
+        QuantityRowModel model;
+        const std::vector<Change> changes = model.Diff({ MakeRow(1, "Concrete", 10.0, 5.0),
+                                                         MakeRow(4, "Rebar", 2.0, 1.0) });
+
+        if (!TakeoffTests::Expect(result, changes.size() == 2, "one change per row")) return;
+        TakeoffTests::Expect(result, changes[0].op == Change::Op::Insert && changes[0].position == 0,
+                             "first row inserted at 0");
+        TakeoffTests::Expect(result, changes[1].op == Change::Op::Insert && changes[1].position == 1,
+                             "second row inserted at 1");
+        TakeoffTests::Expect(result, changes[0].columnMask == (1u << QuantityRowModel::ColumnCount) - 1,
+                             "an insert fills every column");
+        TakeoffTests::Expect(result, model.GetRows().size() == 2, "the model adopts the rows");
+    }
+
+    void TestUnchangedRowsProduceNoChanges(TakeoffTests::Result& result) {
+        QuantityRowModel model;
+        const std::vector<Row> rows = { MakeRow(1, "Concrete", 10.0, 5.0), MakeRow(4, "Rebar", 2.0, 1.0) };
+        model.Diff(rows);
+
+        TakeoffTests::Expect(result, model.Diff(rows).empty(), "identical rows repaint nothing");
+    }
+
+    void TestUpdateCarriesOnlyChangedColumns(TakeoffTests::Result& result) {
+        QuantityRowModel model;
+        model.Diff({ MakeRow(1, "Concrete", 10.0, 5.0), MakeRow(4, "Rebar", 2.0, 1.0) });
+        const std::vector<Change> changes = model.Diff({ MakeRow(1, "Concrete", 10.0, 5.0),
+                                                         MakeRow(4, "Rebar", 3.0, 1.0) });
+
+        if (!TakeoffTests::Expect(result, changes.size() == 1, "only the changed row is reported")) return;
+        TakeoffTests::Expect(result, changes[0].op == Change::Op::Update && changes[0].position == 1,
+                             "update at the row's list position");
+        TakeoffTests::Expect(result,
+                             changes[0].columnMask == (Bit(QuantityRowModel::ColumnQuantity) |
+                                                       Bit(QuantityRowModel::ColumnTotalCost)),
+                             "only the quantity and total cost cells are rewritten");
+        TakeoffTests::Expect(result, changes[0].row.quantity == 3.0, "the update carries the new values");
+    }
+
+    void TestSubCentDriftIsIgnored(TakeoffTests::Result& result) {
+        QuantityRowModel model;
+        model.Diff({ MakeRow(1, "Concrete", 10.0, 1.0) });
+
+        TakeoffTests::Expect(result, model.Diff({ MakeRow(1, "Concrete", 10.001, 1.0) }).empty(),
+                             "drift below display precision does not repaint");
+        TakeoffTests::Expect(result, !model.Diff({ MakeRow(1, "Concrete", 10.01, 1.0) }).empty(),
+                             "a visible change does");
+    }
+
+    void TestRemoveShiftsLaterPositions(TakeoffTests::Result& result) {
+        QuantityRowModel model;
+        model.Diff({ MakeRow(1, "Concrete", 1.0, 1.0), MakeRow(2, "Block", 1.0, 1.0),
+                     MakeRow(3, "Rebar", 1.0, 1.0) });
+        const std::vector<Change> changes = model.Diff({ MakeRow(1, "Concrete", 1.0, 1.0),
+                                                         MakeRow(3, "Rebar", 4.0, 1.0) });
+
+        if (!TakeoffTests::Expect(result, changes.size() == 2, "one remove and one update")) return;
+        TakeoffTests::Expect(result, changes[0].op == Change::Op::Remove && changes[0].position == 1,
+                             "the dropped color is removed at its position");
+        TakeoffTests::Expect(result, changes[1].op == Change::Op::Update && changes[1].position == 1,
+                             "the next row is updated where it slid to");
+    }
+
+    void TestChangesReplayToNewRows(TakeoffTests::Result& result) {
+        QuantityRowModel model;
+        const std::vector<Row> before = { MakeRow(2, "Block", 1.0, 1.0), MakeRow(5, "Drywall", 1.0, 1.0),
+                                          MakeRow(7, "Paint", 1.0, 1.0), MakeRow(9, "Trim", 1.0, 1.0) };
+        const std::vector<Row> after = { MakeRow(1, "Concrete", 1.0, 1.0), MakeRow(5, "Drywall", 2.0, 1.0),
+                                         MakeRow(6, "Insulation", 1.0, 1.0), MakeRow(10, "Roofing", 1.0, 1.0) };
+        model.Diff(before);
+
+        TakeoffTests::Expect(result, ApplyChanges(before, model.Diff(after)) == std::vector<int>({ 1, 5, 6, 10 }),
+                             "replaying inserts, updates and removes yields the new list");
+    }
+}
+
+std::vector<TakeoffTests::Result> TakeoffTests::RunQuantityRowModelTests() {
+    return Run({
+        { "QuantityRowModel.FirstDiffInsertsEveryRow", TestFirstDiffInsertsEveryRow },
+        { "QuantityRowModel.UnchangedRowsProduceNoChanges", TestUnchangedRowsProduceNoChanges },
+        { "QuantityRowModel.UpdateCarriesOnlyChangedColumns", TestUpdateCarriesOnlyChangedColumns },
+        { "QuantityRowModel.SubCentDriftIsIgnored", TestSubCentDriftIsIgnored },
+        { "QuantityRowModel.RemoveShiftsLaterPositions", TestRemoveShiftsLaterPositions },
+        { "QuantityRowModel.ChangesReplayToNewRows", TestChangesReplayToNewRows },
+    });
+}
+
+} // namespace EnhancedTakeoff
+
+#endif
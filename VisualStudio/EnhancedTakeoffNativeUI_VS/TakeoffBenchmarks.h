@@ -0,0 +1,57 @@
+// TakeoffBenchmarks.h - Headless micro-benchmarks for the quantity core
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace EnhancedTakeoff {
+
+class EntitySnapshotStore;
+
+/**
+ * Synthetic-plan benchmarks for the headless quantity core
+ * COPILOT-HINT: No BRX SDK or MFC needed - run with "TakeoffTests --bench" (CMakeLists.txt)
+ */
+class TakeoffBenchmarks {
+public:
+    struct Result {
+        std::string name;
+        size_t entityCount;
+        double setupMs;        // Time to build the input (not part of the measured pass)
+        double elapsedMs;      // Best-of-N time for the measured pass
+        double checksum;       // Sum of outputs so the optimizer cannot drop the work
+
+        Result() : entityCount(0), setupMs(0.0), elapsedMs(0.0), checksum(0.0) {}
+    };
+
+    // Fill a snapshot with a deterministic mix of lines, polylines, hatches and blocks
+    static void FillSyntheticPlan(EntitySnapshotStore& store, size_t entityCount,
+                                  std::uint32_t seed = 12345);
+
+    // Columnar per-color aggregation over a synthetic plan (default 1M entities)
+    static Result BenchmarkSnapshotAggregation(size_t entityCount = 1000000, int iterations = 5);
+
+    // Chunked parallel aggregation at the given thread count (0 = hardware concurrency)
+    static Result BenchmarkParallelAggregation(size_t entityCount = 1000000,
+                                               unsigned int threadCount = 0, int iterations = 5);
+
+    // LF/SF kernels on dense siding/trim polylines: scalar reference vs every supported instruction set
+    static std::vector<Result> BenchmarkPolylineKernels(size_t polylineCount = 100000,
+                                                        size_t verticesPerPolyline = 64,
+                                                        int iterations = 5);
+
+    // Full-plan pricing: per-value CalculateQuantity/CalculateCost vs the batch overloads
+    static std::vector<Result> BenchmarkBatchPricing(size_t valueCount = 1000000, int iterations = 5);
+
+    // Boundary membership for 'boundaryCount' regions: linear scan vs R-tree per region vs one batched query
+    static std::vector<Result> BenchmarkBoundaryQueries(size_t entityCount = 1000000,
+                                                        size_t boundaryCount = 48, int iterations = 5);
+
+    // Run every benchmark and format one line per result
+    static std::vector<Result> RunAll(size_t entityCount = 1000000);
+    static std::string FormatResult(const Result& result);
+};
+
+} // namespace EnhancedTakeoff
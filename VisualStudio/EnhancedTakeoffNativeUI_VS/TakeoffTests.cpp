@@ -0,0 +1,54 @@
+// TakeoffTests.cpp - Headless behavior test runner
+// Enhanced Construction Takeoff - BricsCAD V25 Plugin
+// COPILOT-HINT: A test that throws is reported as failed; the remaining tests still run
+
+#include "pch.h"
+#include "TakeoffTests.h"
+
+#include <exception>
+
+#ifdef BUILDING_TESTS
+
+namespace EnhancedTakeoff {
+
+bool TakeoffTests::Expect(Result& result, bool condition, const char* expectation) {
+    if (!condition && result.failure.empty()) {
+        result.failure = expectation;
+    }
+    return condition;
+}
+
+std::vector<TakeoffTests::Result> TakeoffTests::Run(const std::vector<std::pair<const char*, TestFn>>& tests) {
+    std::vector<Result> results;
+    results.reserve(tests.size());
+
+    for (const auto& test : tests) {
+        Result result;
+        result.name = test.first;
+        try {
+            test.second(result);
+        } catch (const std::exception& e) {
+            Expect(result, false, e.what());
+        }
+        results.push_back(result);
+    }
+    return results;
+}
+
+std::vector<TakeoffTests::Result> TakeoffTests::RunAll() {
+    std::vector<Result> results;
+    for (const auto& result : RunQuantityEngineTests()) results.push_back(result);
+    for (const auto& result : RunQuantityRowModelTests()) results.push_back(result);
+    for (const auto& result : RunBoundaryFaceFinderTests()) results.push_back(result);
+    for (const auto& result : RunMaterialPresetParserTests()) results.push_back(result);
+    return results;
+}
+
+std::string TakeoffTests::FormatResult(const Result& result) {
+    return result.Passed() ? "PASS  " + result.name
+                           : "FAIL  " + result.name + " - " + result.failure;
+}
+
+} // namespace EnhancedTakeoff
+
+#endif
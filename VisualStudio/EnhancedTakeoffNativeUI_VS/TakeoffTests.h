@@ -0,0 +1,46 @@
+// TakeoffTests.h - Headless behavior tests for the quantity core
+#pragma once
+
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace EnhancedTakeoff {
+
+/**
+ * Focused behavior tests for the headless modules - one test per behavior
+ * COPILOT-HINT: No BRX SDK or MFC needed - the TakeoffTests target in CMakeLists.txt builds
+ * them with BUILDING_TESTS and exits non-zero when any test fails.
+ * Each module's tests live next to it in <Module>Tests.cpp
+ */
+class TakeoffTests {
+public:
+    struct Result {
+        std::string name;
+        std::string failure;    // First failed expectation, empty when the test passed
+
+        bool Passed() const { return failure.empty(); }
+    };
+    typedef void (*TestFn)(Result& result);
+
+    // Keeps only the first failure; returns the condition so a test can stop early
+    static bool Expect(Result& result, bool condition, const char* expectation);
+
+    // Incremental totals from add/modify/erase deltas
+    static std::vector<Result> RunQuantityEngineTests();
+    // Insert/update/remove diffing of the displayed quantity rows
+    static std::vector<Result> RunQuantityRowModelTests();
+    // Closed faces found in loose boundary linework
+    static std::vector<Result> RunBoundaryFaceFinderTests();
+    // Preset CSV parsing, error reporting and the save/load round trip
+    static std::vector<Result> RunMaterialPresetParserTests();
+
+    // Run every module's tests and format one line per result
+    static std::vector<Result> RunAll();
+    static std::string FormatResult(const Result& result);
+
+private:
+    static std::vector<Result> Run(const std::vector<std::pair<const char*, TestFn>>& tests);
+};
+
+} // namespace EnhancedTakeoff
@@ -0,0 +1,43 @@
+// TakeoffTestsMain.cpp - Console host for the headless tests and benchmarks
+// Enhanced Construction Takeoff - BricsCAD V25 Plugin
+// COPILOT-HINT: Built only by the BUILDING_TESTS target in CMakeLists.txt - the plugin DLL has no main.
+// "TakeoffTests" runs every test and exits with the failure count; "--bench [entities]" runs the benchmarks
+
+#include "pch.h"
+#include "TakeoffTests.h"
+#include "TakeoffBenchmarks.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#ifdef BUILDING_TESTS
+
+int main(int argc, char* argv[]) {
+    using namespace EnhancedTakeoff;
+
+    if (argc > 1 && std::strcmp(argv[1], "--bench") == 0) {
+        const size_t entityCount = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 1000000;
+        if (entityCount == 0) {
+            std::fprintf(stderr, "usage: %s --bench [entityCount]\n", argv[0]);
+            return 2;
+        }
+        for (const TakeoffBenchmarks::Result& result : TakeoffBenchmarks::RunAll(entityCount)) {
+            std::printf("%s\n", TakeoffBenchmarks::FormatResult(result).c_str());
+        }
+        return 0;
+    }
+
+    int failed = 0;
+    const std::vector<TakeoffTests::Result> results = TakeoffTests::RunAll();
+    for (const TakeoffTests::Result& result : results) {
+        std::printf("%s\n", TakeoffTests::FormatResult(result).c_str());
+        if (!result.Passed()) {
+            failed++;
+        }
+    }
+    std::printf("%d of %d tests passed\n", static_cast<int>(results.size()) - failed, static_cast<int>(results.size()));
+    return failed > 0 ? 1 : 0;
+}
+
+#endif
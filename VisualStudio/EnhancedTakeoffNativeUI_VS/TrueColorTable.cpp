@@ -0,0 +1,92 @@
+// TrueColorTable.cpp - Open-addressing hash keyed by packed 24-bit RGB
+// Enhanced Construction Takeoff - BricsCAD V25 Plugin
+// COPILOT-HINT: Backward-shift deletion keeps every probe run contiguous - no tombstones to clean up
+
+#include "pch.h"
+#include "TrueColorTable.h"
+
+namespace EnhancedTakeoff {
+
+namespace {
+    const size_t kInitialSlots = 16;
+}
+
+TrueColorTable::TrueColorTable() : m_mask(0), m_size(0), m_shift(0) {
+    Rehash(kInitialSlots);
+}
+
+bool TrueColorTable::Insert(std::uint32_t rgb, std::uint32_t value) {
+    if (rgb > 0xFFFFFFu) {
+        return false;
+    }
+    if (2 * (m_size + 1) > m_slots.size()) {
+        Rehash(2 * m_slots.size());
+    }
+
+    size_t slot = Home(rgb);
+    while (m_slots[slot].key != kNoColor && m_slots[slot].key != rgb) {
+        slot = (slot + 1) & m_mask;
+    }
+    if (m_slots[slot].key == kNoColor) {
+        m_slots[slot].key = rgb;
+        ++m_size;
+    }
+    m_slots[slot].value = value;
+    return true;
+}
+
+bool TrueColorTable::Erase(std::uint32_t rgb) {
+    if (m_size == 0 || rgb > 0xFFFFFFu) {
+        return false;
+    }
+
+    size_t hole = Home(rgb);
+    while (m_slots[hole].key != rgb) {
+        if (m_slots[hole].key == kNoColor) return false;
+        hole = (hole + 1) & m_mask;
+    }
+
+    // Pull back every later entry of the run whose home does not lie between the hole and itself
+    for (size_t slot = (hole + 1) & m_mask; m_slots[slot].key != kNoColor; slot = (slot + 1) & m_mask) {
+        const size_t home = Home(m_slots[slot].key);
+        const bool reachable = (hole <= slot) ? (home > hole && home <= slot) : (home > hole || home <= slot);
+        if (!reachable) {
+            m_slots[hole] = m_slots[slot];
+            hole = slot;
+        }
+    }
+    m_slots[hole].key = kNoColor;
+    --m_size;
+    return true;
+}
+
+void TrueColorTable::Clear() {
+    for (Slot& slot : m_slots) {
+        slot.key = kNoColor;
+    }
+    m_size = 0;
+}
+
+void TrueColorTable::Rehash(size_t slotCount) {
+    std::vector<Slot> old;
+    old.swap(m_slots);
+
+    Slot empty;
+    empty.key = kNoColor;
+    empty.value = 0;
+    m_slots.assign(slotCount, empty);
+    m_mask = slotCount - 1;
+    m_shift = 32;
+    for (size_t n = slotCount; n > 1; n >>= 1) {
+        --m_shift;
+    }
+    m_size = 0;
+
+    for (const Slot& slot : old) {
+        if (slot.key != kNoColor) {
+            Insert(slot.key, slot.value);
+        }
+    }
+}
+
+} // namespace EnhancedTakeoff
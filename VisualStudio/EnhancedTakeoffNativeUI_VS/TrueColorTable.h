@@ -0,0 +1,77 @@
+// TrueColorTable.h - Open-addressing hash keyed by packed 24-bit RGB
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace EnhancedTakeoff {
+
+/**
+ * Map from a packed 0xRRGGBB true color to a 32-bit value (typically an index into a dense array)
+ * Linear probing over a power-of-two slot array kept at most half full; erase shifts the
+ * following run back instead of leaving tombstones, so a lookup ends at the first empty slot
+ * COPILOT-HINT: Find never allocates - only Insert may grow the slot array
+ */
+class TrueColorTable {
+public:
+    static const std::uint32_t kNoColor = 0xFFFFFFFFu;     // Never a valid 24-bit key
+    static const std::uint32_t kNotFound = 0xFFFFFFFFu;
+
+    static std::uint32_t Pack(int r, int g, int b) {
+        return (static_cast<std::uint32_t>(r & 0xFF) << 16) | (static_cast<std::uint32_t>(g & 0xFF) << 8) |
+               static_cast<std::uint32_t>(b & 0xFF);
+    }
+    static int Red(std::uint32_t rgb) { return static_cast<int>((rgb >> 16) & 0xFF); }
+    static int Green(std::uint32_t rgb) { return static_cast<int>((rgb >> 8) & 0xFF); }
+    static int Blue(std::uint32_t rgb) { return static_cast<int>(rgb & 0xFF); }
+
+    TrueColorTable();
+
+    // Value stored for rgb, kNotFound when absent
+    std::uint32_t Find(std::uint32_t rgb) const {
+        if (m_size == 0 || rgb > 0xFFFFFFu) {
+            return kNotFound;
+        }
+        for (size_t slot = Home(rgb);; slot = (slot + 1) & m_mask) {
+            if (m_slots[slot].key == rgb) return m_slots[slot].value;
+            if (m_slots[slot].key == kNoColor) return kNotFound;
+        }
+    }
+    bool Contains(std::uint32_t rgb) const { return Find(rgb) != kNotFound; }
+
+    // Adds or overwrites; false for keys outside 24 bits
+    bool Insert(std::uint32_t rgb, std::uint32_t value);
+    bool Erase(std::uint32_t rgb);
+    void Clear();
+
+    size_t Size() const { return m_size; }
+    bool IsEmpty() const { return m_size == 0; }
+
+    // Calls function(rgb, value) for every entry, in slot order
+    template <typename Function>
+    void ForEach(Function function) const {
+        for (const Slot& slot : m_slots) {
+            if (slot.key != kNoColor) function(slot.key, slot.value);
+        }
+    }
+
+private:
+    struct Slot {
+        std::uint32_t key;
+        std::uint32_t value;
+    };
+
+    std::vector<Slot> m_slots;
+    size_t m_mask;
+    size_t m_size;
+    int m_shift;
+
+    // Fibonacci hashing - nearby colors land far apart
+    size_t Home(std::uint32_t rgb) const {
+        return static_cast<size_t>((rgb * 2654435769u) >> m_shift) & m_mask;
+    }
+    void Rehash(size_t slotCount);
+};
+
+} // namespace EnhancedTakeoff
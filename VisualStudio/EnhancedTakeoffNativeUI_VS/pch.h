@@ -6,7 +6,8 @@
 #ifndef PCH_H
 #define PCH_H
 
-// Windows and framework headers
+// Windows and framework headers (skipped for headless BUILDING_TESTS builds)
+#ifndef BUILDING_TESTS
 #include "targetver.h"
 #include "framework.h"
 
@@ -21,6 +22,7 @@
 #include <afxdialogex.h>    // MFC dialog extensions
 #include <afxdtctl.h>       // MFC support for Internet Explorer 4 Common Controls
 #include <afxcmn.h>         // MFC support for Windows Common Controls
+#endif // BUILDING_TESTS
 
 // Standard library headers
 #include <memory>
@@ -35,7 +37,7 @@
 #include <sstream>
 
 // BricsCAD SDK headers (conditional compilation)
-#ifdef HAS_BRX_SDK
+#if defined(HAS_BRX_SDK) && !defined(BUILDING_TESTS)
 #define BCAD_EXPORTS            // Required for BricsCAD
 #include "brx_platform.h"
 #include "AcDb.h"
@@ -133,7 +135,7 @@ namespace EnhancedTakeoff {
 #endif
 
 // Debug macros for Enhanced Takeoff
-#ifdef _DEBUG
+#if defined(_DEBUG) && !defined(BUILDING_TESTS)
 #define ET_TRACE(msg) TRACE(_T("EnhancedTakeoff: %s\n"), msg)
 #define ET_ASSERT(expr) ASSERT(expr)
 #else